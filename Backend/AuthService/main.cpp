@@ -1,9 +1,12 @@
+#include <prometheus/exposer.h>
+
 #include <QCoreApplication>
 
+#include "ConnectionPoolMetrics.h"
 #include "Debug_profiling.h"
 #include "GeneratorId.h"
+#include "CacheBackend.h"
 #include "GenericRepository.h"
-#include "RedisCache.h"
 #include "SQLiteDataBase.h"
 #include "SqlExecutor.h"
 #include "authservice/JwtGenerator.h"
@@ -23,15 +26,21 @@ int main(int argc, char *argv[]) {
   //   LOG_ERROR("[DELETE] users table failed");
   // }
 
-  SQLiteDatabase db("auth_service_conn");
+  SQLiteDatabase db("auth_service_conn", SQLiteProfile::readHeavy());
   if (!db.initializeSchema()) {
     qFatal("Cannot initialise DB");
   }
 
+  auto registry = std::make_shared<prometheus::Registry>();
+  prometheus::Exposer exposer("127.0.0.1:" + std::to_string(Config::Ports::authServiceMetrics));
+  exposer.RegisterCollectable(registry);
+  ConnectionPoolMetrics pool_metrics(registry, "auth_service", db.poolStats().size);
+  db.setPoolObserver(&pool_metrics);
+
   SqlExecutor executor(db);
   constexpr int service_id = 1;
   GeneratorId id_generator(service_id);
-  GenericRepository rep(&executor, RedisCache::instance());
+  GenericRepository rep(&executor, cacheInstance());
 
   AuthManager manager(rep, &id_generator);
   RealAuthoritizer authoritizer;
@@ -1,13 +1,16 @@
 #include <crow.h>
 
+#include <prometheus/exposer.h>
+
 #include <QCoreApplication>
 
+#include "ConnectionPoolMetrics.h"
 #include "Debug_profiling.h"
 #include "GeneratorId.h"
 #include "GenericRepository.h"
 #include "NetworkFacade.h"
 #include "NetworkManager.h"
-#include "RedisCache.h"
+#include "CacheBackend.h"
 #include "SQLiteDataBase.h"
 #include "SqlExecutor.h"
 #include "chatservice/chatcontroller.h"
@@ -46,10 +49,16 @@ int main(int argc, char *argv[]) {
     qFatal("Cannot initialise DB");
   }
 
+  auto registry = std::make_shared<prometheus::Registry>();
+  prometheus::Exposer exposer("127.0.0.1:" + std::to_string(Config::Ports::chatServiceMetrics));
+  exposer.RegisterCollectable(registry);
+  ConnectionPoolMetrics pool_metrics(registry, "chat_service", database.poolStats().size);
+  database.setPoolObserver(&pool_metrics);
+
   SqlExecutor executor(database);
   constexpr int service_id = 2;
   GeneratorId generator(service_id);
-  GenericRepository genetic_rep(&executor, RedisCache::instance());
+  GenericRepository genetic_rep(&executor, cacheInstance());
   ChatManager manager(&genetic_rep, &generator);  // TODO: pass executor to mock
   RealHttpClient client;
   ProxyClient proxy(&client);
@@ -110,14 +110,10 @@ bool ChatManager::addMembersToChat(ID chat_id, const std::vector<ID> &members_id
     chat_members.push_back(new_member);
   }
 
-  for (auto chat_member : chat_members) {
-    bool ok = repository_->save(chat_member);
-    if (!ok) {
-      LOG_INFO("Member {} for chat {} is not saved", chat_member.user_id, chat_member.chat_id);
-      return false;
-    }
+  if (!repository_->saveAll(chat_members)) {
+    LOG_ERROR("Members for chat {} are not saved", chat_id);
+    return false;
   }
-  // TODO: repository_->save(chat_members);
   return true;
 }
 
@@ -118,7 +118,7 @@ TEST_CASE("Test chatManager::getChatById") {
 
   SECTION("Expected creating valid sql") {
     int chat_id = 9;
-    std::string expected_sql = "SELECT * FROM chats WHERE id = ? LIMIT 1";
+    std::string expected_sql = "SELECT * FROM chats WHERE id IN (?)";
     fix.executor.lastSql.clear();
 
     fix.manager.getChatById(chat_id);
@@ -43,6 +43,9 @@ class GatewayMetrics : public IMetrics {
   void newMessage(const std::string &ip) override;
   void saveMessageSize(int size);
 
+  // for pull-style metrics such as NearCacheMetrics
+  void registerCollectable(const std::weak_ptr<prometheus::Collectable> &collectable);
+
  private:
   std::shared_ptr<prometheus::Registry> registry_;
   std::unique_ptr<prometheus::Exposer> exposer_;
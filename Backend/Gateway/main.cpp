@@ -1,8 +1,10 @@
+#include "CacheBackend.h"
 #include "GatewayMetrics.h"
 #include "JWTVerifier.h"
+#include "NearCache.h"
+#include "NearCacheMetrics.h"
 #include "RabbitMQClient.h"
 #include "RealHttpClient.h"
-#include "RedisCache.h"
 #include "config/ports.h"
 #include "gatewayserver.h"
 #include "middlewares/Middlewares.h"
@@ -19,14 +21,19 @@ int main() {
   initLogger("Gateway");
 
   JWTVerifier verifier(kPublicKeyFile, kIssuer);
-  RedisCache &cache = RedisCache::instance();
+  ICacheService &cache = cacheInstance();
   RateLimiter rate_limiter;
   GatewayMetrics metrics(Config::Ports::metrics);
 
+  // cached GET responses are only ever replaced by their ttl, so L1 needs no invalidation channel
+  NearCache response_cache(cache, NearCacheConfig{.max_bytes = 32 * 1024 * 1024, .prefixes = {"cache:"}});
+  auto response_cache_metrics = std::make_shared<NearCacheMetrics>(response_cache, "gateway");
+  metrics.registerCollectable(response_cache_metrics);
+
   GatewayApp app;
   app.get_middleware<AuthMiddleware>().verifier_ = &verifier;
   app.get_middleware<MetricsMiddleware>().metrics_ = &metrics;
-  app.get_middleware<CacheMiddleware>().cache_ = &cache;
+  app.get_middleware<CacheMiddleware>().cache_ = &response_cache;
   app.get_middleware<LoggingMiddleware>();
   app.get_middleware<RateLimitMiddleware>().rate_limiter_ = &rate_limiter;
 
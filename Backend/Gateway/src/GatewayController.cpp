@@ -85,10 +85,12 @@ void GatewayController::handlePostRequest(
 
 void GatewayController::handleRequestRoute(crow::response &res, std::string task_id) {
   LOG_INFO("Request id = {}", task_id);
-  std::optional<std::string> status = cache_->get("request:" + task_id);
+  auto values = cache_->getMany({"request:" + task_id, "request_id:" + task_id, "request_body:" + task_id});
+  values.resize(3);
+  const std::optional<std::string> &status = values[0];
+  const std::optional<std::string> &id = values[1];
+  const std::optional<std::string> &body = values[2];
   nlohmann::json responce;
-  std::optional<std::string> id = cache_->get("request_id:" + task_id);
-  std::optional<std::string> body = cache_->get("request_body:" + task_id);
 
   if (!status || !id || !body) {
     responce["status"] = "not_found";
@@ -134,11 +136,14 @@ void GatewayController::subscribeOnNewRequest() {
         "{}, body = {}",
         request_info.request_id, std::to_string(result.first), result.second.substr(0, result.second.length()));
 
-    cache_->set("request:" + request_info.request_id, "{\"status\":\"finished\"}", std::chrono::seconds(30));
-    cache_->set("request_id:" + request_info.request_id, std::to_string(result.first), std::chrono::seconds(30));
-    cache_->set("request_body:" + request_info.request_id,
-                result.second.substr(0, result.second.length() - 1) + ",\"status\":\"finished\"}",
-                std::chrono::seconds(30));  // todo: fully refactor server responce JsonObject,
-                                            //  return ["error"], ["body"], maybe ["code"]
+    constexpr std::chrono::seconds kTtl{30};
+    cache_->setMany({
+        {.key = "request:" + request_info.request_id, .value = "{\"status\":\"finished\"}", .ttl = kTtl},
+        {.key = "request_id:" + request_info.request_id, .value = std::to_string(result.first), .ttl = kTtl},
+        {.key = "request_body:" + request_info.request_id,
+         .value = result.second.substr(0, result.second.length() - 1) + ",\"status\":\"finished\"}",
+         .ttl = kTtl},
+    });  // todo: fully refactor server responce JsonObject,
+         //  return ["error"], ["body"], maybe ["code"]
   });
 }
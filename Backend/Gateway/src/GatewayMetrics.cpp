@@ -125,3 +125,7 @@ void GatewayMetrics::newMessage(const std::string &ip) {
 }
 
 void GatewayMetrics::saveMessageSize(int size) { msg_size_histogram_->Observe(size); }
+
+void GatewayMetrics::registerCollectable(const std::weak_ptr<prometheus::Collectable> &collectable) {
+  exposer_->RegisterCollectable(collectable);
+}
@@ -16,6 +16,11 @@ class MockApiCache : public ICacheService {
     return mock_answer;
   }
 
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override {
+    if (!keys.empty()) last_key_to_get = keys.back();
+    return std::vector<std::optional<std::string>>(keys.size(), mock_answer);
+  }
+
   int call_set = 0;
   std::string last_set_key;
   std::string last_set_value;
@@ -27,11 +32,21 @@ class MockApiCache : public ICacheService {
     last_set_value = value;
   }
 
+  int call_set_many = 0;
+  std::vector<CacheEntry> last_set_many;
+
+  void setMany(const std::vector<CacheEntry> &entries) override {
+    ++call_set_many;
+    last_set_many = entries;
+  }
+
  private:
   void clearCache() override { ++clear_cache_calls; }
 
   void remove(const std::string &key) override { ++remove_calls; }
 
+  void removeMany(const std::vector<std::string> &keys) override { remove_calls += static_cast<int>(keys.size()); }
+
   void incr(const std::string &key) override { ++incr_calls; }
 
   void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
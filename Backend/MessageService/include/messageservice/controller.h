@@ -1,10 +1,13 @@
 #ifndef BACKEND_MESSAGESERVICE_CONTROLLER_CONTROLLER_H_
 #define BACKEND_MESSAGESERVICE_CONTROLLER_CONTROLLER_H_
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "Batcher.h"
 #include "QueueSubscriber.h"
 #include "QueuePublisher.h"
 
@@ -17,6 +20,7 @@ class MessageStatus;
 class IThreadPool;
 class RequestDTO;
 struct ReactionInfo;
+struct Reaction;
 
 using StatusCode = int;
 using ResponceBody = std::string;
@@ -24,7 +28,10 @@ using Response = std::pair<StatusCode, ResponceBody>;
 
 class Controller {
  public:
-  Controller(IEventBus *mq_client, IMessageCommandService* command_manager, IMessageQueryService *query_manager, IThreadPool *pool);
+  // with write_batching set, MessageStatus/Reaction writes are group-committed before their *_saved events
+  Controller(IEventBus *mq_client, IMessageCommandService* command_manager, IMessageQueryService *query_manager, IThreadPool *pool,
+             std::optional<BatcherConfig> write_batching = std::nullopt);
+  virtual ~Controller();
 
   Response updateMessage(const RequestDTO &request_pack, const std::string &message_id_str);
   Response deleteMessage(const RequestDTO &request_pack, const std::string &message_id_str);
@@ -42,17 +49,20 @@ class Controller {
   void subscribeAll();
 
  private:
-  std::vector<Message> getMessages(const GetMessagePack &);
   std::vector<MessageStatus> getMessagesStatus(const std::vector<Message> &messages, long long receiver_id);
-  std::vector<MessageStatus> getReadedMessageStatuses(long long message_id);
   std::optional<long long> getUserIdFromToken(const std::string &token);
   std::optional<std::vector<ReactionInfo>> loadReactions();
+  void saveMessageStatusNow(MessageStatus &status);
+  void saveMessageReactionNow(const Reaction &reaction);
 
   IMessageCommandService *command_manager_;
   IMessageQueryService *query_manager_;
   IThreadPool *pool_;
   QueueSubscriber subscriber_;
   QueuePublisher publisher_;
+  // declared last so they drain before the publisher goes away
+  std::unique_ptr<SaverBatcher<MessageStatus>> status_batcher_;
+  std::unique_ptr<SaverBatcher<Reaction>> reaction_batcher_;
 };
 
 #endif  // BACKEND_MESSAGESERVICE_CONTROLLER_CONTROLLER_H_
@@ -4,7 +4,7 @@
 struct GetMessagePack {
   long long chat_id;
   int limit;
-  int before_id;
+  long long before_id;
   long long user_id;
 };
 
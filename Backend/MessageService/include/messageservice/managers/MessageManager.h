@@ -1,6 +1,8 @@
 #ifndef BACKEND_MESSAGE_SERVICE_MESSAGEMANAGER_H
 #define BACKEND_MESSAGE_SERVICE_MESSAGEMANAGER_H
 
+#include <span>
+
 #include "GenericRepository.h"
 #include "RedisCache.h"
 #include "entities/Message.h"
@@ -20,10 +22,12 @@ public:
 
     virtual bool saveMessage(Message &message) = 0;
     virtual bool saveMessageStatus(MessageStatus &status) = 0;
+    virtual bool saveMessageStatuses(std::span<const MessageStatus> statuses) = 0;
     virtual bool updateMessage(const Message &message) = 0;
     virtual bool deleteMessage(const Message &message) = 0;
 
     virtual bool saveMessageReaction(const Reaction &reaction) = 0;
+    virtual bool saveMessageReactions(std::span<const Reaction> reactions) = 0;
     virtual bool deleteMessageReaction(const Reaction &reaction) = 0;
     virtual bool saveMessageReactionInfo(const std::vector<ReactionInfo> &reaction_infos) = 0;
 };
@@ -35,12 +39,20 @@ public:
     virtual std::optional<Message> getMessage(long long message_id) = 0;
     virtual std::optional<MessageStatus> getMessageStatus(long long message_id, long long receiver_id) = 0;
     virtual std::vector<Message> getChatMessages(const GetMessagePack &pack) = 0;
+    virtual SelectCursor<Message> streamChatMessages(const GetMessagePack &pack) = 0;
     virtual std::vector<MessageStatus> getMessagesStatus(const std::vector<Message> &messages, long long receiver_id) = 0;
 
     virtual std::vector<MessageStatus> getReadedMessageStatuses(long long message_id) = 0;
     virtual std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>> getReactions(long long message_id,
                                                                                               long long receiver_id) = 0;
     virtual std::optional<ReactionInfo> getReactionInfo(long long message_reaction_id) = 0;
+
+    // batched forms for a page of messages: result[i] belongs to message_ids[i], and
+    // all cache lookups of one call share a single round trip
+    virtual std::vector<std::vector<MessageStatus>> getReadedMessageStatuses(
+        const std::vector<long long> &message_ids) = 0;
+    virtual std::vector<std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>>> getReactions(
+        const std::vector<long long> &message_ids, long long receiver_id) = 0;
 };
 
 class MessageCommandManager : public IMessageCommandService {
@@ -48,11 +60,13 @@ class MessageCommandManager : public IMessageCommandService {
   MessageCommandManager(GenericRepository *rep, IIdGenerator *generator);
   bool saveMessage(Message &message) override;
   bool saveMessageStatus(MessageStatus &status) override;
+  bool saveMessageStatuses(std::span<const MessageStatus> statuses) override;
   bool updateMessage(const Message &message) override;
   bool deleteMessage(const Message &message) override;
 
   //todo: make new microservice
   bool saveMessageReaction(const Reaction &reaction) override;
+  bool saveMessageReactions(std::span<const Reaction> reactions) override;
   bool deleteMessageReaction(const Reaction &reaction) override;
   bool saveMessageReactionInfo(const std::vector<ReactionInfo> &reaction_infos) override;
 
@@ -65,6 +79,7 @@ class MessageQueryManager : public IMessageQueryService {
 public:
     MessageQueryManager(ISqlExecutor *executor, ICacheService &cache);
     std::vector<Message> getChatMessages(const GetMessagePack &pack) override;
+    SelectCursor<Message> streamChatMessages(const GetMessagePack &pack) override;
     std::optional<Message> getMessage(long long message_id) override;
     std::vector<MessageStatus> getMessagesStatus(const std::vector<Message> &messages, long long receiver_id) override;
     std::optional<MessageStatus> getMessageStatus(long long message_id, long long receiver_id) override;
@@ -75,7 +90,14 @@ public:
                                                                                       long long receiver_id) override;
     std::optional<ReactionInfo> getReactionInfo(long long message_reaction_id) override;
 
+    std::vector<std::vector<MessageStatus>> getReadedMessageStatuses(
+        const std::vector<long long> &message_ids) override;
+    std::vector<std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>>> getReactions(
+        const std::vector<long long> &message_ids, long long receiver_id) override;
+
 private:
+    std::unique_ptr<SelectQuery<Message>> chatMessagesQuery(const GetMessagePack &pack);
+
     ISqlExecutor *executor_;
     ICacheService &cache_;
 };
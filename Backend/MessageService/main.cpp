@@ -1,17 +1,29 @@
+#include <prometheus/exposer.h>
+
 #include <QCoreApplication>
+#include <memory>
+#include <thread>
 
+#include "CacheBackend.h"
+#include "ConnectionPoolMetrics.h"
 #include "Debug_profiling.h"
 #include "GeneratorId.h"
 #include "GenericRepository.h"
+#include "LocalCache.h"
+#include "NearCache.h"
+#include "NearCacheMetrics.h"
 #include "RabbitMQClient.h"
+#include "RedisCache.h"
+#include "RedisInvalidationChannel.h"
 #include "SQLiteDataBase.h"
 #include "SqlExecutor.h"
+#include "ThreadPoolMetrics.h"
+#include "WorkStealingThreadPool.h"
 #include "config/ports.h"
 #include "interfaces/IThreadPool.h"
 #include "messageservice/controller.h"
 #include "messageservice/managers/MessageManager.h"
 #include "messageservice/server.h"
-#include "threadpool.h"
 
 RabbitMQConfig getConfig() {
   RabbitMQConfig config;
@@ -31,27 +43,101 @@ std::unique_ptr<RabbitMQClient> createRabbitMQClient(const RabbitMQConfig config
   }
 }
 
+TtlPolicy getTtlPolicy() {
+  TtlPolicy policy;
+  // query and entity entries ask for 30 s; never let a caller keep them past a minute
+  policy.setRule("query_cache:", TtlRule{.jitter = 0.1, .min = std::chrono::seconds(1),
+                                         .max = std::chrono::minutes(1)});
+  policy.setRule("entity_cache:", TtlRule{.jitter = 0.1, .min = std::chrono::seconds(1),
+                                          .max = std::chrono::minutes(1)});
+  return policy;
+}
+
+RedisConfig getRedisConfig() {
+  RedisConfig config;
+  config.pool_size = 16;
+  config.pool_wait_timeout = std::chrono::milliseconds(100);
+  config.socket_timeout = std::chrono::milliseconds(200);
+  config.async_threads = 4;
+  config.ttl_policy = getTtlPolicy();
+  return config;
+}
+
+LocalCacheConfig getLocalCacheConfig() {
+  LocalCacheConfig config;
+  config.max_bytes = 256 * 1024 * 1024;
+  config.ttl_policy = getTtlPolicy();
+  return config;
+}
+
+NearCacheConfig getNearCacheConfig() {
+  NearCacheConfig config;
+  config.max_bytes = 64 * 1024 * 1024;
+  config.ttl = std::chrono::milliseconds(2000);
+  config.prefixes = {"table_generation:", "query_cache:", "entity_cache:"};
+  return config;
+}
+
+BatcherConfig getWriteBatchingConfig() {
+  BatcherConfig config;
+  config.max_batch_rows = 256;
+  config.max_delay = std::chrono::milliseconds(5);
+  config.max_pending_rows = 8192;
+  config.enqueue_timeout = std::chrono::milliseconds(200);
+  return config;
+}
+
+ThreadPoolLimits getThreadPoolLimits() {
+  ThreadPoolLimits limits;
+  // pending saves are held back in RabbitMQ, not in memory, once this many are queued
+  limits.capacity = 4096;
+  limits.policy = OverflowPolicy::Block;
+  return limits;
+}
+
 int main(int argc, char *argv[]) {
   initLogger("MessageService");
+  RedisCache::configure(getRedisConfig());
+  LocalCache::configure(getLocalCacheConfig());
   QCoreApplication a(argc, argv);
-  SQLiteDatabase bd("message_service_conn");
+  SQLiteDatabase bd("message_service_conn", SQLiteProfile::writeHeavy());
 
   if (!bd.initializeSchema()) {
     qFatal("Cannot initialise DB");
   }
 
+  auto registry = std::make_shared<prometheus::Registry>();
+  prometheus::Exposer exposer("127.0.0.1:" + std::to_string(Config::Ports::messageServiceMetrics));
+  exposer.RegisterCollectable(registry);
+  ConnectionPoolMetrics pool_metrics(registry, "message_service", bd.poolStats().size);
+  bd.setPoolObserver(&pool_metrics);
+
+  // the near cache and its pub/sub channel only make sense in front of Redis
+  const CacheBackend cache_backend = cacheBackendFromEnv();
+  ICacheService *cache = &cacheInstance(cache_backend);
+  std::unique_ptr<NearCache> near_cache;
+  std::unique_ptr<RedisInvalidationChannel> cache_invalidations;
+  if (cache_backend == CacheBackend::Redis) {
+    near_cache = std::make_unique<NearCache>(RedisCache::instance(), getNearCacheConfig());
+    cache_invalidations = std::make_unique<RedisInvalidationChannel>(*near_cache, "near_cache:message_service",
+                                                                     getRedisConfig());
+    exposer.RegisterCollectable(std::make_shared<NearCacheMetrics>(*near_cache, "message_service"));
+    cache = near_cache.get();
+  }
+
   SqlExecutor executor(bd);
-  ThreadPool pool;
+  WorkStealingThreadPool pool(std::thread::hardware_concurrency(), getThreadPoolLimits());
+  exposer.RegisterCollectable(std::make_shared<ThreadPoolMetrics>(pool, "message_service"));
   constexpr int service_id = 3;
   GeneratorId generator(service_id);
-  GenericRepository genetic_rep(&executor, RedisCache::instance(), &pool);
+  GenericRepository genetic_rep(&executor, *cache, &pool);
   MessageCommandManager command_manager(&genetic_rep, &generator);
-  MessageQueryManager query_manager(&executor, RedisCache::instance());
+  MessageQueryManager query_manager(&executor, *cache);
   RabbitMQConfig config = getConfig();
   auto mq = createRabbitMQClient(config, &pool);
   if (!mq) throw std::runtime_error("Cannot connect to RabbitMQ");
 
-  Controller controller(mq.get(), &command_manager, &query_manager, &pool);
+  Controller controller(mq.get(), &command_manager, &query_manager, &pool, getWriteBatchingConfig());
   crow::SimpleApp app;
   Server server(app, Config::Ports::messageService, &controller);
   server.run();
@@ -24,9 +24,9 @@ int getLimit(const RequestDTO &req) {
   return it != req.url_params.end() ? std::stoi(it->second) : INT_MAX;
 }
 
-int getBeforeId(const RequestDTO &req) {
+long long getBeforeId(const RequestDTO &req) {
   auto it = req.url_params.find("before_id");
-  return it != req.url_params.end() ? std::stoi(it->second) : 0;
+  return it != req.url_params.end() ? std::stoll(it->second) : 0;
 }
 
 nlohmann::json formMessageListJson(const std::vector<UserMessage> &messages) {
@@ -67,8 +67,39 @@ std::vector<MessageStatus> fetchReaded(const std::vector<MessageStatus> &message
 
 }  // namespace
 
-Controller::Controller(IEventBus *mq_client, IMessageCommandService* command_manager, IMessageQueryService *query_manager, IThreadPool *pool)
-    : command_manager_(command_manager), query_manager_(query_manager), pool_(pool), subscriber_(mq_client), publisher_(mq_client) {}
+Controller::Controller(IEventBus *mq_client, IMessageCommandService* command_manager, IMessageQueryService *query_manager, IThreadPool *pool,
+                       std::optional<BatcherConfig> write_batching)
+    : command_manager_(command_manager), query_manager_(query_manager), pool_(pool), subscriber_(mq_client), publisher_(mq_client) {
+  if (!write_batching) return;
+
+  status_batcher_ = std::make_unique<SaverBatcher<MessageStatus>>(
+      [this](std::span<const MessageStatus> statuses) { return command_manager_->saveMessageStatuses(statuses); },
+      [this](std::span<const MessageStatus> statuses, bool saved) {
+        for (const auto &status : statuses) {
+          if (saved) {
+            publisher_.messageStatusSaved(status);
+          } else {
+            LOG_ERROR("Error saving message_status id {}", status.message_id);
+          }
+        }
+      },
+      *write_batching);
+
+  reaction_batcher_ = std::make_unique<SaverBatcher<Reaction>>(
+      [this](std::span<const Reaction> reactions) { return command_manager_->saveMessageReactions(reactions); },
+      [this](std::span<const Reaction> reactions, bool saved) {
+        for (const auto &reaction : reactions) {
+          if (saved) {
+            publisher_.reactionSaved(reaction);
+          } else {
+            LOG_ERROR("Error saving message_reaction id {}", reaction.message_id);
+          }
+        }
+      },
+      *write_batching);
+}
+
+Controller::~Controller() = default;
 
 void Controller::handleSaveMessage(const std::string &payload) {
   std::optional<Message> msg = utils::parsePayload<Message>(payload);  // TODO: alias
@@ -77,13 +108,15 @@ void Controller::handleSaveMessage(const std::string &payload) {
   auto message = *msg;
   LOG_INFO("Get message to save with id {} and text {}", message.id, message.text);
 
-  pool_->enqueue([this, message]() mutable {
-    if (command_manager_->saveMessage(message)) {
-      publisher_.messageSaved(message);
-    } else {
-      LOG_ERROR("Error saving message id {}", message.id);
-    }
-  });
+  pool_->post(
+      [this, message]() mutable {
+        if (command_manager_->saveMessage(message)) {
+          publisher_.messageSaved(message);
+        } else {
+          LOG_ERROR("Error saving message id {}", message.id);
+        }
+      },
+      TaskPriority::Background);
 }
 
 void Controller::subscribeAll() {
@@ -109,16 +142,24 @@ void Controller::handleSaveMessageStatus(const std::string &payload) {
   if (message_status == std::nullopt) return;
   auto status = *message_status;
 
-  pool_->enqueue([this, status]() mutable {
-    if (command_manager_->saveMessageStatus(status)) {
-      publisher_.messageStatusSaved(status);
-    } else {
-      LOG_ERROR("Error saving message_status id {}", status.message_id);
-    }
-  });
+  if (status_batcher_) {
+    if (status_batcher_->saveEntity(status)) return;
+    // queue stayed full: keep the consumer blocked on a direct write instead of growing the pool queue
+    LOG_WARN("Status batcher is saturated, saving message_status {} inline", status.message_id);
+    saveMessageStatusNow(status);
+    return;
+  }
+
+  pool_->post([this, status]() mutable { saveMessageStatusNow(status); }, TaskPriority::Background);
 }
 
-std::vector<Message> Controller::getMessages(const GetMessagePack &pack) { return query_manager_->getChatMessages(pack); }
+void Controller::saveMessageStatusNow(MessageStatus &status) {
+  if (command_manager_->saveMessageStatus(status)) {
+    publisher_.messageStatusSaved(status);
+  } else {
+    LOG_ERROR("Error saving message_status id {}", status.message_id);
+  }
+}
 
 std::vector<MessageStatus> Controller::getMessagesStatus(const std::vector<Message> &messages, long long receiver_id) {
   return query_manager_->getMessagesStatus(messages, receiver_id);
@@ -207,10 +248,6 @@ Response Controller::deleteMessage(const RequestDTO &request_pack, const std::st
   return std::make_pair(200, nlohmann::json(*message_to_delete).dump());
 }
 
-std::vector<MessageStatus> Controller::getReadedMessageStatuses(long long message_id) {
-  return query_manager_->getReadedMessageStatuses(message_id);
-}
-
 Response Controller::getMessageById(const std::string &message_id_str) {
   LOG_INFO("getMessageById {}", message_id_str);
 
@@ -242,8 +279,17 @@ Response Controller::getMessagesFromChat(const RequestDTO &request_pack, const s
                             .user_id = *user_id};
 
   LOG_INFO("Pack is formed");
-  auto messages = getMessages(pack);
-  LOG_INFO("For {} chat finded {} messages", *chat_id, messages.size());
+  // the page is read row by row, then its read statuses and reactions are looked up
+  // in one batch each instead of two cache round trips per message
+  auto cursor = query_manager_->streamChatMessages(pack);
+  std::vector<Message> messages;
+  std::vector<long long> message_ids;
+  for (auto &message : cursor) {
+    message_ids.push_back(message.id);
+    messages.push_back(std::move(message));
+  }
+  auto readed_statuses = query_manager_->getReadedMessageStatuses(message_ids);
+  auto reactions = query_manager_->getReactions(message_ids, user_id.value());
   // auto messages_status = getMessagesStatus(messages, *user_id);
   // auto json_messages = formMessageListJson(messages, messages_status);
   // auto messages_status_readed = fetchReaded(messages_status);
@@ -253,28 +299,28 @@ Response Controller::getMessagesFromChat(const RequestDTO &request_pack, const s
   // std::vector<UserMessage> ans;
 
   nlohmann::json json_messages;  // todo : make function to get vector UserMessage
-  int i = 0;
-  for (auto &message : messages) {
-    std::vector<MessageStatus> message_statuses = getReadedMessageStatuses(message.id);
+  for (std::size_t i = 0; i < messages.size(); ++i) {
+    const std::vector<MessageStatus> &message_statuses = readed_statuses[i];
     UserMessage user_message;
-    user_message.message = message;
+    user_message.message = std::move(messages[i]);
     user_message.read.count = static_cast<int>(message_statuses.size());
 
     bool is_read_by_me = false;
-    for (auto &message_status : message_statuses) {
+    for (const auto &message_status : message_statuses) {
       if (message_status.receiver_id == *user_id) {
         is_read_by_me = true;
         break;
       }
     }
     user_message.read.read_by_me = is_read_by_me;
-    auto [reactions_map, my_reaction] = query_manager_->getReactions(message.id, user_id.value());
+    auto &[reactions_map, my_reaction] = reactions[i];
 
-    user_message.reactions.counts = reactions_map;
+    user_message.reactions.counts = std::move(reactions_map);
     user_message.reactions.my_reaction = my_reaction;
 
-    json_messages[i++] = nlohmann::json(user_message);
+    json_messages.push_back(nlohmann::json(user_message));
   }
+  LOG_INFO("For {} chat finded {} messages", *chat_id, messages.size());
 
   return std::make_pair(Config::StatusCodes::success, json_messages.dump());
 }
@@ -283,6 +329,9 @@ void Controller::handleDeleteMessageReaction(const std::string &payload) {
   std::optional<Reaction> reaction_to_delete = utils::parsePayload<Reaction>(payload);
   if (reaction_to_delete == std::nullopt) return;
 
+  // a buffered save of the same reaction must not land after this delete
+  if (reaction_batcher_) reaction_batcher_->flush();
+
   if (!command_manager_->deleteMessageReaction(*reaction_to_delete)) {
     LOG_ERROR("Error deleting message_reaction id {}", reaction_to_delete->message_id);
     return;
@@ -295,12 +344,21 @@ void Controller::handleSaveMessageReaction(const std::string &payload) {
   std::optional<Reaction> reaction_to_save = utils::parsePayload<Reaction>(payload);
   if (reaction_to_save == std::nullopt) return;
 
-  if (!command_manager_->saveMessageReaction(*reaction_to_save)) {
-    LOG_ERROR("Error saving message_reaction id {}", reaction_to_save->message_id);
+  if (reaction_batcher_) {
+    if (reaction_batcher_->saveEntity(*reaction_to_save)) return;
+    LOG_WARN("Reaction batcher is saturated, saving message_reaction {} inline", reaction_to_save->message_id);
+  }
+
+  saveMessageReactionNow(*reaction_to_save);
+}
+
+void Controller::saveMessageReactionNow(const Reaction &reaction) {
+  if (!command_manager_->saveMessageReaction(reaction)) {
+    LOG_ERROR("Error saving message_reaction id {}", reaction.message_id);
     return;
   }
 
-  publisher_.reactionSaved(*reaction_to_save);
+  publisher_.reactionSaved(reaction);
 }
 
 Response Controller::setup() {
@@ -1,11 +1,40 @@
 #include "messageservice/managers/MessageManager.h"
 
+#include <memory>
+#include <unordered_set>
+
+#include "EntityCache.h"
 #include "GenericRepository.h"
 #include "interfaces/ICacheService.h"
 #include "interfaces/IIdGenerator.h"
 #include "interfaces/ISqlExecutor.h"
 #include "messageservice/dto/GetMessagePack.h"
 
+namespace {
+
+// one SelectQuery per id, executed with a single cache round trip; rows[i] belongs to ids[i]
+template <EntityJson T, typename Filter>
+std::vector<std::vector<T>> selectEach(ISqlExecutor *executor, ICacheService &cache, const std::vector<long long> &ids,
+                                       Filter filter) {
+  std::vector<std::unique_ptr<SelectQuery<T>>> queries;
+  std::vector<const SelectQuery<T> *> batch;
+  queries.reserve(ids.size());
+  batch.reserve(ids.size());
+  for (long long id : ids) {
+    queries.push_back(QueryFactory::createSelect<T>(executor, cache));
+    filter(*queries.back(), id);
+    batch.push_back(queries.back().get());
+  }
+
+  auto results = SelectQuery<T>::executeAll(batch);
+  std::vector<std::vector<T>> rows;
+  rows.reserve(results.size());
+  for (auto &result : results) rows.push_back(std::move(QueryFactory::getSelectResult(result).result));
+  return rows;
+}
+
+}  // namespace
+
 MessageCommandManager::MessageCommandManager(GenericRepository *repository, IIdGenerator *generator)
     : repository_(repository), generator_(generator) {}
 
@@ -18,11 +47,8 @@ bool MessageCommandManager::saveMessage(Message &msg) {
 }
 
 std::optional<Message> MessageQueryManager::getMessage(long long message_id) {
-  auto custom_query = QueryFactory::createSelect<Message>(executor_, cache_);
-  custom_query->where(MessageTable::Id, message_id).limit(1);
-  auto res = custom_query->execute();
-  auto select_res = QueryFactory::getSelectResult(res);
-  return select_res.result.empty() ? std::nullopt : std::make_optional(select_res.result.front());
+  auto found = entity_cache::findByIds<Message>(executor_, cache_, std::span<const long long>(&message_id, 1));
+  return found.empty() ? std::nullopt : std::make_optional(std::move(found.front()));
 }
 
 std::optional<MessageStatus> MessageQueryManager::getMessageStatus(long long message_id, long long receiver_id) {
@@ -35,9 +61,7 @@ std::optional<MessageStatus> MessageQueryManager::getMessageStatus(long long mes
   return select_res.result.empty() ? std::nullopt : std::make_optional(select_res.result.front());
 }
 
-std::vector<Message> MessageQueryManager::getChatMessages(const GetMessagePack &pack) {
-  PROFILE_SCOPE();
-  LOG_INFO("Start MessageQueryManager::getChatMessages");
+std::unique_ptr<SelectQuery<Message>> MessageQueryManager::chatMessagesQuery(const GetMessagePack &pack) {
   auto custom_query = QueryFactory::createSelect<Message>(executor_, cache_);
   custom_query
       ->join(MessageStatusTable::Table, MessageTable::Id, MessageStatusTable::fullField(MessageStatusTable::MessageId))
@@ -45,26 +69,42 @@ std::vector<Message> MessageQueryManager::getChatMessages(const GetMessagePack &
       .limit(pack.limit)
       .where(MessageStatusTable::fullField(MessageStatusTable::ReceiverId), pack.user_id);
 
-  custom_query->orderBy(MessageTable::Timestamp, OrderDirection::DESC);
+  // ids are time ordered (GeneratorId) and before_id is the page cursor, so order by id:
+  // idx_messages_chat_id then serves both the filter and the order without a sort
+  custom_query->orderBy(MessageTable::Id, OrderDirection::DESC);
 
   if (pack.before_id > 0) {
     custom_query->where(MessageTable::Id, Operator::Less, pack.before_id);
   }
+  return custom_query;
+}
+
+std::vector<Message> MessageQueryManager::getChatMessages(const GetMessagePack &pack) {
+  PROFILE_SCOPE();
+  LOG_INFO("Start MessageQueryManager::getChatMessages");
+  auto custom_query = chatMessagesQuery(pack);
   LOG_INFO("Query to select fully created");
   auto res = custom_query->execute();
   LOG_INFO("Query executed");
   return QueryFactory::getSelectResult(res).result;
 }
 
+SelectCursor<Message> MessageQueryManager::streamChatMessages(const GetMessagePack &pack) {
+  PROFILE_SCOPE();
+  return chatMessagesQuery(pack)->stream();
+}
+
 std::vector<MessageStatus> MessageQueryManager::getMessagesStatus(const std::vector<Message> &messages,
                                                              long long receiver_id) {
   std::vector<MessageStatus> ans;
-
-  for (const auto &msg : messages) {
-    auto custom_query = QueryFactory::createSelect<MessageStatus>(executor_, cache_);
-    custom_query->where(MessageStatusTable::MessageId, msg.id).where(MessageStatusTable::ReceiverId, receiver_id);
-    auto res = custom_query->execute();
-    auto returned_list = QueryFactory::getSelectResult(res).result;
+  std::vector<long long> message_ids;
+  message_ids.reserve(messages.size());
+  for (const auto &msg : messages) message_ids.push_back(msg.id);
+
+  auto statuses = selectEach<MessageStatus>(executor_, cache_, message_ids, [&](auto &query, long long message_id) {
+    query.where(MessageStatusTable::MessageId, message_id).where(MessageStatusTable::ReceiverId, receiver_id);
+  });
+  for (auto &returned_list : statuses) {
     if (returned_list.size() != 1) {
       LOG_WARN("Returned {}", returned_list.size());
     } else {
@@ -77,6 +117,10 @@ std::vector<MessageStatus> MessageQueryManager::getMessagesStatus(const std::vec
 
 bool MessageCommandManager::saveMessageStatus(MessageStatus &status) { return repository_->save(status); }
 
+bool MessageCommandManager::saveMessageStatuses(std::span<const MessageStatus> statuses) {
+  return repository_->saveAll(statuses);
+}
+
 bool MessageCommandManager::updateMessage(const Message &message) { return repository_->save(message); }
 
 bool MessageCommandManager::deleteMessage(const Message &message) {
@@ -104,6 +148,10 @@ bool MessageCommandManager::saveMessageReaction(const Reaction &reaction) {
   return repository_->save(reaction);
 }
 
+bool MessageCommandManager::saveMessageReactions(std::span<const Reaction> reactions) {
+  return repository_->saveAll(reactions);
+}
+
 bool MessageCommandManager::deleteMessageReaction(const Reaction &reaction) {
   DBC_REQUIRE(reaction.checkInvariants());
   auto query = QueryFactory::createDelete<Reaction>(repository_->getExecutor(), repository_->getCache());
@@ -117,30 +165,59 @@ bool MessageCommandManager::deleteMessageReaction(const Reaction &reaction) {
 
 std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>> MessageQueryManager::getReactions(
     long long message_id, long long receiver_id) {
-  auto custom_query = QueryFactory::createSelect<Reaction>(executor_, cache_);
-  custom_query->where(MessageReactionTable::MessageId, message_id);
-  auto res = custom_query->execute();
-  std::vector<Reaction> vector_of_reactions = QueryFactory::getSelectResult(res).result;
+  return std::move(getReactions(std::vector<long long>{message_id}, receiver_id).front());
+}
 
-  std::optional<long long> receiver_id_reactions;
-  std::unordered_map<long long, int> message_reactions;
+std::vector<std::vector<MessageStatus>> MessageQueryManager::getReadedMessageStatuses(
+    const std::vector<long long> &message_ids) {
+  return selectEach<MessageStatus>(executor_, cache_, message_ids, [](auto &query, long long message_id) {
+    DBC_REQUIRE(message_id > 0);
+    query.where(MessageStatusTable::MessageId, message_id).where(MessageStatusTable::IsRead, 1);
+  });
+}
 
-  for (const Reaction &reaction : vector_of_reactions) {
-    message_reactions[reaction.reaction_id]++;
-    if (reaction.receiver_id == receiver_id) receiver_id_reactions = reaction.reaction_id;
+std::vector<std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>>> MessageQueryManager::getReactions(
+    const std::vector<long long> &message_ids, long long receiver_id) {
+  auto reactions = selectEach<Reaction>(executor_, cache_, message_ids, [](auto &query, long long message_id) {
+    query.where(MessageReactionTable::MessageId, message_id);
+  });
+
+  std::vector<std::unordered_map<long long, int>> counts(reactions.size());
+  std::vector<std::optional<int>> my_reactions(reactions.size());
+  std::vector<long long> reaction_ids;
+  std::unordered_set<long long> seen_reactions;
+  for (std::size_t i = 0; i < reactions.size(); ++i) {
+    for (const Reaction &reaction : reactions[i]) {
+      counts[i][reaction.reaction_id]++;
+      if (seen_reactions.insert(reaction.reaction_id).second) reaction_ids.push_back(reaction.reaction_id);
+      if (reaction.receiver_id == receiver_id) my_reactions[i] = reaction.reaction_id;
+    }
   }
 
-  std::unordered_map<ReactionInfo, int> message_reactions_infos;
-  for (const auto &[reaction_id, reaction_cnt] : message_reactions) {
-    std::optional<ReactionInfo> reaction_info = getReactionInfo(reaction_id);
-    if (reaction_info.has_value()) {
-      message_reactions_infos.emplace(reaction_info.value(), reaction_cnt);
-    } else {
-      LOG_ERROR("Not found reaction with id {}", reaction_id);
-    }
+  // every distinct reaction of the page in one more round trip
+  auto infos = selectEach<ReactionInfo>(executor_, cache_, reaction_ids, [](auto &query, long long reaction_id) {
+    DBC_REQUIRE(reaction_id > 0);
+    query.where(MessageReactionInfoTable::Id, reaction_id);
+  });
+  std::unordered_map<long long, const ReactionInfo *> info_by_id;
+  for (std::size_t i = 0; i < reaction_ids.size(); ++i) {
+    if (!infos[i].empty()) info_by_id.emplace(reaction_ids[i], &infos[i].front());
   }
 
-  return std::make_pair(message_reactions_infos, receiver_id_reactions);
+  std::vector<std::pair<std::unordered_map<ReactionInfo, int>, std::optional<int>>> result;
+  result.reserve(reactions.size());
+  for (std::size_t i = 0; i < reactions.size(); ++i) {
+    std::unordered_map<ReactionInfo, int> message_reactions_infos;
+    for (const auto &[reaction_id, reaction_cnt] : counts[i]) {
+      if (auto it = info_by_id.find(reaction_id); it != info_by_id.end()) {
+        message_reactions_infos.emplace(*it->second, reaction_cnt);
+      } else {
+        LOG_ERROR("Not found reaction with id {}", reaction_id);
+      }
+    }
+    result.emplace_back(std::move(message_reactions_infos), my_reactions[i]);
+  }
+  return result;
 }
 
 std::optional<ReactionInfo> MessageQueryManager::getReactionInfo(long long message_reaction_id) {
@@ -153,8 +230,5 @@ std::optional<ReactionInfo> MessageQueryManager::getReactionInfo(long long messa
 }
 
 bool MessageCommandManager::saveMessageReactionInfo(const std::vector<ReactionInfo> &reaction_infos) {
-  for (auto &reaction_info : reaction_infos) {
-    if (!repository_->save(reaction_info)) return false;  // todo: make pipeline
-  }
-  return true;
+  return repository_->saveAll(reaction_infos);
 }
@@ -139,3 +139,36 @@ TEST_CASE("Test controller handles saved enitites") {
     REQUIRE(fix.rabit_client.publish_cnt == before_publish_call);
   }
 }
+
+TEST_CASE("Test controller group-commits message statuses") {
+  SharedFixture fix;
+  int before_publish_call = fix.rabit_client.publish_cnt;
+  int before_pool_cnt = fix.pool.call_count;
+  std::vector<MessageStatus> statuses;
+  for (long long receiver_id = 1; receiver_id <= 3; ++receiver_id) {
+    statuses.emplace_back(7, receiver_id, false, utils::time::getCurrentTime());
+  }
+
+  {
+    BatcherConfig config;
+    config.max_batch_rows = 16;
+    config.max_delay = std::chrono::milliseconds(50);
+    SecondTestController controller(&fix.rabit_client, &fix.command_manager, &fix.query_manager, &fix.pool, config);
+
+    for (const auto &status : statuses) {
+      controller.handleSaveMessageStatus(nlohmann::json(status).dump());
+    }
+  }  // controller destruction drains the batcher
+
+  SECTION("Statuses are saved in one transaction without the pool") {
+    REQUIRE(fix.pool.call_count == before_pool_cnt);
+    REQUIRE(fix.executor.last_sqls.size() == 3);
+    CHECK(fix.executor.last_sqls.front() == "BEGIN IMMEDIATE");
+    CHECK(fix.executor.last_sqls.back() == "COMMIT");
+  }
+
+  SECTION("Saved event is published for every status after the commit") {
+    REQUIRE(fix.rabit_client.publish_cnt == before_publish_call + 3);
+    REQUIRE(fix.rabit_client.last_publish_request.message == nlohmann::json(statuses.back()).dump());
+  }
+}
@@ -1,5 +1,7 @@
+#include <QSqlQuery>
 #include <catch2/catch_all.hpp>
 
+#include "SQLiteDataBase.h"
 #include "messageservice/dto/GetMessagePack.h"
 #include "messageservice/managers/MessageManager.h"
 #include "mocks/FakeSqlExecutor.h"
@@ -30,7 +32,7 @@ TEST_CASE("Test") {
         "id = messages_status.message_id "
         "WHERE chat_id = ? "
         "AND messages_status.receiver_id = ? "
-        "AND id < ? ORDER BY timestamp DESC LIMIT 2";
+        "AND id < ? ORDER BY id DESC LIMIT 2";
     REQUIRE(executor.execute_calls == before + 1);
     CHECK(executor.lastSql.toStdString() == expected_sql);
     CHECK(executor.lastValues.size() == 3);
@@ -39,6 +41,29 @@ TEST_CASE("Test") {
     CHECK(executor.lastValues[2] == 3);
   }
 
+  SECTION("streamChatMessages expected same sql and no cache writes") {
+    cache.clearCache();
+    GetMessagePack pack{.chat_id = 1, .limit = 2, .before_id = 3, .user_id = 4};
+    int before = executor.execute_calls;
+    int set_before = cache.set_calls;
+    int pipeline_before = cache.set_pipeline_calls;
+
+    auto cursor = manager.streamChatMessages(pack);
+
+    REQUIRE(executor.execute_calls == before + 1);
+    CHECK(executor.lastSql.toStdString() ==
+          "SELECT * FROM messages "
+          "JOIN messages_status ON "
+          "id = messages_status.message_id "
+          "WHERE chat_id = ? "
+          "AND messages_status.receiver_id = ? "
+          "AND id < ? ORDER BY id DESC LIMIT 2");
+    CHECK(cursor.ok());
+    CHECK_FALSE(cursor.next().has_value());
+    CHECK(cache.set_calls == set_before);
+    CHECK(cache.set_pipeline_calls == pipeline_before);
+  }
+
   SECTION("getMessagesStatus expected create valid sql request") {
     cache.clearCache();
     std::vector<Message> messages;
@@ -74,7 +99,7 @@ TEST_CASE("Test") {
     int message_id = 3;
     manager.getMessage(message_id);
 
-    std::string expected_sql = "SELECT * FROM messages WHERE id = ? LIMIT 1";
+    std::string expected_sql = "SELECT * FROM messages WHERE id IN (?)";
     REQUIRE(executor.execute_calls == before_calls + 1);
     CHECK(executor.lastSql.toStdString() == expected_sql);
     CHECK(executor.lastValues.size() == 1);
@@ -117,3 +142,48 @@ TEST_CASE("Test") {
     CHECK(executor.lastValues[1] == receiver_id);
   }
 }
+
+TEST_CASE("Test chat history query uses keyset index") {
+  SQLiteDatabase db("message_manager_plan_test.db");
+  REQUIRE(db.initializeSchema());
+  MockCache cache;
+  FakeSqlExecutor executor;
+  MessageQueryManager manager(&executor, cache);
+
+  auto queryPlan = [&db](const QString &sql, const QList<QVariant> &values) {
+    QSqlQuery query(db.db());
+    REQUIRE(query.prepare("EXPLAIN QUERY PLAN " + sql));
+    for (const auto &value : values) query.addBindValue(value);
+    REQUIRE(query.exec());
+    QStringList details;
+    while (query.next()) details << query.value("detail").toString();
+    return details.join("\n").toStdString();
+  };
+
+  SECTION("Page with before_id expected index range scan without sort") {
+    manager.getChatMessages(GetMessagePack{.chat_id = 1, .limit = 50, .before_id = 1000, .user_id = 4});
+    std::string plan = queryPlan(executor.lastSql, executor.lastValues);
+
+    CHECK_THAT(plan, Catch::Matchers::ContainsSubstring("USING INDEX idx_messages_chat_id (chat_id=? AND id<?)"));
+    CHECK_THAT(plan, !Catch::Matchers::ContainsSubstring("TEMP B-TREE"));
+    CHECK_THAT(plan, !Catch::Matchers::ContainsSubstring("SCAN messages"));
+  }
+
+  SECTION("First page expected index seek on chat_id") {
+    manager.getChatMessages(GetMessagePack{.chat_id = 1, .limit = 50, .before_id = 0, .user_id = 4});
+    std::string plan = queryPlan(executor.lastSql, executor.lastValues);
+
+    CHECK_THAT(plan, Catch::Matchers::ContainsSubstring("USING INDEX idx_messages_chat_id (chat_id=?)"));
+    CHECK_THAT(plan, !Catch::Matchers::ContainsSubstring("TEMP B-TREE"));
+  }
+
+  SECTION("Status join expected index lookup per message") {
+    manager.getChatMessages(GetMessagePack{.chat_id = 1, .limit = 50, .before_id = 1000, .user_id = 4});
+    std::string plan = queryPlan(executor.lastSql, executor.lastValues);
+
+    // either the primary key or idx_messages_status_receiver, both keyed on (message_id, receiver_id)
+    CHECK_THAT(plan, Catch::Matchers::ContainsSubstring("SEARCH messages_status USING"));
+    CHECK_THAT(plan, Catch::Matchers::ContainsSubstring("message_id=?"));
+    CHECK_THAT(plan, !Catch::Matchers::ContainsSubstring("SCAN messages_status"));
+  }
+}
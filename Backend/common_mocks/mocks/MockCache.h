@@ -14,6 +14,13 @@ class MockCache : public ICacheService {
  public:
   void incr(const std::string &key) override { mp[key]++; }
 
+  int incr_many_calls = 0;
+
+  void incrMany(const std::vector<std::string> &keys) override {
+    ++incr_many_calls;
+    for (const auto &key : keys) mp[key]++;
+  }
+
   void remove(const std::string &key) override {
     mp[key]++;
     cache.erase(key);
@@ -33,14 +40,28 @@ class MockCache : public ICacheService {
   int set_pipeline_calls = 0;
   std::optional<std::string> mock_get_string = std::nullopt;
   bool get_should_fail = false;
+  int get_calls = 0;
 
   std::optional<std::string> get(const std::string &key) override {
+    ++get_calls;
     auto it = cache.find(key);
     if (get_should_fail) return std::nullopt;
     if (mock_get_string) return mock_get_string;
     return it == cache.end() ? std::nullopt : std::make_optional(it->second);
   }
 
+  int get_many_calls = 0;
+  std::vector<std::string> last_get_many_keys;
+
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override {
+    ++get_many_calls;
+    last_get_many_keys = keys;
+    std::vector<std::optional<std::string>> values;
+    values.reserve(keys.size());
+    for (const auto &key : keys) values.push_back(get(key));
+    return values;
+  }
+
   void set(const std::string &key, const std::string &value,
            std::chrono::seconds ttl = std::chrono::hours(24)) override {
     ++set_calls;
@@ -50,9 +71,39 @@ class MockCache : public ICacheService {
 
   int getCalls(const std::string &key) { return mp[key]; }
 
+  int set_many_calls = 0;
+  int remove_many_calls = 0;
+
+  void setMany(const std::vector<CacheEntry> &entries) override {
+    ++set_many_calls;
+    for (const auto &entry : entries) {
+      cache[entry.key] = entry.value;
+      mp[entry.key]++;
+    }
+  }
+
+  void removeMany(const std::vector<std::string> &keys) override {
+    ++remove_many_calls;
+    for (const auto &key : keys) {
+      mp[key]++;
+      cache.erase(key);
+    }
+  }
+
+  int set_if_absent_calls = 0;
+
+  bool setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) override {
+    ++set_if_absent_calls;
+    return cache.try_emplace(key, value).second;
+  }
+
   void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
                     std::chrono::seconds ttl = std::chrono::minutes(30)) override {
     ++set_pipeline_calls;
+    for (std::size_t i = 0; i < keys.size() && i < results.size(); ++i) {
+      cache[keys[i]] = results[i];
+      mp[keys[i]]++;
+    }
   }
 };
 
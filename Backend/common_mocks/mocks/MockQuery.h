@@ -23,6 +23,9 @@ class MockQuery : public IQuery {
 
   QVariant NOINLINE value(const std::string &field) const override { return mock_variant; }
 
+  // every column reads mock_variant, so any position will do
+  int indexOf(const std::string &field) const override { return 0; }
+
   QString error() override { return mock_error; }
 
   QString mock_error = "mock_error";
@@ -8,7 +8,7 @@ class MockThreadPool : public IThreadPool {
   int call_count = 0;
 
  protected:
-  void enqueueTask(std::function<void()> task) override {
+  void enqueueTask(Task task, TaskPriority) override {
     ++call_count;
     task();
   }
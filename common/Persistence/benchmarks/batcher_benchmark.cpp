@@ -1,63 +1,98 @@
-// #include "benchmark/benchmark.h"
-
-// #include "Persistence/Batcher.h"
-// #include "Persistence/GenericRepository.h"
-// #include "Persistence/ThreadPool.h"
-
-// static void individualSaving(benchmark::State& state) {
-//   SQLiteDatabase db;
-
-//   GenericRepository rep(db);
-//   for (auto _ : state) {
-//     for (int i = 0; i < state.range(0); i++) {
-//       Message msg;
-//       rep.save(msg);
-//       benchmark::DoNotOptimize(msg);
-//     }
-//   }
-// }
-
-// static void batcherSaving(benchmark::State& state) {
-//   SQLiteDatabase db("bench_conn_global");
-//   GenericRepository rep(db);
-
-//   for (auto _ : state) {
-//     SaverBatcher<Message> saver_batcher(rep);
-//     for (int i = 0; i < state.range(0); i++) {
-//       Message msg;
-//       saver_batcher.saveEntity(msg);
-//       benchmark::DoNotOptimize(msg);
-//     }
-//   }
-// }
-
-// static void individualDeleting(benchmark::State& state) {
-//   SQLiteDatabase db;
-//   GenericRepository rep(db);
-//   for (auto _ : state) {
-//     for (int i = 0; i < state.range(0); i++) {
-//       Message msg{.id = i};
-//       rep.deleteEntity(msg);
-//       benchmark::DoNotOptimize(msg);
-//     }
-//   }
-// }
-
-// static void batcherDeleter(benchmark::State& state) {
-//   SQLiteDatabase db;
-//   GenericRepository rep(db);
-
-//   for (auto _ : state) {
-//     DeleterBatcher<Message> deleterBatcher(rep);
-//     for (int i = 0; i < state.range(0); i++) {
-//       Message msg{.id = i};
-//       deleterBatcher.deleteEntity(msg);
-//       benchmark::DoNotOptimize(msg);
-//     }
-//   }
-// }
-
-// BENCHMARK(individualSaving)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
-// BENCHMARK(batcherSaving)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
-// BENCHMARK(individualDeleting)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
-// BENCHMARK(batcherDeleter)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Batcher.h"
+#include "CacheBackend.h"
+#include "GenericRepository.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "benchmark/benchmark.h"
+#include "entities/MessageStatus.h"
+
+// Write path of MessageService::Controller::handleSaveMessageStatus: one save per status
+// (current pool path) vs SaverBatcher group commit. Latency is enqueue -> row committed.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char *kBenchDbName = "bench_batcher.db";
+
+std::vector<MessageStatus> makeStatuses(long long message_id, int count) {
+  std::vector<MessageStatus> statuses;
+  statuses.reserve(count);
+  for (int i = 1; i <= count; ++i) statuses.emplace_back(message_id, i, false, 0);
+  return statuses;
+}
+
+void reportLatency(benchmark::State &state, std::vector<double> &latencies_us) {
+  if (latencies_us.empty()) return;
+  std::sort(latencies_us.begin(), latencies_us.end());
+  auto percentile = [&](double p) { return latencies_us[static_cast<std::size_t>(p * (latencies_us.size() - 1))]; };
+  state.counters["p50_us"] = percentile(0.50);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["rows_per_sec"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+static void IndividualStatusSaves(benchmark::State &state) {
+  SQLiteDatabase db(kBenchDbName);
+  db.initializeSchema();
+  SqlExecutor executor(db);
+  GenericRepository rep(&executor, cacheInstance());
+  std::vector<double> latencies_us;
+  long long message_id = 1;
+
+  for (auto _ : state) {
+    for (const auto &status : makeStatuses(message_id++, static_cast<int>(state.range(0)))) {
+      auto start = Clock::now();
+      benchmark::DoNotOptimize(rep.save(status));
+      latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  reportLatency(state, latencies_us);
+}
+
+static void BatchedStatusSaves(benchmark::State &state) {
+  SQLiteDatabase db(kBenchDbName);
+  db.initializeSchema();
+  SqlExecutor executor(db);
+  GenericRepository rep(&executor, cacheInstance());
+  std::vector<double> latencies_us;
+  std::vector<Clock::time_point> enqueued_at;
+  std::size_t next_flushed = 0;
+
+  SaverBatcher<MessageStatus> batcher(
+      [&rep](std::span<const MessageStatus> statuses) { return rep.saveAll(statuses); },
+      [&](std::span<const MessageStatus> statuses, bool) {
+        auto now = Clock::now();
+        for (std::size_t i = 0; i < statuses.size(); ++i) {
+          latencies_us.push_back(std::chrono::duration<double, std::micro>(now - enqueued_at[next_flushed++]).count());
+        }
+      });
+  long long message_id = 1;
+
+  for (auto _ : state) {
+    auto statuses = makeStatuses(message_id++, static_cast<int>(state.range(0)));
+    // sized up front: the writer thread reads these slots while we enqueue
+    enqueued_at.assign(statuses.size(), Clock::time_point{});
+    next_flushed = 0;
+    for (std::size_t i = 0; i < statuses.size(); ++i) {
+      enqueued_at[i] = Clock::now();
+      batcher.saveEntity(std::move(statuses[i]));
+    }
+    batcher.flush();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["batches"] = static_cast<double>(batcher.stats().flushed_batches);
+  reportLatency(state, latencies_us);
+}
+
+BENCHMARK(IndividualStatusSaves)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BatchedStatusSaves)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
@@ -1,5 +1,6 @@
 #include <QCoreApplication>
 
+#include "CacheBackend.h"
 #include "GenericRepository.h"
 #include "Query.h"
 #include "SqlExecutor.h"
@@ -9,7 +10,7 @@
 static void EntityWithoutCache(benchmark::State &state) {
   SQLiteDatabase db;
   SqlExecutor executor(db);
-  GenericRepository rep(db, executor, RedisCache::instance());
+  GenericRepository rep(db, executor, cacheInstance());
   for (auto _ : state) {
     auto results = rep.findOne<Message>(4);
     benchmark::DoNotOptimize(results);
@@ -19,7 +20,7 @@ static void EntityWithoutCache(benchmark::State &state) {
 // static void EntityWithCache(benchmark::State& state) {
 //   SQLiteDatabase db;
 //   SqlExecutor executor(db);
-//   GenericRepository rep(db, executor, RedisCache::instance());
+//   GenericRepository rep(db, executor, cacheInstance());
 //   for (auto _ : state) {
 //     auto results = rep.findOneWithOutCache<Message>(4);
 //     benchmark::DoNotOptimize(results);
@@ -30,7 +31,7 @@ static void EntityWithCacheAsync(benchmark::State &state) {
   ThreadPool pool(4);
   SQLiteDatabase db;
   SqlExecutor executor(db);
-  GenericRepository rep(db, executor, RedisCache::instance(), &pool);
+  GenericRepository rep(db, executor, cacheInstance(), &pool);
   for (auto _ : state) {
     auto future = rep.findOneAsync<Message>(4);
     auto results = future.get();
@@ -42,7 +43,7 @@ static void EntityWithCacheAsync(benchmark::State &state) {
 //   ThreadPool pool(4);
 //   SQLiteDatabase db;
 //   SqlExecutor executor(db);
-//   GenericRepository rep(db, executor, RedisCache::instance(), &pool);
+//   GenericRepository rep(db, executor, cacheInstance(), &pool);
 //   for (auto _ : state) {
 //     auto future = rep.findOneWithOutCacheAsync<Message>(4);
 //     auto results = future.get();
@@ -52,3 +52,282 @@
 
 // cmake .. -DCMAKE_BUILD_TYPE=Release
 // cmake --build . --target benchmarks
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "GenericRepository.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "benchmark/benchmark.h"
+#include "entities/Message.h"
+#include "entities/MessageStatus.h"
+
+// Cache-hit latency of SelectQuery for the getChatMessages join (two involved
+// tables). SimulatedRedis stands in for a local Redis: every call is one round
+// trip that busy-waits range(0) microseconds, so the results count RTTs rather
+// than loopback noise.
+
+namespace {
+
+class SimulatedRedis : public ICacheService {
+ public:
+  std::chrono::microseconds rtt{0};
+  long long round_trips = 0;
+
+  void clearCache() override {
+    roundTrip();
+    values_.clear();
+  }
+  void remove(const std::string &key) override {
+    roundTrip();
+    values_.erase(key);
+  }
+  void incr(const std::string &key) override {
+    roundTrip();
+    bump(key);
+  }
+  void incrMany(const std::vector<std::string> &keys) override {
+    roundTrip();
+    for (const auto &key : keys) bump(key);
+  }
+  std::optional<std::string> get(const std::string &key) override {
+    roundTrip();
+    return lookup(key);
+  }
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override {
+    roundTrip();
+    std::vector<std::optional<std::string>> values;
+    values.reserve(keys.size());
+    for (const auto &key : keys) values.push_back(lookup(key));
+    return values;
+  }
+  void set(const std::string &key, const std::string &value, std::chrono::seconds) override {
+    roundTrip();
+    values_[key] = value;
+  }
+  void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                    std::chrono::seconds) override {
+    roundTrip();
+    for (std::size_t i = 0; i < keys.size(); ++i) values_[keys[i]] = values[i];
+  }
+  void setMany(const std::vector<CacheEntry> &entries) override {
+    roundTrip();
+    for (const auto &entry : entries) values_[entry.key] = entry.value;
+  }
+  void removeMany(const std::vector<std::string> &keys) override {
+    roundTrip();
+    for (const auto &key : keys) values_.erase(key);
+  }
+
+ private:
+  void bump(const std::string &key) {
+    values_[key] = std::to_string(std::stoll(values_.contains(key) ? values_[key] : "0") + 1);
+  }
+  void roundTrip() {
+    ++round_trips;
+    const auto until = std::chrono::steady_clock::now() + rtt;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+  }
+  std::optional<std::string> lookup(const std::string &key) const {
+    auto it = values_.find(key);
+    return it == values_.end() ? std::nullopt : std::make_optional(it->second);
+  }
+
+  std::unordered_map<std::string, std::string> values_;
+};
+
+std::unique_ptr<SelectQuery<Message>> chatPageQuery(ISqlExecutor *executor, ICacheService &cache) {
+  auto query = QueryFactory::createSelect<Message>(executor, cache);
+  query->join(MessageStatusTable::Table, MessageTable::Id, MessageStatusTable::fullField(MessageStatusTable::MessageId))
+      .where(MessageTable::ChatId, 1)
+      .limit(20)
+      .where(MessageStatusTable::fullField(MessageStatusTable::ReceiverId), 1);
+  query->orderBy(MessageTable::Id, OrderDirection::DESC);
+  return query;
+}
+
+SqlExecutor &benchExecutor() {
+  static SQLiteDatabase db(":memory:");
+  static bool ready = db.initializeSchema();
+  (void)ready;
+  static SqlExecutor executor(db);
+  return executor;
+}
+
+void reportRoundTrips(benchmark::State &state, const SimulatedRedis &cache, long long before) {
+  state.counters["round_trips"] =
+      static_cast<double>(cache.round_trips - before) / static_cast<double>(std::max<int64_t>(1, state.iterations()));
+}
+
+}  // namespace
+
+// the read path before batching: one GET per involved table's generation, then a GET for the entry
+static void CacheHitSequentialGets(benchmark::State &state) {
+  SimulatedRedis cache;
+  const std::vector<std::string> tables{MessageTable::Table, MessageStatusTable::Table};
+  const std::string entry_key = "query_cache:chat_page";
+  cache.set(entry_key + ":gen=00", reflection::toJson(std::vector<Message>{}).dump(), std::chrono::seconds{30});
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    std::string generations;
+    for (const auto &table : tables) generations += cache.get(GenerationSnapshot::cacheKey(table)).value_or("0");
+    auto entry = cache.get(entry_key + ":gen=" + generations);
+    auto rows = reflection::listFromJson<Message>(nlohmann::json::parse(*entry));
+    benchmark::DoNotOptimize(rows);
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+static void CacheHitSelectQuery(benchmark::State &state) {
+  SimulatedRedis cache;
+  chatPageQuery(&benchExecutor(), cache)->execute();  // warms the entry
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    auto result = chatPageQuery(&benchExecutor(), cache)->execute();
+    benchmark::DoNotOptimize(result);
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+static void CacheHitSelectQueryWithSnapshot(benchmark::State &state) {
+  SimulatedRedis cache;
+  GenerationSnapshot::instance().setTtl(std::chrono::milliseconds(100));
+  chatPageQuery(&benchExecutor(), cache)->execute();
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    auto result = chatPageQuery(&benchExecutor(), cache)->execute();
+    benchmark::DoNotOptimize(result);
+  }
+
+  reportRoundTrips(state, cache, before);
+  GenerationSnapshot::instance().setTtl(std::chrono::milliseconds(0));
+}
+
+BENCHMARK(CacheHitSequentialGets)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+BENCHMARK(CacheHitSelectQuery)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+BENCHMARK(CacheHitSelectQueryWithSnapshot)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+
+// The per-message lookups of one chat page (20 read-status queries), all cache
+// hits: one execute() per message versus SelectQuery::executeAll for the page.
+namespace {
+
+constexpr long long kPageMessages = 20;
+
+std::vector<std::unique_ptr<SelectQuery<MessageStatus>>> readStatusQueries(ICacheService &cache) {
+  std::vector<std::unique_ptr<SelectQuery<MessageStatus>>> queries;
+  for (long long message_id = 1; message_id <= kPageMessages; ++message_id) {
+    queries.push_back(QueryFactory::createSelect<MessageStatus>(&benchExecutor(), cache));
+    queries.back()->where(MessageStatusTable::MessageId, message_id).where(MessageStatusTable::IsRead, 1);
+  }
+  return queries;
+}
+
+}  // namespace
+
+static void PageLookupsOneByOne(benchmark::State &state) {
+  SimulatedRedis cache;
+  for (const auto &query : readStatusQueries(cache)) query->execute();
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    for (const auto &query : readStatusQueries(cache)) benchmark::DoNotOptimize(query->execute());
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+static void PageLookupsBatched(benchmark::State &state) {
+  SimulatedRedis cache;
+  for (const auto &query : readStatusQueries(cache)) query->execute();
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    auto queries = readStatusQueries(cache);
+    std::vector<const SelectQuery<MessageStatus> *> batch;
+    for (const auto &query : queries) batch.push_back(query.get());
+    benchmark::DoNotOptimize(SelectQuery<MessageStatus>::executeAll(batch));
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+BENCHMARK(PageLookupsOneByOne)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+BENCHMARK(PageLookupsBatched)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+
+// getMessage for a page of ids right after another message was written to the
+// table: the generation bump turns every query cache entry stale, while the
+// entity cache entries stay valid (they are set and removed per row)
+
+namespace {
+
+std::vector<long long> seedPageMessages(ICacheService &cache) {
+  GenericRepository repository(&benchExecutor(), cache);
+  std::vector<long long> ids;
+  for (long long i = 0; i < kPageMessages; ++i) {
+    Message message;
+    message.id = 10'000 + i;
+    message.chat_id = 1;
+    message.sender_id = 2;
+    message.text = "message " + std::to_string(message.id);
+    message.timestamp = 1'700'000'000'000LL + i;
+    message.local_id = std::to_string(message.id);
+    repository.save(message);
+    ids.push_back(message.id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+static void MessagesByIdQueryCache(benchmark::State &state) {
+  SimulatedRedis cache;
+  const auto ids = seedPageMessages(cache);
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    bumpTableGeneration(cache, MessageTable::Table);
+    std::vector<std::unique_ptr<SelectQuery<Message>>> queries;
+    std::vector<const SelectQuery<Message> *> batch;
+    for (long long id : ids) {
+      queries.push_back(QueryFactory::createSelect<Message>(&benchExecutor(), cache));
+      queries.back()->where(MessageTable::Id, id).limit(1);
+      batch.push_back(queries.back().get());
+    }
+    benchmark::DoNotOptimize(SelectQuery<Message>::executeAll(batch));
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+static void MessagesByIdEntityCache(benchmark::State &state) {
+  SimulatedRedis cache;
+  const auto ids = seedPageMessages(cache);
+  cache.rtt = std::chrono::microseconds(state.range(0));
+  const long long before = cache.round_trips;
+
+  for (auto _ : state) {
+    bumpTableGeneration(cache, MessageTable::Table);
+    auto messages = entity_cache::findByIds<Message>(&benchExecutor(), cache, ids);
+    if (messages.size() != ids.size()) state.SkipWithError("missing messages");
+    benchmark::DoNotOptimize(messages);
+  }
+
+  reportRoundTrips(state, cache, before);
+}
+
+BENCHMARK(MessagesByIdQueryCache)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+BENCHMARK(MessagesByIdEntityCache)->Arg(0)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
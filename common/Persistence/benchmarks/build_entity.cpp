@@ -2,10 +2,17 @@
 #include <QtSql/QSqlQuery>
 
 #include "GenericRepository.h"
-#include "MessageService/include/entities/Message.h"
 #include "Meta.h"
+#include "StaticReflection.h"
 #include "benchmark/benchmark.h"
+#include "entities/Message.h"
 #include "interfaces/IEntityBuilder.h"
+#include "metaentity/metaentities.h"
+#include "query/SQLiteQuery.h"
+
+namespace {
+
+constexpr int kMaxRows = 100000;
 
 QSqlDatabase getBenchmarkDb() {
   static bool initialized = false;
@@ -18,23 +25,27 @@ QSqlDatabase getBenchmarkDb() {
 
     QSqlQuery q(db);
     q.exec(R"(CREATE TABLE messages (
-            id INTEGER,
+            id INTEGER PRIMARY KEY,
             chat_id INTEGER,
             sender_id INTEGER,
             text TEXT,
-            timestamp INTEGER
+            timestamp INTEGER,
+            local_id TEXT,
+            answer_on INTEGER NULL
         );)");
 
     db.transaction();
-    for (int i = 0; i < 1000; ++i) {
-      q.prepare(
-          "INSERT INTO messages (id, chat_id, sender_id, text, timestamp) "
-          "VALUES (?, ?, ?, ?, ?)");
+    q.prepare(
+        "INSERT INTO messages (id, chat_id, sender_id, text, timestamp, local_id, answer_on) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)");
+    for (int i = 1; i <= kMaxRows; ++i) {
       q.addBindValue(i);
-      q.addBindValue(i % 10);
-      q.addBindValue(i % 50);
+      q.addBindValue(i % 10 + 1);
+      q.addBindValue(i % 50 + 1);
       q.addBindValue(QString("Message %1").arg(i));
       q.addBindValue(1000000 + i);
+      q.addBindValue(QString::number(i));
+      q.addBindValue(i % 3 == 0 ? QVariant(i - 1) : QVariant());
       q.exec();
     }
     db.commit();
@@ -45,10 +56,54 @@ QSqlDatabase getBenchmarkDb() {
   return db;
 }
 
+// The type-erased path SqlBuilder used before EntityFields drove materialization.
+std::any metaFieldValue(const QVariant &v, const Field &f) {
+  if (f.type == typeid(std::optional<long long>)) {
+    return v.isNull() ? std::any(std::optional<long long>{}) : std::any(std::optional<long long>{v.toLongLong()});
+  }
+  if (f.type == typeid(long long)) return std::any(v.toLongLong());
+  if (f.type == typeid(std::string)) return std::any(v.toString().toStdString());
+  if (f.type == typeid(bool)) return std::any(static_cast<bool>(v.toInt()));
+  if (f.type == typeid(int)) return std::any(v.toInt());
+  return {};
+}
+
+QVariant metaToVariant(const Field &f, const Message &entity) {
+  std::any val = f.get(&entity);
+  if (f.type == typeid(long long)) return QVariant::fromValue(std::any_cast<long long>(val));
+  if (f.type == typeid(int)) return QVariant::fromValue(std::any_cast<int>(val));
+  if (f.type == typeid(std::string)) return QString::fromStdString(std::any_cast<std::string>(val));
+  if (f.type == typeid(bool)) return static_cast<int>(std::any_cast<bool>(val));
+  if (f.type == typeid(std::optional<long long>)) {
+    auto opt = std::any_cast<std::optional<long long>>(val);
+    return opt ? QVariant::fromValue(*opt) : QVariant();
+  }
+  return {};
+}
+
+std::unique_ptr<SQLiteQuery> selectMessages(int rows) {
+  auto query = std::make_unique<SQLiteQuery>(getBenchmarkDb());
+  query->prepare("SELECT * FROM messages LIMIT ?");
+  query->bind(rows);
+  return query;
+}
+
+std::vector<Message> makeMessages(int rows) {
+  std::vector<Message> messages;
+  messages.reserve(rows);
+  for (int i = 1; i <= rows; ++i) {
+    messages.emplace_back(i, i % 10 + 1, i % 50 + 1, 1000000 + i, "Message " + std::to_string(i), std::to_string(i),
+                          i % 3 == 0 ? std::make_optional<long long>(i - 1) : std::nullopt);
+  }
+  return messages;
+}
+
+}  // namespace
+
 static void BM_BuildEntity_Dynamic(benchmark::State &state) {
   QSqlDatabase db = getBenchmarkDb();
   QSqlQuery query(db);
-  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages;");
+  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages LIMIT 1000;");
   auto builder = makeBuilder<Message>(BuilderType::Meta);
 
   for (auto _ : state) {
@@ -64,7 +119,7 @@ static void BM_BuildEntity_Dynamic(benchmark::State &state) {
 static void BM_BuildEntity_Static(benchmark::State &state) {
   QSqlDatabase db = getBenchmarkDb();
   QSqlQuery query(db);
-  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages;");
+  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages LIMIT 1000;");
 
   for (auto _ : state) {
     query.first();
@@ -85,7 +140,7 @@ static void BM_BuildEntity_Static(benchmark::State &state) {
 static void BM_BuildEntity_Fast(benchmark::State &state) {
   QSqlDatabase db = getBenchmarkDb();
   QSqlQuery query(db);
-  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages;");
+  query.exec("SELECT * FROM messages LIMIT 1000;");
   auto builder = makeBuilder<Message>(BuilderType::Fast);
 
   for (auto _ : state) {
@@ -101,7 +156,7 @@ static void BM_BuildEntity_Fast(benchmark::State &state) {
 static void BM_GenericBuildEntity_Fast(benchmark::State &state) {
   QSqlDatabase db = getBenchmarkDb();
   QSqlQuery query(db);
-  query.exec("SELECT id, chat_id, sender_id, text, timestamp FROM messages;");
+  query.exec("SELECT * FROM messages LIMIT 1000;");
   auto builder = makeBuilder<Message>(BuilderType::Generic);
 
   for (auto _ : state) {
@@ -114,7 +169,91 @@ static void BM_GenericBuildEntity_Fast(benchmark::State &state) {
   }
 }
 
+// Row materialization through IQuery, as SqlBuilder::buildResults does it
+static void BM_Materialize_Meta(benchmark::State &state) {
+  auto query = selectMessages(static_cast<int>(state.range(0)));
+  const Meta meta = Reflection<Message>::meta();
+
+  for (auto _ : state) {
+    query->exec();
+    std::vector<Message> results;
+    while (query->next()) {
+      Message entity;
+      for (const auto &f : meta.fields) f.set(&entity, metaFieldValue(query->value(f.name), f));
+      results.push_back(std::move(entity));
+    }
+    benchmark::DoNotOptimize(results);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Materialize_Reflection(benchmark::State &state) {
+  auto query = selectMessages(static_cast<int>(state.range(0)));
+
+  for (auto _ : state) {
+    query->exec();
+    std::vector<Message> results;
+    const auto columns = reflection::columnIndices<Message>(*query);
+    while (query->next()) {
+      results.push_back(reflection::build<Message>(*query, columns));
+    }
+    benchmark::DoNotOptimize(results);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BindInsert_Meta(benchmark::State &state) {
+  const auto messages = makeMessages(static_cast<int>(state.range(0)));
+  const Meta meta = Reflection<Message>::meta();
+
+  for (auto _ : state) {
+    for (const auto &message : messages) {
+      QList<QVariant> values;
+      for (const auto &f : meta.fields) values << metaToVariant(f, message);
+      benchmark::DoNotOptimize(values);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BindInsert_Reflection(benchmark::State &state) {
+  const auto messages = makeMessages(static_cast<int>(state.range(0)));
+
+  for (auto _ : state) {
+    for (const auto &message : messages) {
+      auto values = reflection::bindValues(message);
+      benchmark::DoNotOptimize(values);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ToJson_Adl(benchmark::State &state) {
+  const auto messages = makeMessages(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::string dumped = nlohmann::json(messages).dump();
+    benchmark::DoNotOptimize(dumped);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ToJson_Reflection(benchmark::State &state) {
+  const auto messages = makeMessages(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::string dumped = reflection::toJson(messages).dump();
+    benchmark::DoNotOptimize(dumped);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 BENCHMARK(BM_BuildEntity_Dynamic);
 BENCHMARK(BM_BuildEntity_Static);
 BENCHMARK(BM_BuildEntity_Fast);
 BENCHMARK(BM_GenericBuildEntity_Fast);
+
+BENCHMARK(BM_Materialize_Meta)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Materialize_Reflection)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BindInsert_Meta)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BindInsert_Reflection)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ToJson_Adl)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ToJson_Reflection)->Arg(1000)->Arg(kMaxRows)->Unit(benchmark::kMillisecond);
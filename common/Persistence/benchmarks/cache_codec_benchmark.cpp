@@ -0,0 +1,89 @@
+#include <string>
+#include <vector>
+
+#include "CacheCodec.h"
+#include "GenericRepository.h"
+#include "benchmark/benchmark.h"
+#include "entities/Message.h"
+
+// Cost of the cache codec per format on chat messages. The page benchmarks
+// encode / decode a query cache entry of kPageSize messages, as SelectQuery
+// writes on a miss and reads on a hit. MessagesFootprint encodes 100k entity
+// cache values (GenericRepository::save) and reports their payload bytes, the
+// part of Redis memory that depends on the format.
+
+namespace {
+
+constexpr int kPageSize = 20;
+constexpr int kFootprintMessages = 100'000;
+
+Message benchMessage(long long id) {
+  Message message;
+  message.id = id;
+  message.chat_id = 1 + id % 1000;
+  message.sender_id = 1 + id % 5000;
+  message.timestamp = 1'700'000'000'000LL + id * 1000;
+  message.text = "message text of a typical chat line number " + std::to_string(id);
+  message.local_id = "local-" + std::to_string(id);
+  if (id % 4 == 0) message.answer_on = id - 1;
+  return message;
+}
+
+std::vector<Message> benchPage() {
+  std::vector<Message> page;
+  for (int i = 0; i < kPageSize; ++i) page.push_back(benchMessage(1'000'000 + i));
+  return page;
+}
+
+}  // namespace
+
+template <CacheFormat F>
+static void EncodeQueryEntry(benchmark::State &state) {
+  const auto page = benchPage();
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    auto encoded = cache_codec::encodeQueryEntry<Message, F>("a3f1c2d4e5b60718", 1'700'000'000'000LL, page);
+    bytes = encoded.size();
+    benchmark::DoNotOptimize(encoded);
+  }
+  state.counters["entry_bytes"] = static_cast<double>(bytes);
+  state.SetItemsProcessed(state.iterations() * kPageSize);
+}
+
+template <CacheFormat F>
+static void DecodeQueryEntry(benchmark::State &state) {
+  const auto encoded = cache_codec::encodeQueryEntry<Message, F>("a3f1c2d4e5b60718", 1'700'000'000'000LL, benchPage());
+  for (auto _ : state) {
+    auto view = cache_codec::readQueryEntry<Message, F>(encoded);
+    auto rows = cache_codec::decodeRows<Message, F>(view->rows);
+    if (!rows || rows->size() != kPageSize) state.SkipWithError("decode failed");
+    benchmark::DoNotOptimize(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * kPageSize);
+}
+
+template <CacheFormat F>
+static void MessagesFootprint(benchmark::State &state) {
+  std::vector<Message> messages;
+  messages.reserve(kFootprintMessages);
+  for (int i = 0; i < kFootprintMessages; ++i) messages.push_back(benchMessage(i));
+
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    bytes = 0;
+    for (const auto &message : messages) bytes += cache_codec::encode<Message, F>(message).size();
+    benchmark::DoNotOptimize(bytes);
+  }
+  state.counters["bytes_per_100k"] = static_cast<double>(bytes);
+  state.SetItemsProcessed(state.iterations() * kFootprintMessages);
+}
+
+BENCHMARK_TEMPLATE(EncodeQueryEntry, CacheFormat::Json)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(EncodeQueryEntry, CacheFormat::MsgPack)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(EncodeQueryEntry, CacheFormat::Fields)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(DecodeQueryEntry, CacheFormat::Json)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(DecodeQueryEntry, CacheFormat::MsgPack)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(DecodeQueryEntry, CacheFormat::Fields)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(MessagesFootprint, CacheFormat::Json)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(MessagesFootprint, CacheFormat::MsgPack)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(MessagesFootprint, CacheFormat::Fields)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,82 @@
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+#include <string>
+
+#include "QueryKeyHasher.h"
+#include "benchmark/benchmark.h"
+
+// Building the query cache key for a chat page (message/status join, 4 bound
+// values). range(0) is the number of extra bound values, to show how both
+// schemes scale with the parameter list.
+
+namespace {
+
+const QString kChatPageSql =
+    "SELECT * FROM messages JOIN messages_status ON messages.id = messages_status.message_id "
+    "WHERE messages.chat_id = ? AND messages_status.receiver_id = ? AND messages.id < ? "
+    "ORDER BY messages.id DESC LIMIT ?";
+
+QVector<QVariant> chatPageParams(int64_t extra) {
+  QVector<QVariant> params{42LL, 7LL, 1'000'000LL, 20};
+  for (int64_t i = 0; i < extra; ++i) params.push_back(QString("value %1").arg(i));
+  return params;
+}
+
+// the scheme SelectQuery used before QueryKeyHasher: the SQL copied into the
+// key and an order-insensitive XOR of per-value std::hash over toString
+std::string legacyQueryCacheKey(const QString &sql, const QVector<QVariant> &params) {
+  std::size_t params_hash = 0;
+  for (const auto &v : params) params_hash ^= std::hash<std::string>{}(v.toString().toStdString());
+  return "query_cache:" + sql.toStdString() + ":params=" + std::to_string(params_hash);
+}
+
+}  // namespace
+
+static void LegacyQueryCacheKey(benchmark::State &state) {
+  const auto params = chatPageParams(state.range(0));
+  for (auto _ : state) {
+    auto key = legacyQueryCacheKey(kChatPageSql, params);
+    benchmark::DoNotOptimize(key);
+  }
+  state.counters["key_bytes"] = static_cast<double>(legacyQueryCacheKey(kChatPageSql, params).size());
+}
+
+static void HashedQueryCacheKey(benchmark::State &state) {
+  const auto params = chatPageParams(state.range(0));
+  for (auto _ : state) {
+    auto key = makeQueryCacheKey(kChatPageSql, params);
+    benchmark::DoNotOptimize(key);
+  }
+  state.counters["key_bytes"] = static_cast<double>(makeQueryCacheKey(kChatPageSql, params).size());
+}
+
+// pages of one chat differ only in which value sits where: count how many
+// (receiver, before_id) swaps land on an already used key
+template <typename MakeKey>
+void countSwappedCollisions(benchmark::State &state, MakeKey make_key) {
+  double collisions = 0;
+  for (auto _ : state) {
+    collisions = 0;
+    for (long long a = 1; a <= 64; ++a) {
+      for (long long b = a + 1; b <= 64; ++b) {
+        if (make_key(kChatPageSql, {42LL, a, b, 20}) == make_key(kChatPageSql, {42LL, b, a, 20})) ++collisions;
+      }
+    }
+  }
+  state.counters["collisions"] = collisions;
+}
+
+static void LegacyQueryCacheKeySwappedParams(benchmark::State &state) {
+  countSwappedCollisions(state, legacyQueryCacheKey);
+}
+
+static void HashedQueryCacheKeySwappedParams(benchmark::State &state) {
+  countSwappedCollisions(state, makeQueryCacheKey);
+}
+
+BENCHMARK(LegacyQueryCacheKey)->Arg(0)->Arg(8)->Arg(64);
+BENCHMARK(HashedQueryCacheKey)->Arg(0)->Arg(8)->Arg(64);
+BENCHMARK(LegacyQueryCacheKeySwappedParams)->Unit(benchmark::kMicrosecond);
+BENCHMARK(HashedQueryCacheKeySwappedParams)->Unit(benchmark::kMicrosecond);
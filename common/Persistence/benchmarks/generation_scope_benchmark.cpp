@@ -0,0 +1,120 @@
+#include <random>
+#include <unordered_map>
+
+#include "GenerationScope.h"
+#include "GenericRepository.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "benchmark/benchmark.h"
+#include "entities/Message.h"
+
+// Query cache hit ratio of chat pages with 1k active chats. Every iteration reads
+// the page (`chat_id = ? ORDER BY id DESC LIMIT 20`) of a random chat, and every
+// range(1)-th iteration a message lands in another random chat. range(0) is the
+// invalidation the write does:
+// 0 - table-wide: the write bumps the whole messages table, as before partitions
+// 1 - scoped: generation_scope::bumpRows bumps only the chat that got the message
+// hit_ratio is the share of reads served from the cache.
+
+namespace {
+
+constexpr long long kActiveChats = 1000;
+
+class MapCache : public ICacheService {
+ public:
+  void clearCache() override { values_.clear(); }
+  void remove(const std::string &key) override { values_.erase(key); }
+  void incr(const std::string &key) override {
+    auto &value = values_[key];
+    value = std::to_string(std::stoll(value.empty() ? "0" : value) + 1);
+  }
+  std::optional<std::string> get(const std::string &key) override {
+    auto it = values_.find(key);
+    return it == values_.end() ? std::nullopt : std::make_optional(it->second);
+  }
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override {
+    std::vector<std::optional<std::string>> values;
+    values.reserve(keys.size());
+    for (const auto &key : keys) values.push_back(get(key));
+    return values;
+  }
+  void set(const std::string &key, const std::string &value, std::chrono::seconds) override { values_[key] = value; }
+  void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                    std::chrono::seconds ttl) override {
+    for (std::size_t i = 0; i < keys.size(); ++i) set(keys[i], values[i], ttl);
+  }
+  void setMany(const std::vector<CacheEntry> &entries) override {
+    for (const auto &entry : entries) set(entry.key, entry.value, entry.ttl);
+  }
+  void removeMany(const std::vector<std::string> &keys) override {
+    for (const auto &key : keys) remove(key);
+  }
+
+ private:
+  std::unordered_map<std::string, std::string> values_;
+};
+
+class CountingExecutor : public ISqlExecutor {
+ public:
+  explicit CountingExecutor(ISqlExecutor &executor) : executor_(executor) {}
+
+  SqlExecutorResult execute(const QString &sql, const QList<QVariant> &values) override {
+    ++executions;
+    return executor_.execute(sql, values);
+  }
+
+  long long executions = 0;
+
+ private:
+  ISqlExecutor &executor_;
+};
+
+SqlExecutor &scopeExecutor() {
+  static SQLiteDatabase db("bench_generation_scope.db", SQLiteProfile::readHeavy());
+  static bool ready = db.initializeSchema();
+  (void)ready;
+  static SqlExecutor executor(db);
+  return executor;
+}
+
+}  // namespace
+
+static void ChatPageHitRatio(benchmark::State &state) {
+  const bool scoped = state.range(0) == 1;
+  const long long write_every = state.range(1);
+  MapCache cache;
+  CountingExecutor executor(scopeExecutor());
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<long long> chats(1, kActiveChats);
+
+  long long reads = 0;
+  for (auto _ : state) {
+    if (++reads % write_every == 0) {
+      Message message;
+      message.id = reads;
+      message.chat_id = chats(rng);
+      if (scoped) {
+        generation_scope::bumpRows<Message>(cache, std::span<const Message>(&message, 1));
+      } else {
+        generation_scope::bumpTable(cache, MessageTable::Table);
+      }
+    }
+
+    auto query = QueryFactory::createSelect<Message>(&executor, cache);
+    query->where(MessageTable::ChatId, chats(rng)).limit(20);
+    query->orderBy(MessageTable::Id, OrderDirection::DESC);
+    auto result = query->execute();
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.counters["hit_ratio"] = reads == 0 ? 0.0 : 1.0 - static_cast<double>(executor.executions) / reads;
+}
+
+BENCHMARK(ChatPageHitRatio)
+    ->ArgNames({"scoped", "write_every"})
+    ->Args({0, 100})
+    ->Args({1, 100})
+    ->Args({0, 10})
+    ->Args({1, 10})
+    ->Iterations(200'000)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,128 @@
+#include <QtSql/QSqlQuery>
+#include <QVariant>
+
+#include "CacheBackend.h"
+#include "GenericRepository.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "benchmark/benchmark.h"
+#include "entities/Message.h"
+
+// Chat history pages at increasing depth: 1M messages over 10k chats, with one
+// hot chat holding every 10th message (100k) so that deep pages exist. Every
+// message has a messages_status row for kReceiver, as getChatMessages joins it.
+// range(0) is the page depth (pages of kPageSize skipped).
+
+namespace {
+
+constexpr int kTotalMessages = 1'000'000;
+constexpr int kChats = 10'000;
+constexpr long long kHotChat = 1;
+constexpr long long kReceiver = 1;
+constexpr int kPageSize = 20;
+
+long long chatFor(int index) { return index % 10 == 0 ? kHotChat : 2 + index % (kChats - 1); }
+
+bool seed(SQLiteDatabase &db) {
+  if (!db.initializeSchema()) return false;
+
+  QSqlQuery count(db.db());
+  if (count.exec("SELECT COUNT(*) FROM messages") && count.next() && count.value(0).toInt() >= kTotalMessages) {
+    return true;
+  }
+  count.finish();
+
+  QSqlQuery q(db.db());
+  q.exec("DELETE FROM messages");
+  q.exec("DELETE FROM messages_status");
+  q.exec("BEGIN");
+
+  QSqlQuery insert_message(db.db());
+  insert_message.prepare("INSERT INTO messages (id, chat_id, sender_id, text, timestamp, local_id) VALUES (?, ?, ?, ?, ?, ?)");
+  QSqlQuery insert_status(db.db());
+  insert_status.prepare("INSERT INTO messages_status (message_id, receiver_id, is_read, read_at) VALUES (?, ?, 0, 0)");
+
+  for (int i = 0; i < kTotalMessages; ++i) {
+    const long long id = i + 1;
+    insert_message.addBindValue(id);
+    insert_message.addBindValue(chatFor(i));
+    insert_message.addBindValue(2);
+    insert_message.addBindValue(QString("message %1").arg(id));
+    insert_message.addBindValue(1'700'000'000'000LL + id);
+    insert_message.addBindValue(QString::number(id));
+    insert_message.exec();
+
+    insert_status.addBindValue(id);
+    insert_status.addBindValue(kReceiver);
+    insert_status.exec();
+  }
+
+  q.exec("COMMIT");
+  q.exec("ANALYZE");
+  return true;
+}
+
+SQLiteDatabase &paginationDb() {
+  static SQLiteDatabase db("bench_pagination.db", SQLiteProfile::readHeavy());
+  static bool seeded = seed(db);
+  (void)seeded;
+  return db;
+}
+
+// id of the newest message left after skipping `depth` pages, i.e. the keyset cursor
+long long beforeIdAtDepth(SQLiteDatabase &db, int64_t depth) {
+  if (depth == 0) return 0;
+  QSqlQuery q(db.db());
+  q.prepare("SELECT id FROM messages WHERE chat_id = ? ORDER BY id DESC LIMIT 1 OFFSET ?");
+  q.addBindValue(kHotChat);
+  q.addBindValue(static_cast<qlonglong>(depth * kPageSize - 1));
+  return q.exec() && q.next() ? q.value(0).toLongLong() : 0;
+}
+
+}  // namespace
+
+// the query MessageQueryManager::getChatMessages builds, streamed so the query cache stays out of the way
+static void KeysetChatPage(benchmark::State &state) {
+  auto &db = paginationDb();
+  SqlExecutor executor(db);
+  const long long before_id = beforeIdAtDepth(db, state.range(0));
+
+  for (auto _ : state) {
+    auto query = QueryFactory::createSelect<Message>(&executor, cacheInstance());
+    query->join(MessageStatusTable::Table, MessageTable::Id, MessageStatusTable::fullField(MessageStatusTable::MessageId))
+        .where(MessageTable::ChatId, kHotChat)
+        .limit(kPageSize)
+        .where(MessageStatusTable::fullField(MessageStatusTable::ReceiverId), kReceiver);
+    query->orderBy(MessageTable::Id, OrderDirection::DESC);
+    if (before_id > 0) query->where(MessageTable::Id, Operator::Less, before_id);
+
+    auto cursor = query->stream();
+    for (auto &message : cursor) benchmark::DoNotOptimize(message);
+    if (cursor.rowsRead() != kPageSize) state.SkipWithError("short page");
+  }
+
+  state.SetItemsProcessed(state.iterations() * kPageSize);
+}
+
+// same page addressed with OFFSET: SQLite still walks every skipped row
+static void OffsetChatPage(benchmark::State &state) {
+  auto &db = paginationDb();
+  SqlExecutor executor(db);
+  const QString sql =
+      "SELECT * FROM messages JOIN messages_status ON id = messages_status.message_id "
+      "WHERE chat_id = ? AND messages_status.receiver_id = ? ORDER BY id DESC LIMIT ? OFFSET ?";
+  const QList<QVariant> values{kHotChat, kReceiver, kPageSize, static_cast<qlonglong>(state.range(0) * kPageSize)};
+  SqlBuilder builder;
+
+  for (auto _ : state) {
+    auto result = executor.execute(sql, values);
+    auto messages = builder.buildResults<Message>(result.query);
+    if (messages.size() != kPageSize) state.SkipWithError("short page");
+    benchmark::DoNotOptimize(messages);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kPageSize);
+}
+
+BENCHMARK(KeysetChatPage)->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Arg(4000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(OffsetChatPage)->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Arg(4000)->Unit(benchmark::kMicrosecond);
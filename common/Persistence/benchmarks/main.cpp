@@ -1,4 +1,5 @@
 #include <QCoreApplication>
+#include <cstdlib>
 
 #include "GenericRepository.h"
 #include "Query.h"
@@ -6,6 +7,8 @@
 
 int main(int argc, char **argv) {
   QCoreApplication app(argc, argv);
+  // cacheInstance() is the in-process LocalCache unless CACHE_BACKEND=redis is exported
+  setenv("CACHE_BACKEND", "local", 0);
 
   {
     auto null_logger = spdlog::stderr_color_mt("null");
@@ -1,31 +1,79 @@
-#include "GenericRepository.h"
+#include <QtSql/QSqlQuery>
+
 #include "SQLiteDataBase.h"
+#include "SqlBuilder.h"
+#include "SqlExecutor.h"
 #include "benchmark/benchmark.h"
+#include "metaentity/metaentities.h"
+
+namespace {
+
+constexpr const char *kBenchDbName = "bench_prepared_statements.db";
+
+void createMessagesTable(SQLiteDatabase &db) {
+  db.exec(R"(CREATE TABLE IF NOT EXISTS messages (
+            id INTEGER PRIMARY KEY,
+            chat_id INT,
+            sender_id INT,
+            text TEXT,
+            timestamp INTEGER,
+            local_id TEXT,
+            answer_on INT NULL
+        );)");
+}
+
+Message makeMessage(long long id) {
+  return Message(id, id % 10 + 1, id % 50 + 1, 1000000 + id, "Message " + std::to_string(id), std::to_string(id));
+}
+
+}  // namespace
+
+static void PrepareQuery(benchmark::State &state) {
+  SQLiteDatabase db(kBenchDbName);
+  createMessagesTable(db);
+  const QString sql = "SELECT * FROM messages WHERE id = ?";
+  for (auto _ : state) {
+    QSqlQuery q(db.db());
+    q.prepare(sql);
+    benchmark::DoNotOptimize(q);
+  }
+}
+
+static void PrepareQueryWithCache(benchmark::State &state) {
+  SQLiteDatabase db(kBenchDbName);
+  createMessagesTable(db);
+  const QString sql = "SELECT * FROM messages WHERE id = ?";
+  for (auto _ : state) {
+    auto q = db.prepare(sql);
+    benchmark::DoNotOptimize(q);
+  }
+  state.counters["hits"] = static_cast<double>(db.statementCacheStats().hits);
+  state.counters["misses"] = static_cast<double>(db.statementCacheStats().misses);
+}
+
+// Full SqlExecutor path used by GenericRepository::save; range(0) is the statement cache capacity (0 = old path)
+static void ExecuteInsert(benchmark::State &state) {
+  SQLiteDatabase db(kBenchDbName, static_cast<std::size_t>(state.range(0)));
+  createMessagesTable(db);
+  SqlExecutor executor(db);
+  SqlBuilder builder;
+  long long id = 1;
+
+  db.transaction();
+  for (auto _ : state) {
+    SqlStatement statement = builder.buildInsert<Message>(makeMessage(id++));
+    auto result = executor.execute(statement.query, statement.values);
+    benchmark::DoNotOptimize(result);
+  }
+  db.rollback();
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["hits"] = static_cast<double>(db.statementCacheStats().hits);
+}
 
-// static void PrepareQuery(benchmark::State& state) {
-//   SQLiteDatabase db;
-//   GenericRepository rep(db);
-//   QString sql = "SELECT * FROM %1 WHERE id = ?";
-//   for (auto _ : state) {
-//     auto treadDb = db.getThreadDatabase();
-//     QSqlQuery q(treadDb);
-//     q.prepare(QString(sql).arg("messages"));
-//     benchmark::DoNotOptimize(q);
-//   }
-// }
-
-// static void PrepareQueryWithCache(benchmark::State& state) {
-//   SQLiteDatabase db;
-//   GenericRepository rep(db);
-//   QString sql = "SELECT * FROM %1 WHERE id = ?";
-//   for (auto _ : state) {
-//     auto& q = rep.getPreparedQuery("key", sql);
-//     benchmark::DoNotOptimize(q);
-//   }
-// }
-
-// BENCHMARK(PrepareQuery)->Iterations(100);
-// BENCHMARK(PrepareQueryWithCache)->Iterations(100);
+BENCHMARK(PrepareQuery);
+BENCHMARK(PrepareQueryWithCache);
+BENCHMARK(ExecuteInsert)->Arg(0)->Arg(SQLiteDatabase::kDefaultStatementCacheCapacity);
 
 // cmake .. -DCMAKE_BUILD_TYPE=Release
 // cmake --build . --target benchmarks
@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "GenericRepository.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "benchmark/benchmark.h"
+#include "entities/Message.h"
+#include "entities/MessageStatus.h"
+
+// 64 threads read the same chat page while one of them bumps the messages
+// generation every kBumpEvery reads, so every bump turns the hot entry into a
+// miss (or a stale entry) for all of them at once. The page query is made to
+// cost kQueryCost, like a cold page on a loaded database. range(0) is the mode:
+// 0 - every caller that misses reads the database (single flight off)
+// 1 - QueryCachePolicy single flight
+// 2 - single flight + stale while revalidate
+// db_per_miss is the number of database reads per generation bump.
+
+namespace {
+
+constexpr int kBumpEvery = 20;
+constexpr auto kQueryCost = std::chrono::milliseconds(2);
+
+// thread-safe in-memory stand-in for Redis, SET NX included
+class SharedCache : public ICacheService {
+ public:
+  void clearCache() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.clear();
+  }
+  void remove(const std::string &key) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.erase(key);
+  }
+  void incr(const std::string &key) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &value = values_[key];
+    value = std::to_string(std::stoll(value.empty() ? "0" : value) + 1);
+  }
+  std::optional<std::string> get(const std::string &key) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = values_.find(key);
+    return it == values_.end() ? std::nullopt : std::make_optional(it->second);
+  }
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override {
+    std::vector<std::optional<std::string>> values;
+    values.reserve(keys.size());
+    for (const auto &key : keys) values.push_back(get(key));
+    return values;
+  }
+  void set(const std::string &key, const std::string &value, std::chrono::seconds) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[key] = value;
+  }
+  void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                    std::chrono::seconds ttl) override {
+    for (std::size_t i = 0; i < keys.size(); ++i) set(keys[i], values[i], ttl);
+  }
+  void setMany(const std::vector<CacheEntry> &entries) override {
+    for (const auto &entry : entries) set(entry.key, entry.value, entry.ttl);
+  }
+  void removeMany(const std::vector<std::string> &keys) override {
+    for (const auto &key : keys) remove(key);
+  }
+  bool setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_.try_emplace(key, value).second;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::string> values_;
+};
+
+class SlowCountingExecutor : public ISqlExecutor {
+ public:
+  explicit SlowCountingExecutor(ISqlExecutor &executor) : executor_(executor) {}
+
+  SqlExecutorResult execute(const QString &sql, const QList<QVariant> &values) override {
+    ++executions;
+    std::this_thread::sleep_for(kQueryCost);
+    return executor_.execute(sql, values);
+  }
+
+  std::atomic<long long> executions{0};
+
+ private:
+  ISqlExecutor &executor_;
+};
+
+SqlExecutor &stampedeExecutor() {
+  static SQLiteDatabase db("bench_stampede.db", SQLiteProfile::readHeavy());
+  static bool ready = db.initializeSchema();
+  (void)ready;
+  static SqlExecutor executor(db);
+  return executor;
+}
+
+SlowCountingExecutor &slowExecutor() {
+  static SlowCountingExecutor executor(stampedeExecutor());
+  return executor;
+}
+
+SharedCache shared_cache;
+std::atomic<long long> bumps{0};
+
+}  // namespace
+
+static void QueryStampede(benchmark::State &state) {
+  auto &policy = QueryCachePolicy::instance();
+  auto &slow_executor = slowExecutor();
+  if (state.thread_index() == 0) {
+    policy.setSingleFlight(state.range(0) >= 1);
+    policy.setStaleWhileRevalidate(state.range(0) == 2 ? std::chrono::seconds{5} : std::chrono::milliseconds{0});
+    shared_cache.clearCache();
+    slow_executor.executions = 0;
+    bumps = 0;
+  }
+
+  long long reads = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0 && ++reads % kBumpEvery == 0) {
+      bumpTableGeneration(shared_cache, MessageTable::Table);
+      ++bumps;
+    }
+    auto query = QueryFactory::createSelect<Message>(&slow_executor, shared_cache);
+    query->join(MessageStatusTable::Table, MessageTable::Id,
+                MessageStatusTable::fullField(MessageStatusTable::MessageId))
+        .where(MessageTable::ChatId, 1)
+        .limit(20)
+        .where(MessageStatusTable::fullField(MessageStatusTable::ReceiverId), 1);
+    query->orderBy(MessageTable::Id, OrderDirection::DESC);
+    auto result = query->execute();
+    benchmark::DoNotOptimize(result);
+  }
+
+  if (state.thread_index() == 0) {
+    // the first read of the run is a miss as well
+    const auto misses = static_cast<double>(bumps.load() + 1);
+    state.counters["db_reads"] = static_cast<double>(slow_executor.executions.load());
+    state.counters["db_per_miss"] = static_cast<double>(slow_executor.executions.load()) / misses;
+    policy.setSingleFlight(true);
+    policy.setStaleWhileRevalidate(std::chrono::milliseconds{0});
+  }
+}
+
+BENCHMARK(QueryStampede)->Arg(0)->Arg(1)->Arg(2)->Threads(64)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,205 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ChannelPool.h"
+#include "benchmark/benchmark.h"
+
+// RabbitMQClient::publish against a stand-in broker on loopback, so no RabbitMQ is
+// needed. The stand-in speaks fixed-size frames instead of AMQP but keeps the round
+// trips of a SimpleAmqpClient channel:
+// - open: TCP connect, then 4 round trips (protocol header/Start, StartOk/Tune,
+//   TuneOk+Open/OpenOk, Channel.Open/OpenOk)
+// - publish: one write (Basic.Publish + header + body frames), no reply
+// - close: 2 round trips (Channel.Close, Connection.Close)
+// range(0) is the publish path:
+// 0 - a channel per message, what publish() did before ChannelPool
+// 1 - ChannelPool with 4 long-lived channels (RabbitMQConfig::publisher_channels)
+// 4 publisher threads share the client, like the MessageService pool workers.
+
+namespace {
+
+constexpr int kMessages = 2'000;
+constexpr int kPublishers = 4;
+constexpr int kOpenRoundTrips = 4;
+constexpr int kCloseRoundTrips = 2;
+constexpr std::size_t kFrameSize = 64;
+constexpr char kPublish = 'P';
+constexpr char kControl = 'C';
+
+using Frame = std::array<char, kFrameSize>;
+
+bool readFrame(int fd, Frame &frame) {
+  std::size_t done = 0;
+  while (done < frame.size()) {
+    const ssize_t got = ::read(fd, frame.data() + done, frame.size() - done);
+    if (got <= 0) return false;
+    done += static_cast<std::size_t>(got);
+  }
+  return true;
+}
+
+void writeFrame(int fd, char kind) {
+  Frame frame{};
+  frame[0] = kind;
+  if (::write(fd, frame.data(), frame.size()) != static_cast<ssize_t>(frame.size())) {
+    throw std::runtime_error("stand-in broker write failed");
+  }
+}
+
+// answers every control frame and swallows publishes; one thread per connection
+class StandInBroker {
+ public:
+  StandInBroker() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), length) != 0 || ::listen(listen_fd_, 512) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+      throw std::runtime_error("stand-in broker cannot listen");
+    }
+    port_ = ntohs(address.sin_port);
+    acceptor_ = std::thread([this] { acceptLoop(); });
+  }
+
+  ~StandInBroker() {
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    acceptor_.join();
+  }
+
+  StandInBroker(const StandInBroker &) = delete;
+  StandInBroker &operator=(const StandInBroker &) = delete;
+
+  [[nodiscard]] int port() const { return port_; }
+
+ private:
+  void acceptLoop() const {
+    while (true) {
+      const int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) return;
+      std::thread([fd] {
+        const int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Frame frame;
+        while (readFrame(fd, frame)) {
+          if (frame[0] != kPublish) writeFrame(fd, kControl);
+        }
+        ::close(fd);
+      }).detach();
+    }
+  }
+
+  int listen_fd_{-1};
+  int port_{0};
+  std::thread acceptor_;
+};
+
+// what AmqpClient::Channel costs on the wire
+class StandInChannel {
+ public:
+  using ptr_t = std::shared_ptr<StandInChannel>;
+
+  explicit StandInChannel(int port) {
+    fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::connect(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+      ::close(fd_);
+      throw std::runtime_error("stand-in broker refused the connection");
+    }
+    const int one = 1;
+    ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    roundTrips(kOpenRoundTrips);
+  }
+
+  ~StandInChannel() {
+    try {
+      roundTrips(kCloseRoundTrips);
+    } catch (const std::exception &) {
+    }
+    // reset instead of TIME_WAIT, or a connection per message runs out of ephemeral ports
+    const linger reset{1, 0};
+    ::setsockopt(fd_, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    ::close(fd_);
+  }
+
+  StandInChannel(const StandInChannel &) = delete;
+  StandInChannel &operator=(const StandInChannel &) = delete;
+
+  void BasicPublish() const { writeFrame(fd_, kPublish); }
+
+ private:
+  void roundTrips(int count) const {
+    Frame reply;
+    for (int i = 0; i < count; ++i) {
+      writeFrame(fd_, kControl);
+      if (!readFrame(fd_, reply)) throw std::runtime_error("stand-in broker closed the connection");
+    }
+  }
+
+  int fd_{-1};
+};
+
+template <typename Publish>
+void runPublishers(const Publish &publish) {
+  std::vector<std::thread> publishers;
+  publishers.reserve(kPublishers);
+  for (int p = 0; p < kPublishers; ++p) {
+    publishers.emplace_back([&publish] {
+      for (int i = 0; i < kMessages / kPublishers; ++i) publish();
+    });
+  }
+  for (auto &publisher : publishers) publisher.join();
+}
+
+}  // namespace
+
+static void BM_RabbitPublish(benchmark::State &state) {
+  const bool pooled = state.range(0) == 1;
+  StandInBroker broker;
+  const int port = broker.port();
+  ChannelPool<StandInChannel>::Options options;
+  options.size = 4;
+  ChannelPool<StandInChannel> pool([port] { return std::make_shared<StandInChannel>(port); }, options);
+  std::atomic<int> failed{0};
+
+  for (auto _ : state) {
+    if (pooled) {
+      runPublishers([&pool] {
+        auto channel = pool.acquire();
+        channel->BasicPublish();
+      });
+    } else {
+      runPublishers([port, &failed] {
+        try {
+          StandInChannel(port).BasicPublish();
+        } catch (const std::exception &) {
+          ++failed;
+        }
+      });
+    }
+  }
+
+  const double messages = static_cast<double>(state.iterations() * kMessages);
+  state.counters["connects"] = pooled ? static_cast<double>(pool.stats().opened) : messages;
+  state.counters["failed"] = failed.load();
+  state.SetItemsProcessed(state.iterations() * kMessages);
+}
+
+BENCHMARK(BM_RabbitPublish)->ArgName("pooled")->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -1,6 +1,12 @@
 #include <benchmark/benchmark.h>
 
+#include <cmath>
+#include <random>
+#include <thread>
+
 #include "MessageService/include/entities/Message.h"
+#include "LocalCache.h"
+#include "NearCache.h"
 #include "RedisCache.h"
 
 static void BM_SaveEntityIndividually(benchmark::State &state) {
@@ -35,3 +41,147 @@ static void BM_SaveEntityIndividually(benchmark::State &state) {
 
 BENCHMARK(BM_SaveEntityIndividually)->Arg(10)->Arg(100)->Arg(1000);
 // BENCHMARK(BM_SaveEntityPipeline)->Arg(10)->Arg(100)->Arg(1000);
+
+// Hot-key reads (generation counters, reaction info rows) against Redis alone and
+// through the NearCache L1. range(0) is the number of distinct hot keys.
+
+namespace {
+
+std::vector<std::string> seedHotKeys(ICacheService &cache, int64_t count) {
+  std::vector<std::string> keys;
+  for (int64_t i = 0; i < count; ++i) {
+    keys.push_back("bench_near:" + std::to_string(i));
+    cache.set(keys.back(), std::string(256, 'r'), std::chrono::seconds{600});
+  }
+  return keys;
+}
+
+void reportNearCache(benchmark::State &state, const NearCache &cache) {
+  const auto stats = cache.stats();
+  const auto lookups = stats.hits + stats.misses;
+  state.counters["hit_ratio"] = lookups == 0 ? 0.0 : static_cast<double>(stats.hits) / static_cast<double>(lookups);
+  state.counters["l1_bytes"] = static_cast<double>(stats.bytes);
+  state.counters["evictions"] = static_cast<double>(stats.evictions);
+}
+
+}  // namespace
+
+static void BM_RedisGetHotKeys(benchmark::State &state) {
+  RedisCache &cache = RedisCache::instance();
+  const auto keys = seedHotKeys(cache, state.range(0));
+  std::size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get(keys[i++ % keys.size()]));
+  }
+}
+
+static void BM_NearCacheGetHotKeys(benchmark::State &state) {
+  NearCache cache(RedisCache::instance());
+  const auto keys = seedHotKeys(cache, state.range(0));
+  std::size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get(keys[i++ % keys.size()]));
+  }
+  reportNearCache(state, cache);
+}
+
+// 10k keys read with a Zipf-like skew (s = 1) through an L1 of range(0) KiB:
+// shows how much of the traffic a small budget absorbs
+static void BM_NearCacheSkewedGets(benchmark::State &state) {
+  constexpr int kKeys = 10'000;
+  const auto budget = static_cast<std::size_t>(state.range(0)) * 1024;
+  NearCache cache(RedisCache::instance(), NearCacheConfig{.max_bytes = budget});
+  const auto keys = seedHotKeys(RedisCache::instance(), kKeys);
+
+  std::vector<double> weights(kKeys);
+  for (int i = 0; i < kKeys; ++i) weights[i] = 1.0 / (i + 1);
+  std::discrete_distribution<int> pick(weights.begin(), weights.end());
+  std::mt19937 rng(42);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get(keys[pick(rng)]));
+  }
+  reportNearCache(state, cache);
+}
+
+BENCHMARK(BM_RedisGetHotKeys)->Arg(1)->Arg(100);
+BENCHMARK(BM_NearCacheGetHotKeys)->Arg(1)->Arg(100);
+BENCHMARK(BM_NearCacheSkewedGets)->Arg(64)->Arg(512)->Arg(4096);
+
+// 32-64 concurrent callers sharing one client. range(0) is the connection pool
+// size: with 1 connection the callers queue behind each other's round trips.
+static void BM_RedisConcurrentGets(benchmark::State &state) {
+  static RedisCache single(RedisConfig{.pool_size = 1, .pool_wait_timeout = std::chrono::milliseconds(0)});
+  static RedisCache pooled(RedisConfig{.pool_size = 32, .pool_wait_timeout = std::chrono::milliseconds(0)});
+  RedisCache &cache = state.range(0) == 1 ? single : pooled;
+  if (state.thread_index() == 0) cache.set("bench_concurrent", std::string(256, 'c'), std::chrono::seconds{600});
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get("bench_concurrent"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// A query cache fill followed by ~200 us of SQLite-like work: setAsync lets the
+// SET round trip run while the caller carries on.
+static void busyWork(std::chrono::microseconds duration) {
+  const auto until = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+static void BM_RedisFillThenWork(benchmark::State &state) {
+  RedisCache &cache = RedisCache::instance();
+  const std::string entry(2048, 'q');
+  for (auto _ : state) {
+    cache.set("bench_fill", entry, std::chrono::seconds{600});
+    busyWork(std::chrono::microseconds(200));
+  }
+}
+
+static void BM_RedisFillAsyncWithWork(benchmark::State &state) {
+  RedisCache &cache = RedisCache::instance();
+  const std::string entry(2048, 'q');
+  for (auto _ : state) {
+    auto done = cache.setAsync("bench_fill", entry, std::chrono::seconds{600});
+    busyWork(std::chrono::microseconds(200));
+    done.wait();
+  }
+}
+
+BENCHMARK(BM_RedisConcurrentGets)->Arg(1)->Arg(32)->Threads(1)->Threads(8)->Threads(32)->Threads(64)->UseRealTime();
+BENCHMARK(BM_RedisFillThenWork)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RedisFillAsyncWithWork)->Unit(benchmark::kMicrosecond);
+
+// The hot-key reads and the concurrent callers against the in-process LocalCache
+// (CACHE_BACKEND=local): no round trip, the cost is one shard lock and the copy.
+// For the concurrent case range(0) is the shard count, 1 serializes every caller.
+static void BM_LocalCacheGetHotKeys(benchmark::State &state) {
+  LocalCache cache;
+  const auto keys = seedHotKeys(cache, state.range(0));
+  std::size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get(keys[i++ % keys.size()]));
+  }
+}
+
+static void BM_LocalCacheConcurrentGets(benchmark::State &state) {
+  static LocalCache single(LocalCacheConfig{.shards = 1});
+  static LocalCache sharded(LocalCacheConfig{.shards = 16});
+  static const auto single_keys = seedHotKeys(single, 1024);
+  static const auto sharded_keys = seedHotKeys(sharded, 1024);
+  LocalCache &cache = state.range(0) == 1 ? single : sharded;
+  const auto &keys = state.range(0) == 1 ? single_keys : sharded_keys;
+  std::size_t i = static_cast<std::size_t>(state.thread_index()) * 97;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get(keys[i++ % keys.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LocalCacheGetHotKeys)->Arg(1)->Arg(100);
+BENCHMARK(BM_LocalCacheConcurrentGets)->Arg(1)->Arg(16)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
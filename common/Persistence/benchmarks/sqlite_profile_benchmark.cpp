@@ -0,0 +1,87 @@
+#include <QtSql/QSqlQuery>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "SQLiteDataBase.h"
+#include "benchmark/benchmark.h"
+
+// One writer inserting single-row transactions while range(1) readers run point
+// lookups on their own connections, for each SQLiteProfile (range(0)).
+
+namespace {
+
+constexpr int kWritesPerIteration = 200;
+
+SQLiteProfile profileByIndex(int64_t index) {
+  switch (index) {
+    case 1:
+      return SQLiteProfile::writeHeavy();
+    case 2:
+      return SQLiteProfile::readHeavy();
+    default:
+      return SQLiteProfile::legacy();
+  }
+}
+
+QString dbNameFor(int64_t index) { return QString("bench_profile_%1.db").arg(index); }
+
+}  // namespace
+
+static void ConcurrentReadWrite(benchmark::State &state) {
+  SQLiteDatabase db(dbNameFor(state.range(0)), profileByIndex(state.range(0)));
+  db.exec("CREATE TABLE IF NOT EXISTS profile_bench (id INTEGER PRIMARY KEY, payload TEXT)");
+  db.exec("DELETE FROM profile_bench");
+  for (int i = 1; i <= 1000; ++i) {
+    db.exec(QString("INSERT INTO profile_bench (id, payload) VALUES (%1, 'seed')").arg(i));
+  }
+
+  const int readers = static_cast<int>(state.range(1));
+  std::atomic<long long> reads{0};
+  std::atomic<long long> busy_errors{0};
+  long long writes = 0;
+  int next_id = 1001;
+
+  for (auto _ : state) {
+    std::atomic<bool> writing{true};
+    std::vector<std::thread> threads;
+    threads.reserve(readers);
+    for (int r = 0; r < readers; ++r) {
+      threads.emplace_back([&, r] {
+        int id = r + 1;
+        while (writing.load(std::memory_order_relaxed)) {
+          auto query = db.prepare("SELECT payload FROM profile_bench WHERE id = ?");
+          query->bind(id);
+          if (!query->exec()) ++busy_errors;
+          benchmark::DoNotOptimize(query->next());
+          id = id % 1000 + 1;
+          ++reads;
+        }
+      });
+    }
+
+    for (int i = 0; i < kWritesPerIteration; ++i) {
+      auto query = db.prepare("INSERT OR REPLACE INTO profile_bench (id, payload) VALUES (?, ?)");
+      query->bind(next_id++);
+      query->bind(QString("payload"));
+      if (query->exec()) {
+        ++writes;
+      } else {
+        ++busy_errors;
+      }
+    }
+
+    writing = false;
+    for (auto &thread : threads) thread.join();
+  }
+
+  state.counters["writes_per_sec"] = benchmark::Counter(static_cast<double>(writes), benchmark::Counter::kIsRate);
+  state.counters["reads_per_sec"] = benchmark::Counter(static_cast<double>(reads.load()), benchmark::Counter::kIsRate);
+  state.counters["busy_errors"] = static_cast<double>(busy_errors.load());
+}
+
+// range(0): 0 = legacy (rollback journal), 1 = writeHeavy, 2 = readHeavy; range(1): reader threads
+BENCHMARK(ConcurrentReadWrite)
+    ->ArgsProduct({{0, 1, 2}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
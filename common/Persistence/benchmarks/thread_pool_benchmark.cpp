@@ -1,86 +1,220 @@
-// #include <algorithm>
-// #include <atomic>
-// #include <mutex>
-// #include <vector>
-
-// #include "Persistence/GenericRepository.h"
-// #include "benchmark/benchmark.h"
-
-// static void BM_FindWithCachePercHit(benchmark::State& state) {
-//   int totalOps = state.range(0);
-//   int percHit = state.range(1);
-//   std::atomic<int> id{0};
-
-//   for (auto _ : state) {
-//     SQLiteDatabase db;
-//     GenericRepository rep(db);
-//     rep.clearCache();
-
-//     for (int i = 1; i <= totalOps; i++) {
-//       if ((i * 100 / totalOps) <= percHit) {
-//         rep.findOne<Message>(i);
-//       }
-//     }
-
-//     id.store(0);
-
-//     for (int i = 0; i < totalOps; ++i) {
-//       int currentId = id.fetch_add(1);
-//       std::optional<Message> result = rep.findOne<Message>(currentId);
-//       ;
-//       benchmark::DoNotOptimize(result);
-//     }
-//   }
-// }
-
-// static void BM_FindWithCachePercHitAsync(benchmark::State& state) {
-//   int totalOps = state.range(0);
-//   int percHit = state.range(1);
-
-//   for (auto _ : state) {
-//     std::vector<int> ids(totalOps);
-//     for (int i = 0; i < totalOps; ++i) {
-//       ids[i] = i;
-//     }
-
-//     {
-//       SQLiteDatabase db;
-//       GenericRepository rep(db);
-//       rep.clearCache();
-//       for (int i = 0; i < totalOps; ++i) {
-//         if ((i * 100 / totalOps) < percHit) {
-//           rep.findOne<Message>(ids[i]);
-//         }
-//       }
-//     }
-
-//     ThreadPool pool{4};
-
-//     for (int i = 0; i < totalOps; ++i) {
-//       pool.enqueue([id = ids[i]] {
-//         SQLiteDatabase db;
-//         GenericRepository rep(db);
-//         auto result = rep.findOne<Message>(id);
-//         benchmark::DoNotOptimize(result);
-//       });
-//     }
-
-//     pool.waitAll();
-//   }
-// }
-
-// BENCHMARK(BM_FindWithCachePercHit)
-//     ->Args({100, 100})
-//     ->Args({100, 80})
-//     ->Args({100, 60})
-//     ->Args({100, 40})
-//     ->Args({100, 20})
-//     ->Args({100, 0});
-
-// BENCHMARK(BM_FindWithCachePercHitAsync)
-//     ->Args({100, 100})
-//     ->Args({100, 80})
-//     ->Args({100, 60})
-//     ->Args({100, 40})
-//     ->Args({100, 20})
-//     ->Args({100, 0});
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingThreadPool.h"
+#include "benchmark/benchmark.h"
+#include "threadpool.h"
+
+// ThreadPool (one queue, one mutex) vs WorkStealingThreadPool (per-worker deques,
+// sharded injection) from 1 worker up to the number of cores. range(0) is the
+// worker count. Tasks are short (~1 us of arithmetic), so the numbers are mostly
+// queueing overhead:
+// - FanIn: 4 producer threads enqueue kTasks tasks, like the RabbitMQ consumer
+//   callbacks and saveAsync calls hitting the MessageService pool
+// - Nested: every task enqueues two children until kTasks tasks have run, which
+//   is the case the worker-local LIFO deque is for
+//
+// BM_TaskAllocations counts heap allocations per task (operator new is replaced
+// below for the whole binary; the counter is a relaxed atomic add):
+// 0 - legacy enqueue: shared packaged_task + future + std::function, what
+//     IThreadPool::enqueue did before post()/submit()
+// 1 - post(): fire-and-forget Task, capture stored inline
+// 2 - submit(): Task owning a promise whose shared state comes from PooledAllocator
+//
+// BM_PriorityLanes: a backlog of kMixedTasks tasks, 90% background writes and 10%
+// interactive reads, is queued while the 4 workers are held, then released.
+// range(0) is how the reads are posted:
+// 0 - TaskPriority::Background, so they wait in one FIFO behind the writes
+// 1 - TaskPriority::Interactive, their own lane
+// Counters are the p99 time from the release until a task starts, per class.
+
+namespace {
+
+std::atomic<long long> heap_allocations{0};
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr int kTasks = 20'000;
+constexpr int kProducers = 4;
+
+void spin() {
+  unsigned value = 0;
+  for (int i = 0; i < 200; ++i) benchmark::DoNotOptimize(value += i);
+}
+
+template <typename Pool>
+void spawn(Pool &pool, std::atomic<int> &budget) {
+  spin();
+  for (int child = 0; child < 2; ++child) {
+    if (budget.fetch_sub(1) <= 0) return;
+    pool.enqueue([&pool, &budget] { spawn(pool, budget); });
+  }
+}
+
+void workerCounts(benchmark::internal::Benchmark *bench) {
+  const int cores = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+  for (int workers = 1; workers < cores; workers *= 2) bench->Arg(workers);
+  bench->Arg(cores);
+}
+
+}  // namespace
+
+template <typename Pool>
+static void BM_ThreadPoolFanIn(benchmark::State &state) {
+  Pool pool(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    std::vector<std::thread> producers;
+    producers.reserve(kProducers);
+    for (int p = 0; p < kProducers; ++p) {
+      producers.emplace_back([&pool] {
+        for (int i = 0; i < kTasks / kProducers; ++i) pool.enqueue([] { spin(); });
+      });
+    }
+    for (auto &producer : producers) producer.join();
+    pool.waitAll();
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+template <typename Pool>
+static void BM_ThreadPoolNested(benchmark::State &state) {
+  Pool pool(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    std::atomic<int> budget{kTasks - 1};
+    pool.enqueue([&pool, &budget] { spawn(pool, budget); });
+    pool.waitAll();
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+BENCHMARK_TEMPLATE(BM_ThreadPoolFanIn, ThreadPool)->Apply(workerCounts)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ThreadPoolFanIn, WorkStealingThreadPool)
+    ->Apply(workerCounts)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ThreadPoolNested, ThreadPool)->Apply(workerCounts)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ThreadPoolNested, WorkStealingThreadPool)
+    ->Apply(workerCounts)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_TaskAllocations(benchmark::State &state) {
+  const int mode = static_cast<int>(state.range(0));
+  constexpr int kBatch = 1'000;
+  WorkStealingThreadPool pool(1);
+  // same shape as the RabbitMQ dispatch capture: a handler pointer and two short strings
+  std::string event = "message.save";
+  std::string payload = "{\"id\":1}";
+  std::atomic<long long> sink{0};
+  auto work = [&sink, event, payload] { sink.fetch_add(static_cast<long long>(event.size() + payload.size())); };
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(kBatch);
+  long long allocations = 0;
+  for (auto _ : state) {
+    const long long before = heap_allocations.load(std::memory_order_relaxed);
+    for (int i = 0; i < kBatch; ++i) {
+      if (mode == 0) {
+        auto task = std::make_shared<std::packaged_task<void()>>(work);
+        futures.push_back(task->get_future());
+        pool.post(std::function<void()>([task]() { (*task)(); }));
+      } else if (mode == 1) {
+        pool.post(work);
+      } else {
+        futures.push_back(pool.submit(work));
+      }
+    }
+    pool.waitAll();
+    futures.clear();
+    allocations += heap_allocations.load(std::memory_order_relaxed) - before;
+  }
+
+  state.counters["allocs_per_task"] =
+      static_cast<double>(allocations) / static_cast<double>(state.iterations() * kBatch);
+  state.SetItemsProcessed(state.iterations() * kBatch);
+}
+
+BENCHMARK(BM_TaskAllocations)->ArgName("mode")->Arg(0)->Arg(1)->Arg(2)->UseRealTime();
+
+namespace {
+
+constexpr int kMixedTasks = 5'000;
+
+double percentile(std::vector<double> &values, double p) {
+  if (values.empty()) return 0.0;
+  std::sort(values.begin(), values.end());
+  return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+}
+
+}  // namespace
+
+template <typename Pool>
+static void BM_PriorityLanes(benchmark::State &state) {
+  using Clock = std::chrono::steady_clock;
+  constexpr int kWorkers = 4;
+  const bool lanes = state.range(0) == 1;
+  Pool pool(kWorkers);
+  std::vector<double> waited_us(kMixedTasks);
+  std::vector<double> interactive_us;
+  std::vector<double> background_us;
+
+  for (auto _ : state) {
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::atomic<int> held{0};
+    for (int w = 0; w < kWorkers; ++w) {
+      pool.post([opened, &held] {
+        ++held;
+        opened.wait();
+      });
+    }
+    while (held.load() < kWorkers) std::this_thread::yield();
+
+    Clock::time_point released;
+    for (int i = 0; i < kMixedTasks; ++i) {
+      const bool interactive = i % 10 == 0;
+      const TaskPriority priority = interactive && lanes ? TaskPriority::Interactive : TaskPriority::Background;
+      pool.post(
+          [&waited_us, &released, i] {
+            waited_us[i] = std::chrono::duration<double, std::micro>(Clock::now() - released).count();
+            spin();
+          },
+          priority);
+    }
+    released = Clock::now();
+    gate.set_value();
+    pool.waitAll();
+    for (int i = 0; i < kMixedTasks; ++i) (i % 10 == 0 ? interactive_us : background_us).push_back(waited_us[i]);
+  }
+
+  state.counters["interactive_p99_us"] = percentile(interactive_us, 0.99);
+  state.counters["background_p99_us"] = percentile(background_us, 0.99);
+  state.SetItemsProcessed(state.iterations() * kMixedTasks);
+}
+
+BENCHMARK_TEMPLATE(BM_PriorityLanes, ThreadPool)->ArgName("lanes")->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PriorityLanes, WorkStealingThreadPool)->ArgName("lanes")->Arg(0)->Arg(1)->UseRealTime();
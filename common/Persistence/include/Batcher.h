@@ -0,0 +1,81 @@
+#ifndef BATCHER_H
+#define BATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+struct BatcherConfig {
+  std::size_t max_batch_rows = 256;
+  std::chrono::milliseconds max_delay{5};
+  // saveEntity blocks once this many rows wait for a flush
+  std::size_t max_pending_rows = 8192;
+  std::chrono::milliseconds enqueue_timeout{200};
+};
+
+struct BatcherStats {
+  std::size_t flushed_batches = 0;
+  std::size_t flushed_rows = 0;
+  std::size_t failed_batches = 0;
+  std::size_t rejected_rows = 0;
+};
+
+// Group-commit stage: rows are collected for up to max_delay or max_batch_rows
+// and handed to flush_function in one call from a dedicated writer thread.
+// on_flushed runs on the same thread right after, with the flush result.
+template <typename T>
+class SaverBatcher {
+ public:
+  using FlushFunction = std::function<bool(std::span<const T>)>;
+  using FlushedCallback = std::function<void(std::span<const T>, bool)>;
+
+  SaverBatcher(FlushFunction flush_function, FlushedCallback on_flushed = {}, BatcherConfig config = {});
+  ~SaverBatcher();
+  SaverBatcher(const SaverBatcher &) = delete;
+  SaverBatcher(SaverBatcher &&) = delete;
+  SaverBatcher &operator=(const SaverBatcher &) = delete;
+  SaverBatcher &operator=(SaverBatcher &&) = delete;
+
+  // false when the queue stayed full for enqueue_timeout; the entity is not queued
+  bool saveEntity(T entity);
+
+  // blocks until every entity queued before the call has been flushed
+  void flush();
+
+  [[nodiscard]] std::size_t pending() const;
+  [[nodiscard]] BatcherStats stats() const;
+  [[nodiscard]] const BatcherConfig &config() const { return config_; }
+
+ private:
+  struct PendingRow {
+    T entity;
+    std::chrono::steady_clock::time_point enqueued_at;  // max_delay counts from here
+  };
+
+  void run();
+
+  FlushFunction flush_function_;
+  FlushedCallback on_flushed_;
+  BatcherConfig config_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_condition_;
+  std::condition_variable space_condition_;
+  std::deque<PendingRow> pending_;
+  std::size_t enqueued_rows_{0};
+  std::size_t done_rows_{0};
+  std::size_t flush_target_{0};
+  BatcherStats stats_;
+  bool stop_{false};
+  std::thread writer_;
+};
+
+#include "Batcher.inl"
+
+#endif  // BATCHER_H
@@ -0,0 +1,64 @@
+#ifndef CACHECODEC_H
+#define CACHECODEC_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class CacheFormat : std::uint8_t {
+  Json = 1,     // reflection::toJson text
+  MsgPack = 2,  // the same document as MessagePack
+  Fields = 3,   // columns in EntityFields<T> order, no names; varints for integers
+};
+
+// Format of cached values of T; specialize to move one entity type to another codec.
+template <typename T>
+struct CacheCodecFor {
+  static constexpr CacheFormat format = CacheFormat::Fields;
+};
+
+// Versioned encoding of cached entities and query cache entries. Every value
+// starts with a 6-byte header: a magic byte, the format and a fingerprint of T's
+// columns (names and member types). A value whose header differs from what this
+// build writes - a pre-codec JSON entry, another format, a changed schema -
+// decodes to nullopt and is treated as a miss.
+namespace cache_codec {
+
+constexpr std::size_t kHeaderSize = 6;
+
+// fingerprint of EntityFields<T>, part of every header
+template <typename T>
+std::uint32_t schemaVersion();
+
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::string encode(const T &entity);
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::string encode(const std::vector<T> &entities);
+
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::optional<T> decode(std::string_view data);
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::optional<std::vector<T>> decodeList(std::string_view data);
+
+// query cache entry: the generation stamp and write time come first, so a stale
+// entry is recognised without decoding its rows
+struct QueryEntryView {
+  std::string_view generation;
+  long long stored_at{0};  // ms since epoch
+  std::string_view rows;   // decodeRows input, valid as long as the encoded entry
+};
+
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::string encodeQueryEntry(std::string_view generation, long long stored_at, const std::vector<T> &rows);
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::optional<QueryEntryView> readQueryEntry(std::string_view data);
+template <typename T, CacheFormat F = CacheCodecFor<T>::format>
+std::optional<std::vector<T>> decodeRows(std::string_view rows);
+
+}  // namespace cache_codec
+
+#include "CacheCodec.inl"
+
+#endif  // CACHECODEC_H
@@ -2,7 +2,7 @@
 #define CACHEKEYGENERATOR_H
 
 #include <string>
-#include "Meta.h"
+#include "StaticReflection.h"
 #include "metaentity/EntityConcept.h"
 
 class CacheKeyGenerator {
@@ -10,12 +10,12 @@ class CacheKeyGenerator {
   template <EntityJson T>
   static std::string makeKey(const T& entity) {
     EntityKey<T> key_builder;
-    return makeKeyImplementation(key_builder.get(entity), std::string(Reflection<T>::meta().table_name));
+    return makeKeyImplementation(key_builder.get(entity), std::string(reflection::tableName<T>()));
   }
 
   template <EntityJson T>
   static std::string makeKey(long long id) {
-    return makeKeyImplementation(std::to_string(id), std::string(Reflection<T>::meta().table_name));
+    return makeKeyImplementation(std::to_string(id), std::string(reflection::tableName<T>()));
   }
 
  private:
@@ -0,0 +1,41 @@
+#ifndef CONNECTIONPOOLMETRICS_H
+#define CONNECTIONPOOLMETRICS_H
+
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/histogram.h>
+#include <prometheus/registry.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SQLiteConnectionPool.h"
+
+// Publishes SQLiteConnectionPool events to a Prometheus registry, labelled by database.
+class ConnectionPoolMetrics : public IConnectionPoolObserver {
+ public:
+  ConnectionPoolMetrics(std::shared_ptr<prometheus::Registry> registry, const std::string &db_name,
+                        std::size_t pool_size);
+
+  void connectionAcquired(ConnectionRole role, std::chrono::nanoseconds waited, std::size_t in_use) override;
+  void connectionReleased(ConnectionRole role, std::size_t in_use) override;
+  void acquireTimedOut(ConnectionRole role) override;
+
+ private:
+  std::shared_ptr<prometheus::Registry> registry_;
+  prometheus::Histogram *writer_wait_;
+  prometheus::Histogram *reader_wait_;
+  prometheus::Counter *writer_timeouts_;
+  prometheus::Counter *reader_timeouts_;
+  prometheus::Gauge *in_use_;
+  prometheus::Gauge *max_in_use_;
+  prometheus::Gauge *size_;
+  std::atomic<std::size_t> max_in_use_value_{0};
+
+  const std::vector<double> wait_buckets_ = {0.00001, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5};
+};
+
+#endif  // CONNECTIONPOOLMETRICS_H
@@ -0,0 +1,35 @@
+#ifndef ENTITYCACHE_H
+#define ENTITYCACHE_H
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+#include "Meta.h"
+#include "interfaces/ICacheService.h"
+#include "interfaces/ISqlExecutor.h"
+#include "metaentity/EntityConcept.h"
+
+// Lookups by primary key through the entity cache (entity_cache:<table>:<id>).
+// All ids are read with one getMany; only the ids the cache did not have go to
+// the database, in one WHERE id IN (...) per kMaxBindParameters ids. Entries are
+// plain copies without a generation, so only the write paths (save, saveAll,
+// deleteById, deleteByIds) set or remove them: a read path writing back the row
+// it loaded could overwrite a newer save or resurrect a deleted row. Ids the
+// database did not have are written back as tombstones (NegativeCache.h), which
+// carry the table generation and cannot outlive a write.
+namespace entity_cache {
+
+// ttl of the entries GenericRepository::save and saveAll write
+inline constexpr std::chrono::seconds kTtl{30};
+
+// rows in the order of their first id; ids without a row are left out
+template <EntityJson T>
+  requires kEntityKeyIsId<T>
+std::vector<T> findByIds(ISqlExecutor *executor, ICacheService &cache, std::span<const long long> ids);
+
+}  // namespace entity_cache
+
+#include "EntityCache.inl"
+
+#endif  // ENTITYCACHE_H
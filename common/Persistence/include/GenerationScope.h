@@ -0,0 +1,47 @@
+#ifndef GENERATIONSCOPE_H
+#define GENERATIONSCOPE_H
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GenerationSnapshot.h"
+#include "Meta.h"
+#include "interfaces/ICacheService.h"
+#include "metaentity/metaentities.h"
+
+// Query cache generations below table granularity. A table whose entity declares
+// EntityPartition<T> keeps, next to table_generation:<table>, one generation per
+// partition value (<table>:<column>=<value>) and an epoch (<table>:*) for writes
+// whose partition is unknown. A query filtering `column = value` on that table is
+// stamped with the epoch and its partition's generation, so a new message in one
+// chat leaves the cached pages of every other chat valid. Any other query is
+// stamped with the table generation, which every write still bumps.
+namespace generation_scope {
+
+// writes touching more partitions than this bump the epoch once instead
+inline constexpr std::size_t kMaxPartitionBumps = 64;
+
+std::string partition(const std::string &table, std::string_view column, const std::string &value);
+std::string anyPartition(const std::string &table);
+
+// nullptr when no entity declares a partition column for the table
+const char *partitionColumn(std::string_view table);
+
+// generations a query on `table` is stamped with; `value` is its partition filter, if any
+std::vector<std::string> queryScopes(const std::string &table, const std::optional<std::string> &value);
+
+// write paths: rows unknown, one known partition, or the rows themselves
+void bumpTable(ICacheService &cache, const std::string &table);
+void bumpPartition(ICacheService &cache, const std::string &table, const std::string &value);
+
+template <EntityJson T>
+void bumpRows(ICacheService &cache, std::span<const T> rows);
+
+}  // namespace generation_scope
+
+#include "GenerationScope.inl"
+
+#endif  // GENERATIONSCOPE_H
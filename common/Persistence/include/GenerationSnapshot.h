@@ -0,0 +1,67 @@
+#ifndef GENERATIONSNAPSHOT_H
+#define GENERATIONSNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "interfaces/ICacheService.h"
+
+// Process-local copy of table_generation values, trusted for ttl() after they
+// were read from the cache. Off by default (ttl 0): with a snapshot, writes made
+// by other processes become visible to SelectQuery only once the entry expires.
+// Writes made through this process invalidate the table immediately. At most
+// kMaxEntries scopes are kept; once full, expired entries are purged and new
+// scopes are not stored until there is room again.
+class GenerationSnapshot {
+ public:
+  static constexpr std::size_t kMaxEntries = 4096;
+
+  static GenerationSnapshot &instance();
+
+  static std::string cacheKey(const std::string &table) { return "table_generation:" + table; }
+
+  void setTtl(std::chrono::milliseconds ttl);
+  [[nodiscard]] std::chrono::milliseconds ttl() const { return std::chrono::milliseconds(ttl_ms_.load()); }
+
+  [[nodiscard]] std::optional<std::string> find(const std::string &table) const;
+  void store(const std::string &table, const std::string &generation);
+  void invalidate(const std::string &table);
+  void clear();
+
+ private:
+  struct Entry {
+    std::string generation;
+    std::chrono::steady_clock::time_point fetched_at;
+  };
+
+  GenerationSnapshot() = default;
+
+  // caller holds the unique lock
+  void purgeExpired(std::chrono::steady_clock::time_point now, std::chrono::milliseconds ttl);
+
+  std::atomic<long long> ttl_ms_{0};
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+// every write path goes through here so the local snapshot never outlives a local write
+inline void bumpTableGeneration(ICacheService &cache, const std::string &table) {
+  cache.incr(GenerationSnapshot::cacheKey(table));
+  GenerationSnapshot::instance().invalidate(table);
+}
+
+// one round trip for every scope a write touches
+inline void bumpTableGenerations(ICacheService &cache, const std::vector<std::string> &tables) {
+  std::vector<std::string> keys;
+  keys.reserve(tables.size());
+  for (const auto &table : tables) keys.push_back(GenerationSnapshot::cacheKey(table));
+  cache.incrMany(keys);
+  for (const auto &table : tables) GenerationSnapshot::instance().invalidate(table);
+}
+
+#endif  // GENERATIONSNAPSHOT_H
@@ -1,6 +1,7 @@
 #ifndef BACKEND_GENERICREPOSITORY_GENERICREPOSITORY_H_
 #define BACKEND_GENERICREPOSITORY_GENERICREPOSITORY_H_
 
+#include <span>
 #include <vector>
 
 #include "CacheKeyGenerator.h"
@@ -40,15 +41,34 @@ class GenericRepository {
   template <EntityJson T>
   bool save(const T &entity);
 
+  // one transaction, one cache pipeline and one generation bump for the whole batch
+  template <EntityJson T>
+  bool saveAll(std::span<const T> entities);
+
+  template <EntityJson T>
+  bool saveAll(const std::vector<T> &entities) {
+    return saveAll(std::span<const T>(entities));
+  }
+
   template <EntityJson T>
   void saveAsync(T &entity);
 
+  // by id through the entity cache when kEntityKeyIsId<T>, otherwise a query
   template <EntityJson T>
   std::optional<T> findOne(long long entity_id);
 
+  // one cache round trip for all ids, one query for the ids it misses; see EntityCache.h
+  template <EntityJson T>
+    requires kEntityKeyIsId<T>
+  std::vector<T> findMany(std::span<const long long> entity_ids);
+
   template <EntityJson T>
   bool deleteById(long long entity_id);
 
+  // one transaction, one cache DEL and one generation bump for the whole batch
+  template <EntityJson T>
+  bool deleteByIds(std::span<const long long> entity_ids);
+
   template <EntityJson T>
   bool deleteEntity(const T &entity);  // todo : update outbox
 
@@ -4,6 +4,7 @@
 #include <QtSql/QSqlQuery>
 #include <any>
 #include <functional>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -46,29 +47,61 @@ Field make_field(const char *name, M T::*member) {
                    }};
 }
 
+// Compile-time column descriptor: the SQL/JSON name plus a typed member pointer.
+template <typename T, typename M>
+struct Column {
+  using Entity = T;
+  using Member = M;
+
+  const char *name;
+  M T::*member;
+};
+
+template <typename T, typename M>
+constexpr Column<T, M> column(const char *name, M T::*member) {
+  return Column<T, M>{name, member};
+}
+
+template <typename M>
+inline constexpr bool kIsOptional = false;
+
+template <typename M>
+inline constexpr bool kIsOptional<std::optional<M>> = true;
+
+template <typename M>
+void assignFromVariant(M &field, const QVariant &value) {
+  if constexpr (kIsOptional<M>) {
+    if (value.isNull()) {
+      field = std::nullopt;
+    } else {
+      typename M::value_type inner{};
+      assignFromVariant(inner, value);
+      field = std::move(inner);
+    }
+  } else if constexpr (std::is_same_v<M, long long>) {
+    field = value.toLongLong();
+  } else if constexpr (std::is_same_v<M, bool>) {
+    field = value.toInt() != 0;
+  } else if constexpr (std::is_same_v<M, int>) {
+    field = value.toInt();
+  } else if constexpr (std::is_same_v<M, std::string>) {
+    field = value.toString().toStdString();
+  } else if constexpr (std::is_same_v<M, QString>) {
+    field = value.toString();
+  } else {
+    field = value.value<M>();
+  }
+}
+
 template <typename T, typename FieldTuple>
 struct FastBuilder {
   static T build(QSqlQuery &query, const FieldTuple &fields) {
     T entity;
     int i = 0;
 
-    auto assign = [&](auto ptr) {
-      using MemberType = std::decay_t<decltype(entity.*ptr)>;
-      QVariant value = query.value(i++);
-      if constexpr (std::is_same_v<MemberType, long long>) {
-        entity.*ptr = value.toLongLong();
-      } else if constexpr (std::is_same_v<MemberType, int>) {
-        entity.*ptr = value.toInt();
-      } else if constexpr (std::is_same_v<MemberType, std::string>) {
-        entity.*ptr = value.toString().toStdString();
-      } else if constexpr (std::is_same_v<MemberType, QString>) {
-        entity.*ptr = value.toString();
-      } else {
-        entity.*ptr = value.value<MemberType>();
-      }
-    };
-
-    std::apply([&](auto... ptrs) { (assign(ptrs), ...); }, fields);
+    auto assign = [&](const auto &column) { assignFromVariant(entity.*(column.member), query.value(i++)); };
+
+    std::apply([&](const auto &...columns) { (assign(columns), ...); }, fields);
 
     return entity;
   }
@@ -84,6 +117,7 @@ struct Builder {
   T build(QSqlQuery &query);
 };
 
+// Specialized per entity: `table` and `fields`, a tuple of Column in table column order.
 template <typename T>
 struct EntityFields;
 
@@ -92,4 +126,20 @@ struct EntityKey {
   static std::string get(const T &entity) { return std::to_string(entity.id); }
 };
 
+// entity_cache:<table>:<key> answers lookups by id only when the key is the row id.
+// An entity with an id column but its own EntityKey must set this to false.
+template <typename T>
+inline constexpr bool kEntityKeyIsId = requires(const T &entity) { entity.id; };
+
+// Column that splits the table's query cache generation into one generation per value
+// (see GenerationScope.h). Specialized with `column` and `get`; the column must never
+// change for a stored row, otherwise the row's old partition is not invalidated.
+template <typename T>
+struct EntityPartition {
+  static constexpr const char *column = nullptr;
+};
+
+template <typename T>
+inline constexpr bool kEntityHasPartition = requires(const T &entity) { EntityPartition<T>::get(entity); };
+
 #endif  // BACKEND_GENERICREPOSITORY_META_H_
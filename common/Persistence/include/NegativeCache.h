@@ -0,0 +1,32 @@
+#ifndef NEGATIVECACHE_H
+#define NEGATIVECACHE_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct NegativeCacheStats {
+  long long query_hits = 0;   // fresh query cache entries without rows
+  long long entity_hits = 0;  // ids answered "not found" by an entity_cache tombstone
+};
+
+// Not-found results kept for QueryCachePolicy::negativeTtl(), so lookups of
+// missing rows (an email before registration, a deleted message) stop reaching
+// SQLite on every retry. An empty query cache entry is stamped with the query's
+// generations like any entry. An id the database did not have is stored in
+// entity_cache as a tombstone holding the table generation read before the
+// SELECT; any write to the table bumps it, so an insert racing the lookup can
+// leave an outdated tombstone behind but never a trusted one.
+namespace negative_cache {
+
+std::string tombstone(const std::string &generation);
+// the generation of a tombstone, nullopt for any other value
+std::optional<std::string_view> tombstoneGeneration(std::string_view value);
+
+void countQueryHit();
+void countEntityHit();
+NegativeCacheStats stats();
+
+}  // namespace negative_cache
+
+#endif  // NEGATIVECACHE_H
@@ -0,0 +1,39 @@
+#ifndef PREPAREDSTATEMENTCACHE_H
+#define PREPAREDSTATEMENTCACHE_H
+
+#include <QHash>
+#include <QSqlQuery>
+#include <QString>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <utility>
+
+// LRU of compiled statements for a single connection. Not thread-safe: a
+// pooled connection is only used by the thread holding its lease.
+class PreparedStatementCache {
+ public:
+  explicit PreparedStatementCache(std::size_t capacity);
+
+  // cache key only: the statement itself is prepared from the sql as given
+  static QString normalize(const QString &sql);
+
+  // returns nullptr on a miss or when the cached statement is still in use
+  std::shared_ptr<QSqlQuery> find(const QString &normalized_sql);
+  void insert(const QString &normalized_sql, std::shared_ptr<QSqlQuery> query);
+  void clear();
+
+  [[nodiscard]] std::size_t size() const { return entries_.size(); }
+  [[nodiscard]] std::size_t capacity() const { return capacity_; }
+  [[nodiscard]] std::size_t evictions() const { return evictions_; }
+
+ private:
+  using Entry = std::pair<QString, std::shared_ptr<QSqlQuery>>;
+
+  std::size_t capacity_;
+  std::size_t evictions_{0};
+  std::list<Entry> entries_;
+  QHash<QString, std::list<Entry>::iterator> index_;
+};
+
+#endif  // PREPAREDSTATEMENTCACHE_H
@@ -0,0 +1,45 @@
+#ifndef QUERYCACHEPOLICY_H
+#define QUERYCACHEPOLICY_H
+
+#include <atomic>
+#include <chrono>
+
+// How SelectQuery refills a missed or stale query cache entry.
+//  - single flight (on): concurrent misses of one key in this process share one
+//    database read.
+//  - lock ttl (0 = off): the loader first takes a short "query_lock:" key with
+//    SET NX, so only one instance reads; the others poll the entry for up to the
+//    lock ttl and then load by themselves.
+//  - stale while revalidate (0 = off): an entry made stale by a generation bump
+//    and younger than this is served while another caller already refreshes it.
+//    Needs single flight. Readers may then miss a write for one refresh.
+//  - negative ttl (5 s, 0 = off): how long empty results and entity_cache
+//    tombstones of missing ids are kept (see NegativeCache.h).
+class QueryCachePolicy {
+ public:
+  static QueryCachePolicy &instance();
+
+  void setSingleFlight(bool enabled) { single_flight_ = enabled; }
+  [[nodiscard]] bool singleFlight() const { return single_flight_.load(); }
+
+  void setLockTtl(std::chrono::milliseconds ttl) { lock_ttl_ms_ = ttl.count(); }
+  [[nodiscard]] std::chrono::milliseconds lockTtl() const { return std::chrono::milliseconds(lock_ttl_ms_.load()); }
+
+  void setStaleWhileRevalidate(std::chrono::milliseconds max_age) { stale_ms_ = max_age.count(); }
+  [[nodiscard]] std::chrono::milliseconds staleWhileRevalidate() const {
+    return std::chrono::milliseconds(stale_ms_.load());
+  }
+
+  void setNegativeTtl(std::chrono::seconds ttl) { negative_ttl_s_ = ttl.count(); }
+  [[nodiscard]] std::chrono::seconds negativeTtl() const { return std::chrono::seconds(negative_ttl_s_.load()); }
+
+ private:
+  QueryCachePolicy() = default;
+
+  std::atomic<bool> single_flight_{true};
+  std::atomic<long long> lock_ttl_ms_{0};
+  std::atomic<long long> stale_ms_{0};
+  std::atomic<long long> negative_ttl_s_{5};
+};
+
+#endif  // QUERYCACHEPOLICY_H
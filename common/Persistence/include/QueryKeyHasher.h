@@ -0,0 +1,68 @@
+#ifndef QUERYKEYHASHER_H
+#define QUERYKEYHASHER_H
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct Hash128 {
+  std::uint64_t low{0};
+  std::uint64_t high{0};
+
+  // 32 lowercase hex digits
+  [[nodiscard]] std::string toHex() const;
+  bool operator==(const Hash128 &) const = default;
+};
+
+// Streaming MurmurHash3 x64/128: input is fed in pieces and never concatenated.
+class StreamingHash128 {
+ public:
+  explicit StreamingHash128(std::uint64_t seed = 0) : h1_(seed), h2_(seed) {}
+
+  void update(const void *data, std::size_t size);
+  [[nodiscard]] Hash128 finish() const;
+
+ private:
+  void block(const unsigned char *data);
+
+  std::uint64_t h1_;
+  std::uint64_t h2_;
+  std::array<unsigned char, 16> tail_{};
+  std::size_t tail_size_{0};
+  std::size_t total_{0};
+};
+
+// Typed, length-prefixed encoding of query parts, so ("ab", "c") and ("a", "bc"),
+// 1 and "1", or swapped parameters never feed the same bytes. Integral values
+// are widened to 64 bits: int 3 and long long 3 select the same rows.
+class QueryKeyHasher {
+ public:
+  QueryKeyHasher &add(const QString &text);
+  QueryKeyHasher &add(std::string_view text);
+  QueryKeyHasher &add(std::int64_t number);
+  QueryKeyHasher &add(const QVariant &value);
+
+  [[nodiscard]] Hash128 finish() const { return hash_.finish(); }
+
+ private:
+  enum class Tag : std::uint8_t { Null, Integer, Unsigned, Real, Text, Utf8, Bytes };
+
+  void tag(Tag tag, std::uint64_t length = 0);
+
+  StreamingHash128 hash_;
+};
+
+// "query_cache:<32 hex>" from the SQL text and its bound values
+std::string makeQueryCacheKey(const QString &sql, const QVector<QVariant> &params);
+
+// stamp stored inside a query cache entry; order of tables is significant
+std::string hashGenerations(const std::vector<std::pair<std::string, std::string>> &generations);
+
+#endif  // QUERYKEYHASHER_H
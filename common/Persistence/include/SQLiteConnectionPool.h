@@ -0,0 +1,129 @@
+#ifndef SQLITECONNECTIONPOOL_H
+#define SQLITECONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "PreparedStatementCache.h"
+#include "SQLiteProfile.h"
+
+enum class ConnectionRole { Writer, Reader };
+
+struct PooledConnection {
+  PooledConnection(QSqlDatabase p_db, ConnectionRole p_role, std::size_t statement_cache_capacity)
+      : db(std::move(p_db)), statements(statement_cache_capacity), role(p_role) {}
+
+  QSqlDatabase db;
+  PreparedStatementCache statements;
+  ConnectionRole role;
+};
+
+struct ConnectionPoolStats {
+  std::uint64_t acquisitions{0};
+  std::uint64_t timeouts{0};
+  std::chrono::nanoseconds total_wait{0};
+  std::chrono::nanoseconds max_wait{0};
+  std::size_t in_use{0};
+  std::size_t max_in_use{0};
+  std::size_t size{0};
+};
+
+class IConnectionPoolObserver {
+ public:
+  virtual ~IConnectionPoolObserver() = default;
+  virtual void connectionAcquired(ConnectionRole role, std::chrono::nanoseconds waited, std::size_t in_use) = 0;
+  virtual void connectionReleased(ConnectionRole role, std::size_t in_use) = 0;
+  virtual void acquireTimedOut(ConnectionRole role) = 0;
+};
+
+class SQLiteConnectionPool;
+
+// Exclusive use of one pooled connection; returned to the pool on destruction.
+class ConnectionLease {
+ public:
+  ConnectionLease() = default;
+  ConnectionLease(SQLiteConnectionPool *pool, PooledConnection *connection) : pool_(pool), connection_(connection) {}
+  ~ConnectionLease();
+
+  ConnectionLease(const ConnectionLease &) = delete;
+  ConnectionLease &operator=(const ConnectionLease &) = delete;
+  ConnectionLease(ConnectionLease &&other) noexcept;
+  ConnectionLease &operator=(ConnectionLease &&other) noexcept;
+
+  explicit operator bool() const { return connection_ != nullptr; }
+
+  [[nodiscard]] QSqlDatabase &db() const { return connection_->db; }
+  [[nodiscard]] PreparedStatementCache &statements() const { return connection_->statements; }
+  [[nodiscard]] ConnectionRole role() const { return connection_->role; }
+
+ private:
+  void release();
+
+  SQLiteConnectionPool *pool_{nullptr};
+  PooledConnection *connection_{nullptr};
+};
+
+// One writer slot (SQLite allows a single writer anyway) plus reader slots
+// opened read-only. A slot is used by one thread at a time, under a lease.
+// Qt only allows a connection to be used from the thread that created it, so a
+// lease hands out the acquiring thread's own connection for that role, opened
+// on its first acquire and closed when the thread exits or the pool goes away.
+class SQLiteConnectionPool {
+ public:
+  struct Options {
+    std::size_t readers = 4;
+    std::chrono::milliseconds acquire_timeout{5000};
+    std::size_t statement_cache_capacity = 64;
+  };
+
+  SQLiteConnectionPool(const QString &db_name, const SQLiteProfile &profile, Options options);
+  ~SQLiteConnectionPool();
+  SQLiteConnectionPool(const SQLiteConnectionPool &) = delete;
+  SQLiteConnectionPool &operator=(const SQLiteConnectionPool &) = delete;
+
+  // empty lease when nothing frees up within acquire_timeout
+  ConnectionLease acquireWriter();
+  // served by the writer when the pool has no readers (e.g. ":memory:")
+  ConnectionLease acquireReader();
+
+  // the calling thread's writer connection for schema setup and tests, bypassing the lease
+  [[nodiscard]] QSqlDatabase writerDatabase();
+
+  [[nodiscard]] ConnectionPoolStats stats() const;
+  void setObserver(IConnectionPoolObserver *observer);
+
+ private:
+  friend class ConnectionLease;
+
+  ConnectionLease acquire(ConnectionRole role);
+  void release(PooledConnection *connection);
+  // the calling thread's connection for `role`, opened on first use
+  PooledConnection &threadConnection(ConnectionRole role);
+  QSqlDatabase open(ConnectionRole role);
+
+  const std::uint64_t id_;
+  // expires with the pool, so threads can close connections of pools that are gone
+  std::shared_ptr<const bool> alive_;
+  QString db_name_;
+  // what each connection opens: db_name_, or a shared in-memory database for ":memory:"
+  QString database_name_;
+  bool in_memory_;
+  SQLiteProfile profile_;
+  Options options_;
+  std::size_t readers_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable writer_released_;
+  std::condition_variable reader_released_;
+  bool writer_free_{true};
+  std::size_t free_readers_;
+  ConnectionPoolStats stats_;
+  IConnectionPoolObserver *observer_{nullptr};
+};
+
+#endif  // SQLITECONNECTIONPOOL_H
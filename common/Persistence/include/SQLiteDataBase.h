@@ -3,15 +3,39 @@
 
 #include <QSqlDatabase>
 #include <QThread>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
 #include "Debug_profiling.h"
+#include "SQLiteConnectionPool.h"
+#include "SQLiteProfile.h"
 #include "interfaces/IDataBase.h"
 #include "query/SQLiteQuery.h"
 
+struct StatementCacheStats {
+  std::uint64_t hits{0};
+  std::uint64_t misses{0};
+};
+
 class SQLiteDatabase : public IDataBase {
  public:
-  explicit SQLiteDatabase(QString db_name) : db_name_(std::move(db_name)) {}
+  static constexpr std::size_t kDefaultStatementCacheCapacity = 64;
+  static constexpr std::size_t kDefaultReaders = 4;
+
+  // statement_cache_capacity is per connection; 0 disables statement reuse
+  explicit SQLiteDatabase(QString db_name, std::size_t statement_cache_capacity = kDefaultStatementCacheCapacity)
+      : SQLiteDatabase(std::move(db_name), SQLiteProfile::balanced(), statement_cache_capacity) {}
 
+  // profile is applied to each connection when it is opened
+  SQLiteDatabase(QString db_name, SQLiteProfile profile,
+                 std::size_t statement_cache_capacity = kDefaultStatementCacheCapacity,
+                 std::size_t readers = kDefaultReaders);
+  ~SQLiteDatabase() override;
+  SQLiteDatabase(const SQLiteDatabase &) = delete;
+  SQLiteDatabase &operator=(const SQLiteDatabase &) = delete;
+
+  // writer connection without a lease: schema setup and tests only
   [[nodiscard]] QSqlDatabase db() const;
 
   [[nodiscard]] bool exec(const QString &sql) override;
@@ -31,11 +55,35 @@ class SQLiteDatabase : public IDataBase {
   bool tableExists(const QString &table_name);
   bool deleteTable(const QString &name);
 
+  [[nodiscard]] StatementCacheStats statementCacheStats() const;
+  [[nodiscard]] ConnectionPoolStats poolStats() const { return pool_->stats(); }
+  void setPoolObserver(IConnectionPoolObserver *observer) { pool_->setObserver(observer); }
+  [[nodiscard]] const SQLiteProfile &profile() const { return profile_; }
+
  protected:
   bool executeSql(const QSqlDatabase &db, const QString &sql);
 
  private:
+  // SELECT goes to a reader, everything else to the writer; BEGIN pins the
+  // writer to the calling thread until COMMIT/ROLLBACK. A thread that still
+  // holds a reader (e.g. an open cursor) reuses it for further reads.
+  std::shared_ptr<ConnectionLease> leaseFor(const QString &sql);
+  // per thread and per instance (by id_); entries go away on COMMIT/ROLLBACK and
+  // with the instance
+  [[nodiscard]] std::shared_ptr<ConnectionLease> pinnedLease() const;
+  void pin(std::shared_ptr<ConnectionLease> lease) const;
+  void unpin() const;
+  [[nodiscard]] std::shared_ptr<ConnectionLease> activeReader() const;
+  void setActiveReader(const std::shared_ptr<ConnectionLease> &lease) const;
+
+  // never reused, unlike the address, so a new instance cannot inherit a dead one's leases
+  const std::uint64_t id_;
   QString db_name_;
+  SQLiteProfile profile_;
+  std::size_t statement_cache_capacity_;
+  std::unique_ptr<SQLiteConnectionPool> pool_;
+  mutable std::atomic<std::uint64_t> statement_cache_hits_{0};
+  mutable std::atomic<std::uint64_t> statement_cache_misses_{0};
 };
 
 #endif  // SQLITEDATABASE_H
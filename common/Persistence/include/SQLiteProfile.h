@@ -0,0 +1,59 @@
+#ifndef SQLITEPROFILE_H
+#define SQLITEPROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+// Pragmas applied to every connection right after it is opened.
+// journal_mode=WAL lets readers run alongside the single writer instead of
+// serializing on the rollback journal.
+struct SQLiteProfile {
+  QString journal_mode = "WAL";
+  QString synchronous = "NORMAL";
+  long long mmap_size = 64LL * 1024 * 1024;
+  int cache_size = -16000;  // negative is KiB, positive is pages
+  QString temp_store = "MEMORY";
+  int busy_timeout_ms = 5000;
+  int wal_autocheckpoint = 1000;  // pages
+
+  // tuned defaults, good enough for mixed workloads
+  static SQLiteProfile balanced() { return {}; }
+
+  // MessageService: many small write transactions, checkpoint less often
+  static SQLiteProfile writeHeavy() {
+    SQLiteProfile profile;
+    profile.cache_size = -32000;
+    profile.busy_timeout_ms = 10000;
+    profile.wal_autocheckpoint = 4000;
+    return profile;
+  }
+
+  // AuthService: mostly point lookups, keep the hot set mapped and cached
+  static SQLiteProfile readHeavy() {
+    SQLiteProfile profile;
+    profile.mmap_size = 256LL * 1024 * 1024;
+    profile.cache_size = -64000;
+    return profile;
+  }
+
+  // SQLite's own defaults, used as the benchmark baseline
+  static SQLiteProfile legacy() {
+    SQLiteProfile profile;
+    profile.journal_mode = "DELETE";
+    profile.synchronous = "FULL";
+    profile.mmap_size = 0;
+    profile.cache_size = -2000;
+    profile.temp_store = "DEFAULT";
+    profile.busy_timeout_ms = 0;
+    return profile;
+  }
+
+  // read-only connections skip the pragmas that write to the database file
+  [[nodiscard]] QStringList pragmas(bool read_only = false) const;
+
+  // returns false if any pragma is rejected by the connection
+  bool apply(const QSqlDatabase &db, bool read_only = false) const;
+};
+
+#endif  // SQLITEPROFILE_H
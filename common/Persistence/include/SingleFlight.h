@@ -0,0 +1,36 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct SingleFlightStats {
+  std::size_t loads = 0;   // callers that ran the loader
+  std::size_t joined = 0;  // callers that waited for someone else's load
+};
+
+// Coalesces concurrent loads of the same key within the process: the first
+// caller runs the loader, every caller arriving while it runs waits for that
+// result (or exception) instead of loading again. The key is forgotten as soon
+// as the load finishes, so nothing is cached here.
+template <typename V>
+class SingleFlight {
+ public:
+  template <typename Load>
+  V run(const std::string &key, Load &&load);
+
+  [[nodiscard]] bool inFlight(const std::string &key) const;
+  [[nodiscard]] SingleFlightStats stats() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_future<V>> flights_;
+  SingleFlightStats stats_;
+};
+
+#include "SingleFlight.inl"
+
+#endif  // SINGLEFLIGHT_H
@@ -3,8 +3,11 @@
 
 #include <QList>
 #include <QString>
+#include <algorithm>
+#include <span>
+#include <vector>
 
-#include "Meta.h"
+#include "StaticReflection.h"
 #include "metaentity/EntityConcept.h"
 
 struct SqlStatement {
@@ -14,17 +17,32 @@ struct SqlStatement {
 
 class SqlBuilder {
  public:
+  // SQLITE_MAX_VARIABLE_NUMBER default for builds older than 3.32
+  static constexpr std::size_t kMaxBindParameters = 999;
+
+  template <EntityJson T>
+  SqlStatement buildInsert(const T &entity) const;
+
+  // multi-row INSERT OR REPLACE, split so no statement exceeds kMaxBindParameters
+  template <EntityJson T>
+  std::vector<SqlStatement> buildInsertBatch(std::span<const T> entities) const;
+
+  template <EntityJson T>
+  static const QString &insertSql();
+
   template <EntityJson T>
-  SqlStatement buildInsert(const Meta &meta, const T &entity);
+  static QString insertSql(std::size_t rows);
 
   template <EntityJson T>
-  static std::any getFieldValue(const QVariant &v, const Field &f);
+  static constexpr std::size_t batchSize() {
+    return std::max<std::size_t>(1, kMaxBindParameters / reflection::columnCount<T>());
+  }
 
   template <EntityJson T>
   std::vector<T> buildResults(std::unique_ptr<IQuery> &query) const;
 
   template <EntityJson T>
-  T buildEntity(std::unique_ptr<IQuery> &query, const Meta &meta) const;
+  T buildEntity(std::unique_ptr<IQuery> &query) const;
 };
 
 #include "SqlBuilder.inl"
@@ -0,0 +1,136 @@
+#ifndef STATICREFLECTION_H
+#define STATICREFLECTION_H
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <array>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <tuple>
+#include <type_traits>
+
+#include "Meta.h"
+#include "interfaces/IQuery.h"
+
+// Typed counterpart of Reflection<T>::meta(): everything is driven by the
+// EntityFields<T>::fields tuple, so there is no std::any / std::function and
+// the per-column dispatch is resolved at compile time.
+namespace reflection {
+
+template <typename T>
+constexpr const char *tableName() {
+  return EntityFields<T>::table;
+}
+
+template <typename T>
+constexpr std::size_t columnCount() {
+  return std::tuple_size_v<std::remove_cvref_t<decltype(EntityFields<T>::fields)>>;
+}
+
+template <typename T, typename F>
+constexpr void forEachColumn(F &&func) {
+  std::apply([&func](const auto &...columns) { (func(columns), ...); }, EntityFields<T>::fields);
+}
+
+template <typename M>
+QVariant toVariant(const M &value) {
+  if constexpr (kIsOptional<M>) {
+    return value.has_value() ? toVariant(*value) : QVariant();
+  } else if constexpr (std::is_same_v<M, bool>) {
+    return static_cast<int>(value);
+  } else if constexpr (std::is_same_v<M, std::string>) {
+    return QString::fromStdString(value);
+  } else {
+    return QVariant::fromValue(value);
+  }
+}
+
+template <typename T>
+QList<QVariant> bindValues(const T &entity) {
+  QList<QVariant> values;
+  values.reserve(static_cast<qsizetype>(columnCount<T>()));
+  forEachColumn<T>([&](const auto &column) { values.append(toVariant(entity.*(column.member))); });
+  return values;
+}
+
+template <typename T>
+using ColumnIndices = std::array<int, columnCount<T>()>;
+
+// Result position of every EntityFields<T> column, looked up by name once per
+// statement: `SELECT *` returns the table's column order, not the EntityFields<T>
+// one. Joined tables come after the selected table's own columns, so a name the
+// two share resolves to the selected table. A missing column reads as null.
+template <typename T>
+ColumnIndices<T> columnIndices(const IQuery &query) {
+  ColumnIndices<T> indices{};
+  std::size_t position = 0;
+  forEachColumn<T>([&](const auto &column) { indices[position++] = query.indexOf(column.name); });
+  return indices;
+}
+
+template <typename T>
+T build(const IQuery &query, const ColumnIndices<T> &indices) {
+  T entity;
+  std::size_t position = 0;
+  forEachColumn<T>([&](const auto &column) {
+    const int index = indices[position++];
+    assignFromVariant(entity.*(column.member), index >= 0 ? query.value(index) : QVariant());
+  });
+  return entity;
+}
+
+// a single row; use columnIndices() once and the overload above for a result set
+template <typename T>
+T build(const IQuery &query) {
+  return build<T>(query, columnIndices<T>(query));
+}
+
+template <typename T>
+nlohmann::json toJson(const T &entity) {
+  nlohmann::json json = nlohmann::json::object();
+  forEachColumn<T>([&](const auto &column) {
+    const auto &value = entity.*(column.member);
+    if constexpr (kIsOptional<std::remove_cvref_t<decltype(value)>>) {
+      if (value.has_value()) json[column.name] = *value;
+    } else {
+      json[column.name] = value;
+    }
+  });
+  return json;
+}
+
+template <typename T>
+T fromJson(const nlohmann::json &json) {
+  T entity;
+  forEachColumn<T>([&](const auto &column) {
+    auto &value = entity.*(column.member);
+    using Member = std::remove_cvref_t<decltype(value)>;
+    if constexpr (kIsOptional<Member>) {
+      auto it = json.find(column.name);
+      value = it == json.end() || it->is_null() ? std::nullopt : Member(it->template get<typename Member::value_type>());
+    } else {
+      json.at(column.name).get_to(value);
+    }
+  });
+  return entity;
+}
+
+template <typename T>
+nlohmann::json toJson(const std::vector<T> &entities) {
+  nlohmann::json json = nlohmann::json::array();
+  for (const auto &entity : entities) json.push_back(toJson(entity));
+  return json;
+}
+
+template <typename T>
+std::vector<T> listFromJson(const nlohmann::json &json) {
+  std::vector<T> entities;
+  entities.reserve(json.size());
+  for (const auto &element : json) entities.push_back(fromJson<T>(element));
+  return entities;
+}
+
+}  // namespace reflection
+
+#endif  // STATICREFLECTION_H
@@ -2,10 +2,15 @@
 #define IBASEQUERY_H
 
 #include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "Debug_profiling.h"
+#include "GenerationScope.h"
 #include "Meta.h"
+#include "StaticReflection.h"
 #include "interfaces/ICacheService.h"
 #include "interfaces/ISqlExecutor.h"
 #include "metaentity/EntityConcept.h"
@@ -25,6 +30,8 @@ class IBaseQuery {
   QString limit_clause_;
   QString join_clause_;
   QString table_name_;
+  // `field = value` filters, read back to scope cache generations to one partition
+  std::vector<std::pair<std::string, QVariant>> equal_filters_;
 
   inline static ThreadPool pool{4};
 
@@ -44,6 +51,11 @@ class IBaseQuery {
  protected:
   [[nodiscard]] virtual QString buildQuery() const = 0;
 
+  // value of the equality filter on the table's partition column; a bare column name counts for the FROM table
+  [[nodiscard]] std::optional<std::string> partitionFilter(const std::string &table) const;
+  // generation_scope::queryScopes of every involved table, without repeats
+  [[nodiscard]] std::vector<std::string> generationScopes() const;
+
   virtual ~IBaseQuery() = default;
 };
 
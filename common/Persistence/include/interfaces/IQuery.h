@@ -11,6 +11,8 @@ struct IQuery {
   virtual QString error() = 0;
   virtual QVariant value(int i) const = 0;
   virtual QVariant value(const std::string &field) const = 0;
+  // position of `field` in the current result, -1 when it has no such column
+  virtual int indexOf(const std::string &field) const = 0;
 };
 
 #endif  // IQUERY_H
@@ -47,10 +47,14 @@ struct Builder<ChatMember> {
 };
 
 inline constexpr auto ChatMemberFields =
-    std::make_tuple(&ChatMember::chat_id, &ChatMember::user_id, &ChatMember::status, &ChatMember::added_at);
+    std::make_tuple(column(ChatMemberTable::ChatId, &ChatMember::chat_id),
+                    column(ChatMemberTable::UserId, &ChatMember::user_id),
+                    column(ChatMemberTable::Status, &ChatMember::status),
+                    column(ChatMemberTable::AddedAt, &ChatMember::added_at));
 
 template <>
 struct EntityFields<ChatMember> {
+  static constexpr const char *table = ChatMemberTable::Table;
   static constexpr auto &fields = ChatMemberFields;
 };
 
@@ -49,10 +49,13 @@ struct Builder<Chat> {
 };
 
 inline constexpr auto ChatFields =
-    std::make_tuple(&Chat::id, &Chat::is_group, &Chat::name, &Chat::avatar, &Chat::created_at);
+    std::make_tuple(column(ChatTable::Id, &Chat::id), column(ChatTable::IsGroup, &Chat::is_group),
+                    column(ChatTable::Name, &Chat::name), column(ChatTable::Avatar, &Chat::avatar),
+                    column(ChatTable::CreatedAt, &Chat::created_at));
 
 template <>
 struct EntityFields<Chat> {
+  static constexpr const char *table = ChatTable::Table;
   static constexpr auto &fields = ChatFields;
 };
 
@@ -60,12 +60,22 @@ struct Builder<Message> {
 };
 
 inline constexpr auto MessageFields =
-    std::make_tuple(&Message::id, &Message::chat_id, &Message::sender_id, &Message::text, &Message::timestamp,
-                    &Message::local_id, &Message::answer_on);
+    std::make_tuple(column(MessageTable::Id, &Message::id), column(MessageTable::ChatId, &Message::chat_id),
+                    column(MessageTable::SenderId, &Message::sender_id), column(MessageTable::Text, &Message::text),
+                    column(MessageTable::Timestamp, &Message::timestamp),
+                    column(MessageTable::LocalId, &Message::local_id),
+                    column(MessageTable::AnswerOn, &Message::answer_on));
 
 template <>
 struct EntityFields<Message> {
+  static constexpr const char *table = MessageTable::Table;
   static constexpr auto &fields = MessageFields;
 };
 
+template <>
+struct EntityPartition<Message> {
+  static constexpr const char *column = MessageTable::ChatId;
+  static long long get(const Message &entity) { return entity.chat_id; }
+};
+
 #endif  // MESSAGEMETA_H
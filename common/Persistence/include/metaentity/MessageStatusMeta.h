@@ -52,12 +52,22 @@ struct EntityKey<MessageStatus> {
   static std::string get(const MessageStatus &entity) { return std::to_string(entity.message_id); }
 };
 
-inline constexpr auto kMessageStatusFields = std::make_tuple(&MessageStatus::message_id, &MessageStatus::receiver_id,
-                                                             &MessageStatus::is_read, &MessageStatus::read_at);
+inline constexpr auto kMessageStatusFields =
+    std::make_tuple(column(MessageStatusTable::MessageId, &MessageStatus::message_id),
+                    column(MessageStatusTable::ReceiverId, &MessageStatus::receiver_id),
+                    column(MessageStatusTable::IsRead, &MessageStatus::is_read),
+                    column(MessageStatusTable::ReatAt, &MessageStatus::read_at));
 
 template <>
 struct EntityFields<MessageStatus> {
+  static constexpr const char *table = MessageStatusTable::Table;
   static constexpr auto &fields = kMessageStatusFields;
 };
 
+template <>
+struct EntityPartition<MessageStatus> {
+  static constexpr const char *column = MessageStatusTable::ReceiverId;
+  static long long get(const MessageStatus &entity) { return entity.receiver_id; }
+};
+
 #endif  // METAENTITY_MESSAGES_STATUS_H
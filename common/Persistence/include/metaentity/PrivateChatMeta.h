@@ -53,10 +53,13 @@ struct Builder<PrivateChat> {
 };
 
 inline constexpr auto PrivateChatFields =
-    std::make_tuple(&PrivateChat::chat_id, &PrivateChat::first_user, &PrivateChat::second_user);
+    std::make_tuple(column(PrivateChatTable::ChatId, &PrivateChat::chat_id),
+                    column(PrivateChatTable::FirstUserId, &PrivateChat::first_user),
+                    column(PrivateChatTable::SecondUserId, &PrivateChat::second_user));
 
 template <>
 struct EntityFields<PrivateChat> {
+  static constexpr const char *table = PrivateChatTable::Table;
   static constexpr auto &fields = PrivateChatFields;
 };
 
@@ -42,10 +42,13 @@ struct Builder<ReactionInfo> {
   }
 };
 
-inline constexpr auto ReactionInfoFields = std::make_tuple(&ReactionInfo::id, &ReactionInfo::image);
+inline constexpr auto ReactionInfoFields =
+    std::make_tuple(column(MessageReactionInfoTable::Id, &ReactionInfo::id),
+                    column(MessageReactionInfoTable::Image, &ReactionInfo::image));
 
 template <>
 struct EntityFields<ReactionInfo> {
+  static constexpr const char *table = MessageReactionInfoTable::Table;
   static constexpr auto &fields = ReactionInfoFields;
 };
 
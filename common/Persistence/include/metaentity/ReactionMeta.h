@@ -42,10 +42,13 @@ struct Builder<Reaction> {
 };
 
 inline constexpr auto ReactionFields =
-    std::make_tuple(&Reaction::message_id, &Reaction::receiver_id, &Reaction::reaction_id);
+    std::make_tuple(column(MessageReactionTable::MessageId, &Reaction::message_id),
+                    column(MessageReactionTable::ReceiverId, &Reaction::receiver_id),
+                    column(MessageReactionTable::ReactionId, &Reaction::reaction_id));
 
 template <>
 struct EntityFields<Reaction> {
+  static constexpr const char *table = MessageReactionTable::Table;
   static constexpr auto &fields = ReactionFields;
 };
 
@@ -56,4 +59,10 @@ struct EntityKey<Reaction> {
   }
 };
 
+template <>
+struct EntityPartition<Reaction> {
+  static constexpr const char *column = MessageReactionTable::MessageId;
+  static long long get(const Reaction &entity) { return entity.message_id; }
+};
+
 #endif  // REACTIONMETA_H
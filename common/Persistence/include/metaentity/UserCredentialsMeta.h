@@ -50,10 +50,12 @@ struct EntityKey<UserCredentials> {
 };
 
 inline constexpr auto UserCredentialsFields =
-    std::make_tuple(&UserCredentials::user_id, &UserCredentials::hash_password);
+    std::make_tuple(column(UserCredentialsTable::UserId, &UserCredentials::user_id),
+                    column(UserCredentialsTable::HashPassword, &UserCredentials::hash_password));
 
 template <>
 struct EntityFields<UserCredentials> {
+  static constexpr const char *table = UserCredentialsTable::Table;
   static constexpr auto &fields = UserCredentialsFields;
 };
 
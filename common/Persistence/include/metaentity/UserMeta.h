@@ -1,6 +1,7 @@
 #ifndef METAENTITY_USER_H
 #define METAENTITY_USER_H
 
+#include "Fields.h"
 #include "Meta.h"
 #include "entities/User.h"
 
@@ -15,10 +16,13 @@ struct Reflection<User> {
   }
 };
 
-inline constexpr auto UserFields = std::make_tuple(&User::id, &User::email, &User::tag, &User::username);
+inline constexpr auto UserFields =
+    std::make_tuple(column(UserTable::Id, &User::id), column(UserTable::Username, &User::username),
+                    column(UserTable::Email, &User::email), column(UserTable::Tag, &User::tag));
 
 template <>
 struct EntityFields<User> {
+  static constexpr const char *table = UserTable::Table;
   static constexpr auto &fields = UserFields;
 };
 
@@ -1,6 +1,7 @@
 #ifndef DELETEQUERY_H
 #define DELETEQUERY_H
 
+#include "GenerationScope.h"
 #include "interfaces/IBaseQuery.h"
 #include "metaentity/EntityConcept.h"
 
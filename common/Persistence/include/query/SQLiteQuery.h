@@ -4,13 +4,25 @@
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <memory>
 
 #include "Debug_profiling.h"
 #include "interfaces/IQuery.h"
 
+class ConnectionLease;
+
 class SQLiteQuery : public IQuery {
  public:
-  explicit SQLiteQuery(const QSqlDatabase &db);
+  // lease, when given, keeps the pooled connection checked out for the query's lifetime
+  explicit SQLiteQuery(const QSqlDatabase &db, std::shared_ptr<ConnectionLease> lease = nullptr);
+  // reuses an already prepared statement
+  explicit SQLiteQuery(std::shared_ptr<QSqlQuery> prepared, std::shared_ptr<ConnectionLease> lease = nullptr);
+  ~SQLiteQuery() override;
+
+  SQLiteQuery(const SQLiteQuery &) = delete;
+  SQLiteQuery &operator=(const SQLiteQuery &) = delete;
+  SQLiteQuery(SQLiteQuery &&) = delete;
+  SQLiteQuery &operator=(SQLiteQuery &&) = delete;
 
   bool prepare(const QString &sql);
 
@@ -24,10 +36,16 @@ class SQLiteQuery : public IQuery {
 
   QVariant value(const std::string &field) const override;
 
+  int indexOf(const std::string &field) const override;
+
   QString error() override;
 
+  [[nodiscard]] std::shared_ptr<QSqlQuery> statement() const { return q_; }
+
  private:
-  QSqlQuery q_;
+  std::shared_ptr<ConnectionLease> lease_;  // declared first: outlives q_
+  std::shared_ptr<QSqlQuery> q_;
+  int bind_index_{0};
 };
 
 #endif  // SQLITEQUERY_H
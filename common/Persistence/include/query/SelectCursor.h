@@ -0,0 +1,70 @@
+#ifndef SELECTCURSOR_H
+#define SELECTCURSOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "StaticReflection.h"
+#include "interfaces/IQuery.h"
+#include "metaentity/EntityConcept.h"
+
+// Forward-only view over an executed SELECT: entities are built one row at a
+// time and never cached. The underlying statement (and its pooled connection)
+// stays busy until the cursor is destroyed, so keep cursors short-lived.
+template <EntityJson T>
+class SelectCursor {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    explicit Iterator(SelectCursor *cursor) : cursor_(cursor) { ++*this; }
+
+    T &operator*() const { return *cursor_->current_; }
+    T *operator->() const { return &*cursor_->current_; }
+    Iterator &operator++();
+    void operator++(int) { ++*this; }
+    bool operator==(std::default_sentinel_t) const { return !cursor_ || !cursor_->current_; }
+
+   private:
+    SelectCursor *cursor_{nullptr};
+  };
+
+  SelectCursor() = default;
+  explicit SelectCursor(std::unique_ptr<IQuery> query, std::string error = {});
+
+  SelectCursor(const SelectCursor &) = delete;
+  SelectCursor &operator=(const SelectCursor &) = delete;
+  SelectCursor(SelectCursor &&) noexcept = default;
+  SelectCursor &operator=(SelectCursor &&) noexcept = default;
+
+  // std::nullopt once the result set is exhausted
+  std::optional<T> next();
+  // up to max_rows entities; an empty vector means the cursor is exhausted
+  std::vector<T> nextChunk(std::size_t max_rows);
+
+  Iterator begin() { return Iterator(this); }
+  std::default_sentinel_t end() const { return {}; }
+
+  [[nodiscard]] bool ok() const { return error_.empty(); }
+  [[nodiscard]] const std::string &error() const { return error_; }
+  [[nodiscard]] std::size_t rowsRead() const { return rows_read_; }
+
+ private:
+  std::unique_ptr<IQuery> query_;
+  std::string error_;
+  std::optional<T> current_;
+  std::optional<reflection::ColumnIndices<T>> columns_;  // resolved on the first row
+  std::size_t rows_read_{0};
+};
+
+#include "SelectCursor.inl"
+
+#endif  // SELECTCURSOR_H
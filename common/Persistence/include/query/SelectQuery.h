@@ -1,11 +1,18 @@
 #ifndef BACKEND_GENERICREPOSITORY_QUERY_H_
 #define BACKEND_GENERICREPOSITORY_QUERY_H_
 
+#include <chrono>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "GenerationSnapshot.h"
+#include "QueryCachePolicy.h"
+#include "SingleFlight.h"
 #include "interfaces/IBaseQuery.h"
 #include "interfaces/ICacheService.h"
+#include "query/SelectCursor.h"
 #include "metaentity/metaentities.h"  //todo: don't include metaentity, refactor in this case
 
 struct Meta;
@@ -25,15 +32,47 @@ class SelectQuery : public IBaseQuery<T> {
   SelectQuery(ISqlExecutor *executor, ICacheService &cache);
   SelectQuery &orderBy(const std::string &field, const OrderDirection &direction = OrderDirection::ASC) &;
   QueryResult<T> execute() const override;
+  // Runs several queries with a single cache round trip for all their generations
+  // and entries; each miss then goes to the database as in execute(). The queries
+  // must share one cache service. results[i] belongs to queries[i].
+  static std::vector<QueryResult<T>> executeAll(const std::vector<const SelectQuery<T> *> &queries);
+  // row-by-row read that bypasses the query and entity caches
+  [[nodiscard]] SelectCursor<T> stream() const;
 
   // todo: extract from this class work with cache
  private:
+  struct CacheLookup {
+    std::string generation;  // stamp of the involved tables' generations
+    std::optional<std::string> entry;
+  };
+
+  struct CachedRows {
+    std::vector<T> rows;
+    bool fresh = false;  // false: stale, but within the stale-while-revalidate window
+  };
+
+  // misses of one key and generation in flight in this process, see QueryCachePolicy
+  inline static SingleFlight<std::vector<T>> loads_;
+
   void saveEntityInCache(const T &entity, std::chrono::hours ttl = std::chrono::hours{24}) const;
   int getEntityId(const T &entity) const;  // todo: make concept requires there is field id
   [[nodiscard]] QString buildQuery() const override;
-  auto getGenerations() const;
-  [[nodiscard]] std::optional<std::vector<T>> tryLoadFromCache(const std::string &key) const;
-  void updateCache(const std::string &key, const std::vector<T> &results) const;
+  // generations of every involved table and the cached entry of each query, in one round trip
+  [[nodiscard]] static std::vector<CacheLookup> loadGenerationsAndEntries(
+      ICacheService &cache, const std::vector<const SelectQuery<T> *> &queries,
+      const std::vector<std::string> &cache_keys);
+  [[nodiscard]] QueryResult<T> executeWithEntry(const QString &sql, const std::string &cache_key,
+                                                const CacheLookup &lookup) const;
+  [[nodiscard]] std::optional<CachedRows> tryLoadFromCache(const std::string &key,
+                                                           const std::optional<std::string> &entry,
+                                                           const std::string &generation,
+                                                           std::chrono::milliseconds max_stale) const;
+  [[nodiscard]] std::vector<T> loadFromDatabase(const QString &sql, const std::string &cache_key,
+                                                const std::string &generation) const;
+  // entry of the given generation written by another instance within timeout
+  [[nodiscard]] std::optional<std::vector<T>> waitForPeer(const std::string &cache_key, const std::string &generation,
+                                                          std::chrono::milliseconds timeout) const;
+  void updateCache(const std::string &key, const std::string &generation, const std::vector<T> &results) const;
 };
 
 #include "SelectQuery.inl"
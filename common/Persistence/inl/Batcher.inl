@@ -0,0 +1,107 @@
+#ifndef INL_BATCHER
+#define INL_BATCHER
+
+#include <algorithm>
+
+#include "Batcher.h"
+#include "Debug_profiling.h"
+
+template <typename T>
+SaverBatcher<T>::SaverBatcher(FlushFunction flush_function, FlushedCallback on_flushed, BatcherConfig config)
+    : flush_function_(std::move(flush_function)), on_flushed_(std::move(on_flushed)), config_(config) {
+  config_.max_batch_rows = std::max<std::size_t>(1, config_.max_batch_rows);
+  config_.max_pending_rows = std::max(config_.max_pending_rows, config_.max_batch_rows);
+  writer_ = std::thread([this] { run(); });
+}
+
+template <typename T>
+SaverBatcher<T>::~SaverBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_condition_.notify_all();
+  space_condition_.notify_all();
+  if (writer_.joinable()) writer_.join();
+}
+
+template <typename T>
+bool SaverBatcher<T>::saveEntity(T entity) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const bool has_space = space_condition_.wait_for(lock, config_.enqueue_timeout, [this] {
+    return stop_ || pending_.size() < config_.max_pending_rows;
+  });
+  if (!has_space || stop_) {
+    ++stats_.rejected_rows;
+    LOG_WARN("Batcher queue is full ({} rows), rejecting entity", pending_.size());
+    return false;
+  }
+
+  pending_.push_back({std::move(entity), std::chrono::steady_clock::now()});
+  ++enqueued_rows_;
+  const bool wake_writer = pending_.size() == 1 || pending_.size() >= config_.max_batch_rows;
+  lock.unlock();
+
+  if (wake_writer) work_condition_.notify_one();
+  return true;
+}
+
+template <typename T>
+void SaverBatcher<T>::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const std::size_t target = enqueued_rows_;
+  flush_target_ = std::max(flush_target_, target);
+  work_condition_.notify_one();
+  space_condition_.wait(lock, [this, target] { return done_rows_ >= target || (stop_ && pending_.empty()); });
+}
+
+template <typename T>
+std::size_t SaverBatcher<T>::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+template <typename T>
+BatcherStats SaverBatcher<T>::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+template <typename T>
+void SaverBatcher<T>::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_condition_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+    if (pending_.empty()) break;  // stop_ with nothing left to drain
+
+    // rows left over from a partial take keep their own deadline
+    work_condition_.wait_until(lock, pending_.front().enqueued_at + config_.max_delay, [this] {
+      return stop_ || pending_.size() >= config_.max_batch_rows || done_rows_ < flush_target_;
+    });
+
+    const std::size_t rows = std::min(pending_.size(), config_.max_batch_rows);
+    std::vector<T> batch;
+    batch.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) batch.push_back(std::move(pending_[i].entity));
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(rows));
+    lock.unlock();
+    space_condition_.notify_all();
+
+    bool ok = false;
+    {
+      PROFILE_SCOPE("[batcher] Flush");
+      ok = flush_function_(std::span<const T>(batch));
+    }
+    if (!ok) LOG_ERROR("Batcher failed to flush {} rows", batch.size());
+    if (on_flushed_) on_flushed_(std::span<const T>(batch), ok);
+
+    lock.lock();
+    done_rows_ += rows;
+    ++stats_.flushed_batches;
+    stats_.flushed_rows += rows;
+    if (!ok) ++stats_.failed_batches;
+    space_condition_.notify_all();
+  }
+}
+
+#endif  // INL_BATCHER
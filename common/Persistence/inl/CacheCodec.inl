@@ -0,0 +1,370 @@
+#ifndef INL_CACHECODEC
+#define INL_CACHECODEC
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include <type_traits>
+#include <utility>
+
+#include "CacheCodec.h"
+#include "StaticReflection.h"
+
+namespace cache_codec::detail {
+
+constexpr std::uint8_t kMagic = 0xCE;
+// bumped when the layout of the Fields format itself changes
+constexpr std::uint8_t kLayoutVersion = 1;
+
+template <typename>
+inline constexpr bool kUnsupportedMember = false;
+
+class Writer {
+ public:
+  void byte(std::uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+  void varint(std::uint64_t value) {
+    while (value >= 0x80) {
+      byte(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    byte(static_cast<std::uint8_t>(value));
+  }
+
+  // zigzag, so small negative values stay short
+  void integer(std::int64_t value) {
+    varint((static_cast<std::uint64_t>(value) << 1) ^ (value < 0 ? ~std::uint64_t{0} : std::uint64_t{0}));
+  }
+
+  void bytes(std::string_view value) {
+    varint(value.size());
+    out_.append(value);
+  }
+
+  void fixed32(std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) byte(static_cast<std::uint8_t>(value >> shift));
+  }
+
+  std::string &out() { return out_; }
+
+ private:
+  std::string out_;
+};
+
+// every read fails instead of running past the end, so truncated values decode to nullopt
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool byte(std::uint8_t &value) {
+    if (pos_ >= data_.size()) return false;
+    value = static_cast<std::uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool varint(std::uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      std::uint8_t next = 0;
+      if (!byte(next)) return false;
+      value |= static_cast<std::uint64_t>(next & 0x7F) << shift;
+      if ((next & 0x80) == 0) return true;
+    }
+    return false;
+  }
+
+  bool integer(std::int64_t &value) {
+    std::uint64_t zigzag = 0;
+    if (!varint(zigzag)) return false;
+    value = static_cast<std::int64_t>((zigzag >> 1) ^ (std::uint64_t{0} - (zigzag & 1)));
+    return true;
+  }
+
+  bool bytes(std::string_view &value) {
+    std::uint64_t size = 0;
+    if (!varint(size) || size > data_.size() - pos_) return false;
+    value = data_.substr(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool fixed32(std::uint32_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      std::uint8_t next = 0;
+      if (!byte(next)) return false;
+      value |= static_cast<std::uint32_t>(next) << shift;
+    }
+    return true;
+  }
+
+  [[nodiscard]] std::string_view rest() const { return data_.substr(pos_); }
+  [[nodiscard]] bool atEnd() const { return pos_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  std::size_t pos_{0};
+};
+
+template <typename M>
+void appendTypeTag(std::string &out) {
+  if constexpr (kIsOptional<M>) {
+    out += '?';
+    appendTypeTag<typename M::value_type>(out);
+  } else if constexpr (std::is_same_v<M, bool>) {
+    out += 'b';
+  } else if constexpr (std::is_integral_v<M>) {
+    out += 'i' + std::to_string(sizeof(M));
+  } else if constexpr (std::is_same_v<M, std::string>) {
+    out += 's';
+  } else {
+    static_assert(kUnsupportedMember<M>, "no cache encoding for this member type");
+  }
+}
+
+template <typename M>
+void put(Writer &writer, const M &value) {
+  if constexpr (kIsOptional<M>) {
+    writer.byte(value.has_value() ? 1 : 0);
+    if (value.has_value()) put(writer, *value);
+  } else if constexpr (std::is_same_v<M, bool>) {
+    writer.byte(value ? 1 : 0);
+  } else if constexpr (std::is_integral_v<M>) {
+    writer.integer(static_cast<std::int64_t>(value));
+  } else if constexpr (std::is_same_v<M, std::string>) {
+    writer.bytes(value);
+  } else {
+    static_assert(kUnsupportedMember<M>, "no cache encoding for this member type");
+  }
+}
+
+template <typename M>
+bool get(Reader &reader, M &value) {
+  if constexpr (kIsOptional<M>) {
+    std::uint8_t present = 0;
+    if (!reader.byte(present) || present > 1) return false;
+    if (present == 0) {
+      value = std::nullopt;
+      return true;
+    }
+    typename M::value_type inner{};
+    if (!get(reader, inner)) return false;
+    value = std::move(inner);
+    return true;
+  } else if constexpr (std::is_same_v<M, bool>) {
+    std::uint8_t flag = 0;
+    if (!reader.byte(flag) || flag > 1) return false;
+    value = flag == 1;
+    return true;
+  } else if constexpr (std::is_integral_v<M>) {
+    std::int64_t wide = 0;
+    if (!reader.integer(wide) || !std::in_range<M>(wide)) return false;
+    value = static_cast<M>(wide);
+    return true;
+  } else if constexpr (std::is_same_v<M, std::string>) {
+    std::string_view bytes;
+    if (!reader.bytes(bytes)) return false;
+    value.assign(bytes);
+    return true;
+  } else {
+    static_assert(kUnsupportedMember<M>, "no cache encoding for this member type");
+  }
+}
+
+template <typename T>
+void putFields(Writer &writer, const T &entity) {
+  reflection::forEachColumn<T>([&](const auto &column) { put(writer, entity.*(column.member)); });
+}
+
+template <typename T>
+bool getFields(Reader &reader, T &entity) {
+  bool ok = true;
+  reflection::forEachColumn<T>([&](const auto &column) { ok = ok && get(reader, entity.*(column.member)); });
+  return ok;
+}
+
+template <typename T, CacheFormat F>
+void writeDocument(Writer &writer, const nlohmann::json &json) {
+  if constexpr (F == CacheFormat::Json) {
+    writer.out() += json.dump();
+  } else {
+    nlohmann::json::to_msgpack(json, writer.out());
+  }
+}
+
+template <CacheFormat F>
+std::optional<nlohmann::json> readDocument(std::string_view payload) {
+  try {
+    if constexpr (F == CacheFormat::Json) return nlohmann::json::parse(payload.begin(), payload.end());
+    return nlohmann::json::from_msgpack(payload.begin(), payload.end());
+  } catch (const nlohmann::json::exception &) {
+    return std::nullopt;
+  }
+}
+
+template <typename T, CacheFormat F>
+void writeEntity(Writer &writer, const T &entity) {
+  if constexpr (F == CacheFormat::Fields) {
+    putFields(writer, entity);
+  } else {
+    writeDocument<T, F>(writer, reflection::toJson(entity));
+  }
+}
+
+template <typename T, CacheFormat F>
+void writeRows(Writer &writer, const std::vector<T> &entities) {
+  if constexpr (F == CacheFormat::Fields) {
+    writer.varint(entities.size());
+    for (const auto &entity : entities) putFields(writer, entity);
+  } else {
+    writeDocument<T, F>(writer, reflection::toJson(entities));
+  }
+}
+
+template <typename T, CacheFormat F>
+std::optional<T> readEntity(std::string_view payload) {
+  if constexpr (F == CacheFormat::Fields) {
+    Reader reader(payload);
+    T entity;
+    if (!getFields(reader, entity) || !reader.atEnd()) return std::nullopt;
+    return entity;
+  } else {
+    auto json = readDocument<F>(payload);
+    if (!json) return std::nullopt;
+    try {
+      return reflection::fromJson<T>(*json);
+    } catch (const nlohmann::json::exception &) {
+      return std::nullopt;
+    }
+  }
+}
+
+template <typename T, CacheFormat F>
+std::optional<std::vector<T>> readRows(std::string_view payload) {
+  if constexpr (F == CacheFormat::Fields) {
+    Reader reader(payload);
+    std::uint64_t count = 0;
+    if (!reader.varint(count)) return std::nullopt;
+    std::vector<T> entities;
+    // every entity takes at least one byte, which bounds a corrupt count
+    entities.reserve(std::min<std::uint64_t>(count, payload.size()));
+    for (std::uint64_t i = 0; i < count; ++i) {
+      T entity;
+      if (!getFields(reader, entity)) return std::nullopt;
+      entities.push_back(std::move(entity));
+    }
+    if (!reader.atEnd()) return std::nullopt;
+    return entities;
+  } else {
+    auto json = readDocument<F>(payload);
+    if (!json || !json->is_array()) return std::nullopt;
+    try {
+      return reflection::listFromJson<T>(*json);
+    } catch (const nlohmann::json::exception &) {
+      return std::nullopt;
+    }
+  }
+}
+
+template <typename T, CacheFormat F>
+void writeHeader(Writer &writer) {
+  writer.byte(kMagic);
+  writer.byte(static_cast<std::uint8_t>(F));
+  writer.fixed32(schemaVersion<T>());
+}
+
+template <typename T, CacheFormat F>
+bool readHeader(Reader &reader) {
+  std::uint8_t magic = 0;
+  std::uint8_t format = 0;
+  std::uint32_t version = 0;
+  return reader.byte(magic) && magic == kMagic && reader.byte(format) && format == static_cast<std::uint8_t>(F) &&
+         reader.fixed32(version) && version == schemaVersion<T>();
+}
+
+}  // namespace cache_codec::detail
+
+namespace cache_codec {
+
+template <typename T>
+std::uint32_t schemaVersion() {
+  static const std::uint32_t version = [] {
+    std::string layout(reflection::tableName<T>());
+    layout += '#' + std::to_string(detail::kLayoutVersion);
+    reflection::forEachColumn<T>([&](const auto &column) {
+      layout += ';';
+      layout += column.name;
+      layout += ':';
+      detail::appendTypeTag<typename std::remove_cvref_t<decltype(column)>::Member>(layout);
+    });
+    // FNV-1a
+    std::uint32_t hash = 2166136261u;
+    for (char c : layout) {
+      hash ^= static_cast<std::uint8_t>(c);
+      hash *= 16777619u;
+    }
+    return hash;
+  }();
+  return version;
+}
+
+template <typename T, CacheFormat F>
+std::string encode(const T &entity) {
+  detail::Writer writer;
+  detail::writeHeader<T, F>(writer);
+  detail::writeEntity<T, F>(writer, entity);
+  return std::move(writer.out());
+}
+
+template <typename T, CacheFormat F>
+std::string encode(const std::vector<T> &entities) {
+  detail::Writer writer;
+  detail::writeHeader<T, F>(writer);
+  detail::writeRows<T, F>(writer, entities);
+  return std::move(writer.out());
+}
+
+template <typename T, CacheFormat F>
+std::optional<T> decode(std::string_view data) {
+  detail::Reader reader(data);
+  if (!detail::readHeader<T, F>(reader)) return std::nullopt;
+  return detail::readEntity<T, F>(reader.rest());
+}
+
+template <typename T, CacheFormat F>
+std::optional<std::vector<T>> decodeList(std::string_view data) {
+  detail::Reader reader(data);
+  if (!detail::readHeader<T, F>(reader)) return std::nullopt;
+  return detail::readRows<T, F>(reader.rest());
+}
+
+template <typename T, CacheFormat F>
+std::string encodeQueryEntry(std::string_view generation, long long stored_at, const std::vector<T> &rows) {
+  detail::Writer writer;
+  detail::writeHeader<T, F>(writer);
+  writer.bytes(generation);
+  writer.integer(stored_at);
+  detail::writeRows<T, F>(writer, rows);
+  return std::move(writer.out());
+}
+
+template <typename T, CacheFormat F>
+std::optional<QueryEntryView> readQueryEntry(std::string_view data) {
+  detail::Reader reader(data);
+  QueryEntryView view;
+  std::int64_t stored_at = 0;
+  if (!detail::readHeader<T, F>(reader) || !reader.bytes(view.generation) || !reader.integer(stored_at)) {
+    return std::nullopt;
+  }
+  view.stored_at = stored_at;
+  view.rows = reader.rest();
+  return view;
+}
+
+template <typename T, CacheFormat F>
+std::optional<std::vector<T>> decodeRows(std::string_view rows) {
+  return detail::readRows<T, F>(rows);
+}
+
+}  // namespace cache_codec
+
+#endif  // INL_CACHECODEC
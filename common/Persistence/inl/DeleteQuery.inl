@@ -14,7 +14,12 @@ QueryResult<T> DeleteQuery<T>::execute() const {
 
   LOG_INFO("query {} succeed", sql.toStdString());
   for(const auto& table_name : this->involved_tables_) {
-    cache_.incr(std::string("table_generation:") + table_name.toStdString());
+    const std::string table = table_name.toStdString();
+    if (auto partition = this->partitionFilter(table)) {
+      generation_scope::bumpPartition(cache_, table, *partition);
+    } else {
+      generation_scope::bumpTable(cache_, table);
+    }
   }
 
   return DeleteResult<T>{ .success = true };
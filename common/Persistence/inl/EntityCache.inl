@@ -0,0 +1,107 @@
+#ifndef INL_ENTITYCACHE
+#define INL_ENTITYCACHE
+
+#include <QStringList>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CacheCodec.h"
+#include "CacheKeyGenerator.h"
+#include "Debug_profiling.h"
+#include "EntityCache.h"
+#include "GenerationSnapshot.h"
+#include "NegativeCache.h"
+#include "QueryCachePolicy.h"
+#include "SqlBuilder.h"
+#include "StaticReflection.h"
+
+template <EntityJson T>
+  requires kEntityKeyIsId<T>
+std::vector<T> entity_cache::findByIds(ISqlExecutor *executor, ICacheService &cache, std::span<const long long> ids) {
+  PROFILE_SCOPE("[entity_cache] FindByIds");
+  std::vector<long long> unique_ids;
+  std::unordered_set<long long> seen;
+  unique_ids.reserve(ids.size());
+  for (long long id : ids) {
+    if (seen.insert(id).second) unique_ids.push_back(id);
+  }
+  if (unique_ids.empty()) return {};
+
+  // the table generation rides in the same MGET, ahead of the ids, to check and stamp tombstones
+  const auto negative_ttl = QueryCachePolicy::instance().negativeTtl();
+  const std::size_t first_id = negative_ttl.count() > 0 ? 1 : 0;
+  std::vector<std::string> keys;
+  keys.reserve(first_id + unique_ids.size());
+  if (first_id) keys.push_back(GenerationSnapshot::cacheKey(reflection::tableName<T>()));
+  for (long long id : unique_ids) keys.push_back(CacheKeyGenerator::makeKey<T>(id));
+
+  auto cached = cache.getMany(keys);
+  cached.resize(keys.size());
+  const std::string generation = first_id ? cached[0].value_or("0") : std::string{};
+
+  std::unordered_map<long long, T> found;
+  std::vector<long long> missing;
+  for (std::size_t i = 0; i < unique_ids.size(); ++i) {
+    if (const auto &value = cached[first_id + i]) {
+      if (auto dead = negative_cache::tombstoneGeneration(*value)) {
+        if (first_id && *dead == generation) {
+          negative_cache::countEntityHit();
+          continue;
+        }
+      } else if (auto entity = cache_codec::decode<T>(*value); entity && entity->id == unique_ids[i]) {
+        // undecodable values (older codec or schema) are refilled like misses
+        found.emplace(unique_ids[i], std::move(*entity));
+        continue;
+      }
+    }
+    missing.push_back(unique_ids[i]);
+  }
+
+  LOG_INFO("Entity cache of {} had {} of {} ids", reflection::tableName<T>(), found.size(), unique_ids.size());
+
+  if (!missing.empty()) {
+    const QString table = QString::fromUtf8(reflection::tableName<T>());
+    const std::span<const long long> pending(missing);
+    SqlBuilder builder;
+    std::vector<CacheEntry> tombstones;
+    for (std::size_t offset = 0; offset < pending.size(); offset += SqlBuilder::kMaxBindParameters) {
+      const auto chunk = pending.subspan(offset, std::min(SqlBuilder::kMaxBindParameters, pending.size() - offset));
+      QStringList placeholders;
+      QList<QVariant> values;
+      for (long long id : chunk) {
+        placeholders << "?";
+        values << id;
+      }
+
+      QString sql = QString("SELECT * FROM %1 WHERE id IN (%2)").arg(table, placeholders.join(", "));
+      auto result = executor->execute(sql, values);
+      if (!result.query) {
+        LOG_ERROR("Failed to load {} ids from {}, error {}", chunk.size(), reflection::tableName<T>(), result.error);
+        continue;
+      }
+
+      // rows are not written back: a save or delete landing between this SELECT and
+      // the write would be overwritten by the older row. Only tombstones, stamped
+      // with the generation, come from here.
+      for (auto &entity : builder.buildResults<T>(result.query)) found.emplace(entity.id, std::move(entity));
+      if (!first_id) continue;
+      for (long long id : chunk) {
+        if (!found.contains(id)) {
+          tombstones.push_back(
+              {CacheKeyGenerator::makeKey<T>(id), negative_cache::tombstone(generation), negative_ttl});
+        }
+      }
+    }
+    if (!tombstones.empty()) cache.setMany(tombstones);
+  }
+
+  std::vector<T> entities;
+  entities.reserve(found.size());
+  for (long long id : unique_ids) {
+    if (auto it = found.find(id); it != found.end()) entities.push_back(std::move(it->second));
+  }
+  return entities;
+}
+
+#endif  // INL_ENTITYCACHE
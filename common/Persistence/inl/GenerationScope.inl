@@ -0,0 +1,83 @@
+#ifndef INL_GENERATIONSCOPE
+#define INL_GENERATIONSCOPE
+
+#include <unordered_set>
+
+#include "GenerationScope.h"
+#include "StaticReflection.h"
+
+namespace generation_scope {
+
+namespace detail {
+
+template <typename... Ts>
+const char *partitionColumnOf(std::string_view table) {
+  const char *column = nullptr;
+  ((column == nullptr && table == EntityFields<Ts>::table ? (void)(column = EntityPartition<Ts>::column) : (void)0),
+   ...);
+  return column;
+}
+
+}  // namespace detail
+
+inline std::string partition(const std::string &table, std::string_view column, const std::string &value) {
+  return table + ":" + std::string(column) + "=" + value;
+}
+
+inline std::string anyPartition(const std::string &table) { return table + ":*"; }
+
+inline const char *partitionColumn(std::string_view table) {
+  // every entity of metaentities.h
+  return detail::partitionColumnOf<Chat, ChatMember, Message, MessageStatus, PrivateChat, Reaction, ReactionInfo,
+                                   User, UserCredentials>(table);
+}
+
+inline std::vector<std::string> queryScopes(const std::string &table, const std::optional<std::string> &value) {
+  const char *column = partitionColumn(table);
+  if (!column || !value) return {table};
+  return {anyPartition(table), partition(table, column, *value)};
+}
+
+inline void bumpTable(ICacheService &cache, const std::string &table) {
+  if (partitionColumn(table)) {
+    bumpTableGenerations(cache, {table, anyPartition(table)});
+  } else {
+    bumpTableGeneration(cache, table);
+  }
+}
+
+inline void bumpPartition(ICacheService &cache, const std::string &table, const std::string &value) {
+  if (const char *column = partitionColumn(table)) {
+    bumpTableGenerations(cache, {table, partition(table, column, value)});
+  } else {
+    bumpTableGeneration(cache, table);
+  }
+}
+
+template <EntityJson T>
+void bumpRows(ICacheService &cache, std::span<const T> rows) {
+  const std::string table = reflection::tableName<T>();
+  if constexpr (kEntityHasPartition<T>) {
+    std::unordered_set<long long> values;
+    for (const auto &row : rows) {
+      values.insert(EntityPartition<T>::get(row));
+      if (values.size() > kMaxPartitionBumps) {
+        bumpTable(cache, table);
+        return;
+      }
+    }
+
+    std::vector<std::string> scopes{table};
+    scopes.reserve(values.size() + 1);
+    for (long long value : values) {
+      scopes.push_back(partition(table, EntityPartition<T>::column, std::to_string(value)));
+    }
+    bumpTableGenerations(cache, scopes);
+  } else {
+    bumpTableGeneration(cache, table);
+  }
+}
+
+}  // namespace generation_scope
+
+#endif  // INL_GENERATIONSCOPE
@@ -1,25 +1,27 @@
 #ifndef INL_GENERIC_REPOSITORY
 #define INL_GENERIC_REPOSITORY
 
+#include "CacheCodec.h"
+#include "EntityCache.h"
+#include "GenerationScope.h"
 #include "interfaces/IBaseQuery.h"
 #include "interfaces/ICacheService.h"
 #include "interfaces/ISqlExecutor.h"
 #include "SqlBuilder.h"
+#include "StaticReflection.h"
 #include "QueryFactory.h"
 #include "GenericRepository.h"
 
 template <EntityJson T>
 bool GenericRepository::save(const T& entity) {
-  std::string entity_json = nlohmann::json(entity).dump();
+  std::string entity_json = reflection::toJson(entity).dump();
 
   if(!entity.checkInvariants()) { //todo: DBC_REQUIRE(entity.checkInvariants());
     LOG_ERROR("checkInvariants failed for entity {}", entity_json);
     return false;
   }
 
-  const auto& meta = Reflection<T>::meta();
-
-  SqlStatement smt_entity = builder_.buildInsert<T>(meta, entity);
+  SqlStatement smt_entity = builder_.buildInsert<T>(entity);
   LOG_INFO("Builded sql {}", smt_entity.query.toStdString());
   if(auto result = executor_->execute(smt_entity.query, smt_entity.values); !result.query) {
     LOG_ERROR("Failed to save {}, reason - {}", entity_json, result.error);
@@ -28,19 +30,59 @@ bool GenericRepository::save(const T& entity) {
 
   LOG_INFO("Save succeed for json: {}", entity_json);
 
-  cache_.set(cache_kay_generator_.makeKey<T>(entity), entity_json, std::chrono::seconds{30});
-  cache_.incr(std::string("table_generation:") + meta.table_name);
+  cache_.set(cache_kay_generator_.makeKey<T>(entity), cache_codec::encode(entity), entity_cache::kTtl);
+  generation_scope::bumpRows<T>(cache_, std::span<const T>(&entity, 1));
   return true;
 }
 
-// template <EntityJson T>
-// bool GenericRepository::save(std::vector<T>& entities) {
-//   bool res = true;
-//   for(auto &entity: entities) { //TODO: implement bathcer save
-//     res |= save(entity);
-//   }
-//   return res;
-// }
+template <EntityJson T>
+bool GenericRepository::saveAll(std::span<const T> entities) {
+  PROFILE_SCOPE("[repository] SaveAll");
+  if (entities.empty()) return true;
+
+  for (const auto& entity : entities) {
+    if (!entity.checkInvariants()) {
+      LOG_ERROR("checkInvariants failed for entity {}", reflection::toJson(entity).dump());
+      return false;
+    }
+  }
+
+  if (auto begin = executor_->execute("BEGIN IMMEDIATE"); !begin.query) {
+    LOG_ERROR("Failed to begin batch save into {}, reason - {}", reflection::tableName<T>(), begin.error);
+    (void)executor_->execute("ROLLBACK");  // hands the writer connection back
+    return false;
+  }
+
+  for (const auto& statement : builder_.buildInsertBatch<T>(entities)) {
+    if (auto result = executor_->execute(statement.query, statement.values); !result.query) {
+      LOG_ERROR("Failed to save batch of {} into {}, reason - {}", entities.size(), reflection::tableName<T>(),
+                result.error);
+      (void)executor_->execute("ROLLBACK");
+      return false;
+    }
+  }
+
+  if (auto commit = executor_->execute("COMMIT"); !commit.query) {
+    LOG_ERROR("Failed to commit batch into {}, reason - {}", reflection::tableName<T>(), commit.error);
+    (void)executor_->execute("ROLLBACK");
+    return false;
+  }
+
+  LOG_INFO("Save succeed for {} entities of {}", entities.size(), reflection::tableName<T>());
+
+  std::vector<std::string> keys;
+  std::vector<std::string> encoded;
+  keys.reserve(entities.size());
+  encoded.reserve(entities.size());
+  for (const auto& entity : entities) {
+    keys.push_back(cache_kay_generator_.makeKey<T>(entity));
+    encoded.push_back(cache_codec::encode(entity));
+  }
+
+  cache_.setPipelines(keys, encoded, entity_cache::kTtl);
+  generation_scope::bumpRows<T>(cache_, entities);
+  return true;
+}
 
 template <EntityJson T>
 void GenericRepository::saveAsync(T& entity) {
@@ -49,7 +91,7 @@ void GenericRepository::saveAsync(T& entity) {
     save(entity);
   } else {
     LOG_INFO("Start save async");
-    pool_->enqueue([this, entity]() { return this->save<T>(entity); });
+    pool_->post([this, entity]() { this->save<T>(entity); }, TaskPriority::Background);
   }
 }
 
@@ -68,11 +110,22 @@ void GenericRepository::saveAsync(T& entity) {
 template <EntityJson T>
 std::optional<T> GenericRepository::findOne(long long entity_id) {
   LOG_INFO("Id in dindOne {}", entity_id);
-  auto query = QueryFactory::createSelect<T>(executor_, cache_);
-  query->where("id", entity_id).limit(1);
-  auto res = query->execute();
-  auto select_res = QueryFactory::getSelectResult(res);
-  return select_res.result.empty() ? std::nullopt : std::make_optional(select_res.result.front());
+  if constexpr (kEntityKeyIsId<T>) {
+    auto found = findMany<T>(std::span<const long long>(&entity_id, 1));
+    return found.empty() ? std::nullopt : std::make_optional(std::move(found.front()));
+  } else {
+    auto query = QueryFactory::createSelect<T>(executor_, cache_);
+    query->where("id", entity_id).limit(1);
+    auto res = query->execute();
+    auto select_res = QueryFactory::getSelectResult(res);
+    return select_res.result.empty() ? std::nullopt : std::make_optional(select_res.result.front());
+  }
+}
+
+template <EntityJson T>
+  requires kEntityKeyIsId<T>
+std::vector<T> GenericRepository::findMany(std::span<const long long> entity_ids) {
+  return entity_cache::findByIds<T>(executor_, cache_, entity_ids);
 }
 
 template <EntityJson T>
@@ -88,9 +141,8 @@ bool GenericRepository::deleteEntity(const T& entity) {
 template <EntityJson T>
 bool GenericRepository::deleteById(long long entity_id) {
   PROFILE_SCOPE("[repository] DeleteById");
-  auto meta = Reflection<T>::meta();
   QString sql = QString("DELETE FROM %1 WHERE id = ?")
-                    .arg(QString::fromStdString(meta.table_name));
+                    .arg(QString::fromUtf8(reflection::tableName<T>()));
 
   if(auto result = executor_->execute(sql, {entity_id}); !result.query) {
     LOG_ERROR("Failed to delete by id {}, error {}", entity_id, result.error);
@@ -98,11 +150,55 @@ bool GenericRepository::deleteById(long long entity_id) {
   }
 
   // todo: std::string stmKey = meta.table_name + std::string(":deleteById");
-  cache_.incr(std::string("table_generation:") + meta.table_name);
+  generation_scope::bumpTable(cache_, reflection::tableName<T>());
   cache_.remove(cache_kay_generator_.makeKey<T>(entity_id));
   return true;
 }
 
+template <EntityJson T>
+bool GenericRepository::deleteByIds(std::span<const long long> entity_ids) {
+  PROFILE_SCOPE("[repository] DeleteByIds");
+  if (entity_ids.empty()) return true;
+
+  if (auto begin = executor_->execute("BEGIN IMMEDIATE"); !begin.query) {
+    LOG_ERROR("Failed to begin batch delete from {}, reason - {}", reflection::tableName<T>(), begin.error);
+    (void)executor_->execute("ROLLBACK");
+    return false;
+  }
+
+  const QString table = QString::fromUtf8(reflection::tableName<T>());
+  for (std::size_t offset = 0; offset < entity_ids.size(); offset += SqlBuilder::kMaxBindParameters) {
+    const auto chunk = entity_ids.subspan(offset, std::min(SqlBuilder::kMaxBindParameters, entity_ids.size() - offset));
+    QStringList placeholders;
+    QList<QVariant> values;
+    for (long long id : chunk) {
+      placeholders << "?";
+      values << id;
+    }
+
+    QString sql = QString("DELETE FROM %1 WHERE id IN (%2)").arg(table, placeholders.join(", "));
+    if (auto result = executor_->execute(sql, values); !result.query) {
+      LOG_ERROR("Failed to delete {} ids from {}, error {}", chunk.size(), reflection::tableName<T>(), result.error);
+      (void)executor_->execute("ROLLBACK");
+      return false;
+    }
+  }
+
+  if (auto commit = executor_->execute("COMMIT"); !commit.query) {
+    LOG_ERROR("Failed to commit batch delete from {}, reason - {}", reflection::tableName<T>(), commit.error);
+    (void)executor_->execute("ROLLBACK");
+    return false;
+  }
+
+  std::vector<std::string> keys;
+  keys.reserve(entity_ids.size());
+  for (long long id : entity_ids) keys.push_back(cache_kay_generator_.makeKey<T>(id));
+
+  generation_scope::bumpTable(cache_, reflection::tableName<T>());
+  cache_.removeMany(keys);
+  return true;
+}
+
 template <EntityJson T>
 std::vector<T> GenericRepository::findByField(const std::string& field,
                            const std::string& value) {
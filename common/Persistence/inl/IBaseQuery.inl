@@ -28,7 +28,7 @@ inline std::string trim(std::string_view sv) {
 
 template <EntityJson T>
 IBaseQuery<T>::IBaseQuery(ISqlExecutor* executor) : executor_(executor),
-    table_name_(QString::fromStdString(Reflection<T>::meta().table_name)) {
+    table_name_(QString::fromUtf8(reflection::tableName<T>())) {
   involved_tables_.push_back(table_name_);
 }
 
@@ -51,6 +51,7 @@ IBaseQuery<T>& IBaseQuery<T>::where(const std::string& field, const QVariant& va
   std::string field_trimmed = trim(field);
   filters_.push_back(QString("%1 = ?").arg(QString::fromStdString(field_trimmed)));
   values_.push_back(value);
+  equal_filters_.emplace_back(std::move(field_trimmed), value);
   return *this;
 }
 
@@ -69,6 +70,7 @@ IBaseQuery<T>& IBaseQuery<T>::where(const std::string& field, Operator op, const
   filters_.push_back(QString("%1 %2 ?").arg(QString::fromStdString(field_trimmed))
                          .arg(QString::fromStdString(kOperatorToSql.at(op))));
   values_.push_back(value);
+  if (op == Operator::Equal) equal_filters_.emplace_back(std::move(field_trimmed), value);
   return *this;
 }
 
@@ -98,3 +100,28 @@ IBaseQuery<T>& IBaseQuery<T>::join(const std::string& table,
   involved_tables_.push_back(QString::fromStdString(table_trimmed));
   return *this;
 }
+
+template <EntityJson T>
+std::optional<std::string> IBaseQuery<T>::partitionFilter(const std::string& table) const {
+  const char* column = generation_scope::partitionColumn(table);
+  if (!column) return std::nullopt;
+
+  const std::string qualified = table + "." + column;
+  const bool from_table = table == table_name_.toStdString();
+  for (const auto& [field, value] : equal_filters_) {
+    if (field == qualified || (from_table && field == column)) return value.toString().toStdString();
+  }
+  return std::nullopt;
+}
+
+template <EntityJson T>
+std::vector<std::string> IBaseQuery<T>::generationScopes() const {
+  std::vector<std::string> scopes;
+  for (const auto& table : involved_tables_) {
+    const std::string name = table.toStdString();
+    for (auto& scope : generation_scope::queryScopes(name, partitionFilter(name))) {
+      if (std::ranges::find(scopes, scope) == scopes.end()) scopes.push_back(std::move(scope));
+    }
+  }
+  return scopes;
+}
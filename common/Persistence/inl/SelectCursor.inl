@@ -0,0 +1,40 @@
+#ifndef INL_SELECT_CURSOR
+#define INL_SELECT_CURSOR
+
+#include "query/SelectCursor.h"
+#include "StaticReflection.h"
+
+template <EntityJson T>
+SelectCursor<T>::SelectCursor(std::unique_ptr<IQuery> query, std::string error)
+    : query_(std::move(query)), error_(std::move(error)) {}
+
+template <EntityJson T>
+std::optional<T> SelectCursor<T>::next() {
+  if (!query_ || !query_->next()) {
+    query_.reset();  // hands the statement back as soon as the rows run out
+    return std::nullopt;
+  }
+  ++rows_read_;
+  if (!columns_) columns_ = reflection::columnIndices<T>(*query_);
+  return reflection::build<T>(*query_, *columns_);
+}
+
+template <EntityJson T>
+std::vector<T> SelectCursor<T>::nextChunk(std::size_t max_rows) {
+  std::vector<T> chunk;
+  chunk.reserve(max_rows);
+  while (chunk.size() < max_rows) {
+    auto entity = next();
+    if (!entity) break;
+    chunk.push_back(std::move(*entity));
+  }
+  return chunk;
+}
+
+template <EntityJson T>
+typename SelectCursor<T>::Iterator &SelectCursor<T>::Iterator::operator++() {
+  cursor_->current_ = cursor_->next();
+  return *this;
+}
+
+#endif  // INL_SELECT_CURSOR
@@ -1,62 +1,65 @@
 #ifndef INL_SELECT_QUERY
 #define INL_SELECT_QUERY
 
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <thread>
 
 #include "query/SelectQuery.h"
+#include "CacheCodec.h"
+#include "QueryKeyHasher.h"
 #include "SqlExecutor.h"
 #include "Meta.h"
+#include "NegativeCache.h"
 #include "SqlBuilder.h"
+#include "StaticReflection.h"
 
 namespace {
 
-std::size_t hashParams(const  QVector<QVariant>& values) {
-  std::size_t params_hash = 0;
-    for (const auto& v : values) {
-    params_hash ^= std::hash<std::string>{}(v.toString().toStdString());
-    }
-  return params_hash;
-}
-
-using Table = std::string;
-std::size_t hashGenerations(
-    const std::unordered_map<Table, std::string>& generations) {
-  std::size_t generation_hash = 0;
-    for (const auto& [table, gen] : generations) {
-    generation_hash ^= std::hash<std::string>{}(table + gen);
-    }
-  return generation_hash;
-}
-
 std::string buildEntityKey(const std::string& table_name, const std::string& entity_key) {
   return "entity_cache:" + table_name + ":" + entity_key;
 }
 
-std::string createCacheKey(const QString& sql, int generation_hash,
-                           int params_hash) {
-  return "query_cache:" + sql.toStdString() +
-         ":gen=" + std::to_string(generation_hash) +
-         ":params=" + std::to_string(params_hash);
+// one lock per entry and generation, left to expire: releasing it would cost another round trip
+std::string buildLoadLockKey(const std::string& cache_key, const std::string& generation) {
+  return "query_lock:" + cache_key + ":" + generation;
+}
+
+long long nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
 }
 
 }  // namespace
 
 template <EntityJson T>
-std::optional<std::vector<T>> SelectQuery<T>::tryLoadFromCache(const std::string& key) const {
-  if (std::optional<std::string> entity_string = cache_.get(key)) {
-    LOG_INFO("[QueryCache] HIT for key '{}'", key);
-    try {
-      nlohmann::json json_obj = nlohmann::json::parse(*entity_string);
-      auto res = json_obj.template get<std::vector<T>>();
-      LOG_INFO("[QueryCache] Parsed successfully: '{}'", res.size());
-      return res;
-    } catch (...) {
-      LOG_WARN("[QueryCache] Failed to parse cached data for key '{}'", key);
-    }
-  } else {
+std::optional<typename SelectQuery<T>::CachedRows> SelectQuery<T>::tryLoadFromCache(
+    const std::string& key, const std::optional<std::string>& entry, const std::string& generation,
+    std::chrono::milliseconds max_stale) const {
+  if (!entry) {
     LOG_INFO("[QueryCache] MISS for key '{}'", key);
+    return std::nullopt;
   }
-  return std::nullopt;
+
+  // entries of another codec, format or schema version are not readable here and count as a miss
+  auto view = cache_codec::readQueryEntry<T>(*entry);
+  if (!view) {
+    LOG_WARN("[QueryCache] Unreadable cached data for key '{}'", key);
+    return std::nullopt;
+  }
+
+  const bool fresh = view->generation == generation;
+  if (!fresh && (max_stale.count() <= 0 || nowMs() - view->stored_at > max_stale.count())) {
+    LOG_INFO("[QueryCache] STALE for key '{}'", key);
+    return std::nullopt;
+  }
+
+  auto rows = cache_codec::decodeRows<T>(view->rows);
+  if (!rows) {
+    LOG_WARN("[QueryCache] Failed to decode cached rows for key '{}'", key);
+    return std::nullopt;
+  }
+  LOG_INFO("[QueryCache] {} for key '{}' with {} rows", fresh ? "HIT" : "STALE HIT", key, rows->size());
+  return CachedRows{.rows = std::move(*rows), .fresh = fresh};
 }
 
 template <EntityJson T>
@@ -66,43 +69,123 @@ SelectQuery<T>::SelectQuery(ISqlExecutor* executor, ICacheService& cache)
 template <EntityJson T>
 QueryResult<T> SelectQuery<T>::execute() const {
   PROFILE_SCOPE();
-  QString sql = buildQuery();
-  std::string cache_key = createCacheKey(sql, hashGenerations(getGenerations()), hashParams(this->values_));
+  return std::move(executeAll({this}).front());
+}
+
+template <EntityJson T>
+std::vector<QueryResult<T>> SelectQuery<T>::executeAll(const std::vector<const SelectQuery<T>*>& queries) {
+  PROFILE_SCOPE();
+  std::vector<QueryResult<T>> results;
+  if (queries.empty()) return results;
 
-  if (auto cached = tryLoadFromCache(cache_key); cached.has_value()) {
+  std::vector<QString> sqls;
+  std::vector<std::string> cache_keys;
+  sqls.reserve(queries.size());
+  cache_keys.reserve(queries.size());
+  for (const auto* query : queries) {
+    sqls.push_back(query->buildQuery());
+    // the generation is stored inside the entry rather than in the key, so the key is
+    // known up front and can travel in the same MGET as the generation counters
+    cache_keys.push_back(makeQueryCacheKey(sqls.back(), query->values_));
+  }
+
+  auto lookups = loadGenerationsAndEntries(queries.front()->cache_, queries, cache_keys);
+  results.reserve(queries.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    results.push_back(queries[i]->executeWithEntry(sqls[i], cache_keys[i], lookups[i]));
+  }
+  return results;
+}
+
+template <EntityJson T>
+QueryResult<T> SelectQuery<T>::executeWithEntry(const QString& sql, const std::string& cache_key,
+                                                const CacheLookup& lookup) const {
+  const auto& policy = QueryCachePolicy::instance();
+  auto cached = tryLoadFromCache(cache_key, lookup.entry, lookup.generation, policy.staleWhileRevalidate());
+  if (cached && cached->fresh) {
     LOG_INFO("Hit cache for key {}", cache_key);
-    return SelectResult<T>{ cached.value() };
+    if (cached->rows.empty()) negative_cache::countQueryHit();
+    return SelectResult<T>{ std::move(cached->rows) };
+  }
+
+  // the generation is part of the flight key: a load started before a bump must not answer after it
+  const std::string flight_key = cache_key + ":" + lookup.generation;
+  if (cached && loads_.inFlight(flight_key)) {
+    LOG_INFO("Serving stale entry for key {} while it is refreshed", cache_key);
+    return SelectResult<T>{ std::move(cached->rows) };
   }
 
   LOG_INFO("Not hit cache for sql {}", sql.toStdString());
+  if (!policy.singleFlight()) return SelectResult<T>{ loadFromDatabase(sql, cache_key, lookup.generation) };
+  return SelectResult<T>{
+      loads_.run(flight_key, [&] { return loadFromDatabase(sql, cache_key, lookup.generation); }) };
+}
+
+template <EntityJson T>
+std::vector<T> SelectQuery<T>::loadFromDatabase(const QString& sql, const std::string& cache_key,
+                                                const std::string& generation) const {
+  PROFILE_SCOPE();
+  if (const auto lock_ttl = QueryCachePolicy::instance().lockTtl(); lock_ttl.count() > 0) {
+    if (!cache_.setIfAbsent(buildLoadLockKey(cache_key, generation), "1", lock_ttl)) {
+      if (auto rows = waitForPeer(cache_key, generation, lock_ttl)) return std::move(*rows);
+      LOG_WARN("No entry for key {} within the {} ms load lock, loading it here", cache_key, lock_ttl.count());
+    }
+  }
 
   auto execute_results = this->executor_->execute(sql, this->values_);
   if(!execute_results.query) {
     LOG_ERROR("query {} failed, reason - {}", sql.toStdString(), execute_results.error);
-    return SelectResult<T>{ std::vector<T>{ } };
+    return {};
   }
 
   LOG_INFO("query {} succeed", sql.toStdString());
   auto results = builder_.buildResults<T>(execute_results.query);
-  updateCache(cache_key, results);
+  updateCache(cache_key, generation, results);
 
   LOG_INFO("Results has {} size", results.size());
-  return SelectResult<T>{ results };
+  return results;
 }
 
 template <EntityJson T>
-void SelectQuery<T>::updateCache(const std::string& key, const std::vector<T>& results) const {
-  std::vector<std::string> entities_strings;
-  std::vector<std::string> entities_keys;
+std::optional<std::vector<T>> SelectQuery<T>::waitForPeer(const std::string& cache_key, const std::string& generation,
+                                                          std::chrono::milliseconds timeout) const {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  const auto poll = std::max(std::chrono::milliseconds{1}, timeout / 10);
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(poll);
+    auto cached = tryLoadFromCache(cache_key, cache_.get(cache_key), generation, std::chrono::milliseconds{0});
+    if (cached) return std::move(cached->rows);
+  }
+  return std::nullopt;
+}
 
-  for (const auto& entity : results) {
-    entities_strings.push_back(nlohmann::json(entity).dump());
-    std::string entity_key = EntityKey<T>::get(entity);
-    entities_keys.push_back(buildEntityKey(this->table_name_.toStdString(), entity_key));
+template <EntityJson T>
+SelectCursor<T> SelectQuery<T>::stream() const {
+  PROFILE_SCOPE();
+  QString sql = buildQuery();
+  auto execute_results = this->executor_->execute(sql, this->values_);
+  if (!execute_results.query) {
+    LOG_ERROR("query {} failed, reason - {}", sql.toStdString(), execute_results.error);
+    return SelectCursor<T>(nullptr, execute_results.error.empty() ? "Failed to execute" : execute_results.error);
+  }
+  return SelectCursor<T>(std::move(execute_results.query));
+}
+
+template <EntityJson T>
+void SelectQuery<T>::updateCache(const std::string& key, const std::string& generation,
+                                 const std::vector<T>& results) const {
+  if (results.empty()) {
+    // not-found answers get the short negative ttl; with it off they are not stored
+    if (const auto ttl = QueryCachePolicy::instance().negativeTtl(); ttl.count() > 0) {
+      cache_.setAsync(key, cache_codec::encodeQueryEntry(generation, nowMs(), results), ttl);
+    }
+    return;
   }
 
-  cache_.setPipelines(entities_keys, entities_strings, std::chrono::seconds{30});
-  cache_.set(key, nlohmann::json(results).dump(), std::chrono::seconds{30});
+  // the entry SET runs in the background, overlapping the caller's work. The rows are
+  // not copied to entity_cache: unlike the entry, those keys carry no generation, so
+  // a row read before a concurrent save or delete would overwrite the writer's update
+  cache_.setAsync(key, cache_codec::encodeQueryEntry(generation, nowMs(), results), std::chrono::seconds{30});
 }
 
 /*
@@ -139,14 +222,51 @@ QString SelectQuery<T>::buildQuery() const {
 }
 
 template <EntityJson T>
-auto SelectQuery<T>::getGenerations() const {
+std::vector<typename SelectQuery<T>::CacheLookup> SelectQuery<T>::loadGenerationsAndEntries(
+    ICacheService& cache, const std::vector<const SelectQuery<T>*>& queries,
+    const std::vector<std::string>& cache_keys) {
+  auto& snapshot = GenerationSnapshot::instance();
   std::unordered_map<std::string, std::string> generations;
-  for (const auto& table : this->involved_tables_) {
-    std::string key = std::string("table_generation:") + table.toStdString();
-    std::optional<std::string> string_ptr = cache_.get(key);
-    generations[table.toStdString()] = string_ptr ? *string_ptr : "0";
+  std::vector<std::string> fetched_tables;
+  std::vector<std::string> keys;
+
+  // a table, or one partition of it when the query filters on its partition column
+  std::vector<std::vector<std::string>> scopes;
+  scopes.reserve(queries.size());
+  for (const auto* query : queries) scopes.push_back(query->generationScopes());
+
+  for (const auto& query_scopes : scopes) {
+    for (std::string name : query_scopes) {
+      if (generations.contains(name)) continue;
+      if (auto generation = snapshot.find(name)) {
+        generations.emplace(std::move(name), *generation);
+      } else {
+        keys.push_back(GenerationSnapshot::cacheKey(name));
+        generations.emplace(name, "0");
+        fetched_tables.push_back(std::move(name));
+      }
+    }
+  }
+  keys.insert(keys.end(), cache_keys.begin(), cache_keys.end());
+
+  auto values = cache.getMany(keys);
+  values.resize(keys.size());
+  for (std::size_t i = 0; i < fetched_tables.size(); ++i) {
+    std::string generation = values[i].value_or("0");
+    snapshot.store(fetched_tables[i], generation);
+    generations[fetched_tables[i]] = std::move(generation);
+  }
+
+  std::vector<CacheLookup> lookups;
+  lookups.reserve(queries.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    // kept in involved_tables_ order: the stamp hashes the pairs in sequence
+    std::vector<std::pair<std::string, std::string>> stamp;
+    for (const auto& scope : scopes[i]) stamp.emplace_back(scope, generations[scope]);
+    lookups.push_back({.generation = hashGenerations(stamp),
+                       .entry = std::move(values[fetched_tables.size() + i])});
   }
-  return generations;
+  return lookups;
 }
 
 template <EntityJson T>
@@ -0,0 +1,55 @@
+#ifndef INL_SINGLEFLIGHT
+#define INL_SINGLEFLIGHT
+
+#include <exception>
+#include <utility>
+
+#include "SingleFlight.h"
+
+template <typename V>
+template <typename Load>
+V SingleFlight<V>::run(const std::string &key, Load &&load) {
+  std::promise<V> promise;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (auto it = flights_.find(key); it != flights_.end()) {
+      auto flight = it->second;
+      ++stats_.joined;
+      lock.unlock();
+      return flight.get();
+    }
+    flights_.emplace(key, promise.get_future().share());
+    ++stats_.loads;
+  }
+
+  // waiters hold their own copy of the future, so the key can go before the result is set
+  auto finish = [this, &key] {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flights_.erase(key);
+  };
+
+  try {
+    V value = std::forward<Load>(load)();
+    finish();
+    promise.set_value(value);
+    return value;
+  } catch (...) {
+    finish();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+template <typename V>
+bool SingleFlight<V>::inFlight(const std::string &key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return flights_.contains(key);
+}
+
+template <typename V>
+SingleFlightStats SingleFlight<V>::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+#endif  // INL_SINGLEFLIGHT
@@ -0,0 +1,60 @@
+#include "ConnectionPoolMetrics.h"
+
+namespace {
+
+const char *roleLabel(ConnectionRole role) { return role == ConnectionRole::Writer ? "writer" : "reader"; }
+
+}  // namespace
+
+ConnectionPoolMetrics::ConnectionPoolMetrics(std::shared_ptr<prometheus::Registry> registry, const std::string &db_name,
+                                             std::size_t pool_size)
+    : registry_(std::move(registry)) {
+  auto &wait_family = prometheus::BuildHistogram()
+                          .Name("sqlite_pool_wait_seconds")
+                          .Help("Time spent waiting for a pooled connection")
+                          .Register(*registry_);
+  auto &timeout_family = prometheus::BuildCounter()
+                             .Name("sqlite_pool_acquire_timeouts_total")
+                             .Help("Acquisitions that gave up after acquire_timeout")
+                             .Register(*registry_);
+  auto &in_use_family = prometheus::BuildGauge()
+                            .Name("sqlite_pool_in_use")
+                            .Help("Connections currently leased")
+                            .Register(*registry_);
+  auto &max_in_use_family = prometheus::BuildGauge()
+                                .Name("sqlite_pool_max_in_use")
+                                .Help("Most connections leased at once")
+                                .Register(*registry_);
+  auto &size_family =
+      prometheus::BuildGauge().Name("sqlite_pool_size").Help("Connections in the pool").Register(*registry_);
+
+  const prometheus::Histogram::BucketBoundaries buckets(wait_buckets_);
+  writer_wait_ = &wait_family.Add({{"db", db_name}, {"role", roleLabel(ConnectionRole::Writer)}}, buckets);
+  reader_wait_ = &wait_family.Add({{"db", db_name}, {"role", roleLabel(ConnectionRole::Reader)}}, buckets);
+  writer_timeouts_ = &timeout_family.Add({{"db", db_name}, {"role", roleLabel(ConnectionRole::Writer)}});
+  reader_timeouts_ = &timeout_family.Add({{"db", db_name}, {"role", roleLabel(ConnectionRole::Reader)}});
+  in_use_ = &in_use_family.Add({{"db", db_name}});
+  max_in_use_ = &max_in_use_family.Add({{"db", db_name}});
+  size_ = &size_family.Add({{"db", db_name}});
+  size_->Set(static_cast<double>(pool_size));
+}
+
+void ConnectionPoolMetrics::connectionAcquired(ConnectionRole role, std::chrono::nanoseconds waited,
+                                               std::size_t in_use) {
+  auto *wait = role == ConnectionRole::Writer ? writer_wait_ : reader_wait_;
+  wait->Observe(std::chrono::duration<double>(waited).count());
+  in_use_->Set(static_cast<double>(in_use));
+
+  std::size_t max = max_in_use_value_.load(std::memory_order_relaxed);
+  while (in_use > max && !max_in_use_value_.compare_exchange_weak(max, in_use, std::memory_order_relaxed)) {
+  }
+  if (in_use > max) max_in_use_->Set(static_cast<double>(in_use));
+}
+
+void ConnectionPoolMetrics::connectionReleased(ConnectionRole, std::size_t in_use) {
+  in_use_->Set(static_cast<double>(in_use));
+}
+
+void ConnectionPoolMetrics::acquireTimedOut(ConnectionRole role) {
+  (role == ConnectionRole::Writer ? writer_timeouts_ : reader_timeouts_)->Increment();
+}
@@ -0,0 +1,50 @@
+#include "GenerationSnapshot.h"
+
+#include <mutex>
+
+GenerationSnapshot &GenerationSnapshot::instance() {
+  static GenerationSnapshot inst;
+  return inst;
+}
+
+void GenerationSnapshot::setTtl(std::chrono::milliseconds ttl) {
+  ttl_ms_ = ttl.count();
+  if (ttl.count() <= 0) clear();
+}
+
+std::optional<std::string> GenerationSnapshot::find(const std::string &table) const {
+  const auto ttl = this->ttl();
+  if (ttl.count() <= 0) return std::nullopt;
+
+  std::shared_lock lock(mutex_);
+  auto it = entries_.find(table);
+  if (it == entries_.end() || std::chrono::steady_clock::now() - it->second.fetched_at > ttl) return std::nullopt;
+  return it->second.generation;
+}
+
+void GenerationSnapshot::store(const std::string &table, const std::string &generation) {
+  const auto ttl = this->ttl();
+  if (ttl.count() <= 0) return;
+
+  const auto now = std::chrono::steady_clock::now();
+  std::unique_lock lock(mutex_);
+  if (entries_.size() >= kMaxEntries && !entries_.contains(table)) {
+    purgeExpired(now, ttl);
+    if (entries_.size() >= kMaxEntries) return;
+  }
+  entries_[table] = Entry{generation, now};
+}
+
+void GenerationSnapshot::purgeExpired(std::chrono::steady_clock::time_point now, std::chrono::milliseconds ttl) {
+  std::erase_if(entries_, [&](const auto &entry) { return now - entry.second.fetched_at > ttl; });
+}
+
+void GenerationSnapshot::invalidate(const std::string &table) {
+  std::unique_lock lock(mutex_);
+  entries_.erase(table);
+}
+
+void GenerationSnapshot::clear() {
+  std::unique_lock lock(mutex_);
+  entries_.clear();
+}
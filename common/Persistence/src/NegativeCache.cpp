@@ -0,0 +1,31 @@
+#include "NegativeCache.h"
+
+#include <atomic>
+
+namespace {
+
+// cache_codec values start with their 0xCE magic byte and legacy JSON with '{'
+constexpr std::string_view kTombstonePrefix = "nil:";
+
+std::atomic<long long> query_hits{0};
+std::atomic<long long> entity_hits{0};
+
+}  // namespace
+
+std::string negative_cache::tombstone(const std::string &generation) {
+  return std::string(kTombstonePrefix) + generation;
+}
+
+std::optional<std::string_view> negative_cache::tombstoneGeneration(std::string_view value) {
+  if (!value.starts_with(kTombstonePrefix)) return std::nullopt;
+  return value.substr(kTombstonePrefix.size());
+}
+
+void negative_cache::countQueryHit() { query_hits.fetch_add(1, std::memory_order_relaxed); }
+
+void negative_cache::countEntityHit() { entity_hits.fetch_add(1, std::memory_order_relaxed); }
+
+NegativeCacheStats negative_cache::stats() {
+  return NegativeCacheStats{.query_hits = query_hits.load(std::memory_order_relaxed),
+                            .entity_hits = entity_hits.load(std::memory_order_relaxed)};
+}
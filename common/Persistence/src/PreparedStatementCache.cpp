@@ -0,0 +1,66 @@
+#include "PreparedStatementCache.h"
+
+PreparedStatementCache::PreparedStatementCache(std::size_t capacity) : capacity_(capacity) {}
+
+QString PreparedStatementCache::normalize(const QString &sql) {
+  // whitespace runs outside quotes collapse to one space; quoted literals and
+  // identifiers are kept as written, so 'a  b' and 'a b' stay different keys
+  QString normalized;
+  normalized.reserve(sql.size());
+  QChar quote;
+  bool pending_space = false;
+  for (const QChar c : sql) {
+    if (!quote.isNull()) {
+      normalized.append(c);
+      if (c == quote) quote = QChar();
+      continue;
+    }
+    if (c.isSpace()) {
+      pending_space = !normalized.isEmpty();
+      continue;
+    }
+    if (pending_space) normalized.append(' ');
+    pending_space = false;
+    if (c == '\'' || c == '"') quote = c;
+    normalized.append(c);
+  }
+  while (normalized.endsWith(';')) {
+    normalized.chop(1);
+    normalized = normalized.trimmed();
+  }
+  return normalized;
+}
+
+std::shared_ptr<QSqlQuery> PreparedStatementCache::find(const QString &normalized_sql) {
+  auto it = index_.find(normalized_sql);
+  if (it == index_.end()) return nullptr;
+
+  entries_.splice(entries_.begin(), entries_, it.value());
+  // only the cache owns an idle statement; otherwise a caller on this thread is still reading from it
+  if (entries_.front().second.use_count() != 1) return nullptr;
+  return entries_.front().second;
+}
+
+void PreparedStatementCache::insert(const QString &normalized_sql, std::shared_ptr<QSqlQuery> query) {
+  if (capacity_ == 0) return;
+
+  if (auto it = index_.find(normalized_sql); it != index_.end()) {
+    it.value()->second = std::move(query);
+    entries_.splice(entries_.begin(), entries_, it.value());
+    return;
+  }
+
+  entries_.emplace_front(normalized_sql, std::move(query));
+  index_.insert(normalized_sql, entries_.begin());
+
+  if (entries_.size() > capacity_) {
+    index_.remove(entries_.back().first);
+    entries_.pop_back();
+    ++evictions_;
+  }
+}
+
+void PreparedStatementCache::clear() {
+  index_.clear();
+  entries_.clear();
+}
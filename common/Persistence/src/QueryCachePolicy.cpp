@@ -0,0 +1,6 @@
+#include "QueryCachePolicy.h"
+
+QueryCachePolicy &QueryCachePolicy::instance() {
+  static QueryCachePolicy inst;
+  return inst;
+}
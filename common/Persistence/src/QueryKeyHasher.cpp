@@ -0,0 +1,196 @@
+#include "QueryKeyHasher.h"
+
+#include <QByteArray>
+#include <QMetaType>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint64_t kC1 = 0x87c37b91114253d5ULL;
+constexpr std::uint64_t kC2 = 0x4cf5ad432745937fULL;
+constexpr std::string_view kQueryCachePrefix = "query_cache:";
+
+inline std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline std::uint64_t fmix(std::uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+inline std::uint64_t mixK1(std::uint64_t k1) { return rotl(k1 * kC1, 31) * kC2; }
+
+inline std::uint64_t mixK2(std::uint64_t k2) { return rotl(k2 * kC2, 33) * kC1; }
+
+void appendHex(std::string &out, std::uint64_t value) {
+  constexpr char kDigits[] = "0123456789abcdef";
+  for (int shift = 60; shift >= 0; shift -= 4) out.push_back(kDigits[(value >> shift) & 0xF]);
+}
+
+}  // namespace
+
+std::string Hash128::toHex() const {
+  std::string hex;
+  hex.reserve(32);
+  appendHex(hex, high);
+  appendHex(hex, low);
+  return hex;
+}
+
+void StreamingHash128::block(const unsigned char *data) {
+  std::uint64_t k1 = 0;
+  std::uint64_t k2 = 0;
+  std::memcpy(&k1, data, 8);
+  std::memcpy(&k2, data + 8, 8);
+
+  h1_ ^= mixK1(k1);
+  h1_ = rotl(h1_, 27) + h2_;
+  h1_ = h1_ * 5 + 0x52dce729;
+
+  h2_ ^= mixK2(k2);
+  h2_ = rotl(h2_, 31) + h1_;
+  h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+void StreamingHash128::update(const void *data, std::size_t size) {
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  total_ += size;
+
+  if (tail_size_ > 0) {
+    const std::size_t take = std::min(size, tail_.size() - tail_size_);
+    std::memcpy(tail_.data() + tail_size_, bytes, take);
+    tail_size_ += take;
+    bytes += take;
+    size -= take;
+    if (tail_size_ < tail_.size()) return;
+    block(tail_.data());
+    tail_size_ = 0;
+  }
+
+  for (; size >= tail_.size(); bytes += tail_.size(), size -= tail_.size()) block(bytes);
+
+  std::memcpy(tail_.data(), bytes, size);
+  tail_size_ = size;
+}
+
+Hash128 StreamingHash128::finish() const {
+  std::uint64_t h1 = h1_;
+  std::uint64_t h2 = h2_;
+  std::uint64_t k1 = 0;
+  std::uint64_t k2 = 0;
+
+  for (std::size_t i = 0; i < tail_size_; ++i) {
+    if (i < 8) {
+      k1 |= static_cast<std::uint64_t>(tail_[i]) << (i * 8);
+    } else {
+      k2 |= static_cast<std::uint64_t>(tail_[i]) << ((i - 8) * 8);
+    }
+  }
+  if (tail_size_ > 8) h2 ^= mixK2(k2);
+  if (tail_size_ > 0) h1 ^= mixK1(k1);
+
+  h1 ^= total_;
+  h2 ^= total_;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  return Hash128{.low = h1, .high = h2};
+}
+
+void QueryKeyHasher::tag(Tag tag, std::uint64_t length) {
+  hash_.update(&tag, sizeof(tag));
+  hash_.update(&length, sizeof(length));
+}
+
+QueryKeyHasher &QueryKeyHasher::add(const QString &text) {
+  tag(Tag::Text, static_cast<std::uint64_t>(text.size()));
+  hash_.update(text.constData(), static_cast<std::size_t>(text.size()) * sizeof(QChar));
+  return *this;
+}
+
+QueryKeyHasher &QueryKeyHasher::add(std::string_view text) {
+  tag(Tag::Utf8, text.size());
+  hash_.update(text.data(), text.size());
+  return *this;
+}
+
+QueryKeyHasher &QueryKeyHasher::add(std::int64_t number) {
+  tag(Tag::Integer);
+  hash_.update(&number, sizeof(number));
+  return *this;
+}
+
+QueryKeyHasher &QueryKeyHasher::add(const QVariant &value) {
+  if (!value.isValid() || value.isNull()) {
+    tag(Tag::Null);
+    return *this;
+  }
+
+  switch (value.metaType().id()) {
+    case QMetaType::Bool:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+      return add(static_cast<std::int64_t>(value.toLongLong()));
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong: {
+      const std::uint64_t number = value.toULongLong();
+      tag(Tag::Unsigned);
+      hash_.update(&number, sizeof(number));
+      return *this;
+    }
+    case QMetaType::Float:
+    case QMetaType::Double: {
+      const double number = value.toDouble();
+      tag(Tag::Real);
+      hash_.update(&number, sizeof(number));
+      return *this;
+    }
+    case QMetaType::QString:
+      return add(value.toString());  // implicitly shared, no copy of the characters
+    case QMetaType::QByteArray: {
+      const QByteArray bytes = value.toByteArray();
+      tag(Tag::Bytes, static_cast<std::uint64_t>(bytes.size()));
+      hash_.update(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+      return *this;
+    }
+    default:
+      return add(value.toString());
+  }
+}
+
+std::string makeQueryCacheKey(const QString &sql, const QVector<QVariant> &params) {
+  QueryKeyHasher hasher;
+  hasher.add(sql);
+  hasher.add(static_cast<std::int64_t>(params.size()));
+  for (const auto &param : params) hasher.add(param);
+
+  std::string key;
+  key.reserve(kQueryCachePrefix.size() + 32);
+  key.append(kQueryCachePrefix);
+  const Hash128 hash = hasher.finish();
+  appendHex(key, hash.high);
+  appendHex(key, hash.low);
+  return key;
+}
+
+std::string hashGenerations(const std::vector<std::pair<std::string, std::string>> &generations) {
+  QueryKeyHasher hasher;
+  for (const auto &[table, generation] : generations) {
+    hasher.add(std::string_view(table)).add(std::string_view(generation));
+  }
+  return hasher.finish().toHex();
+}
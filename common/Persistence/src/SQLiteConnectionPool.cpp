@@ -0,0 +1,223 @@
+#include "SQLiteConnectionPool.h"
+
+#include <QtSql/QSqlError>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+
+#include "Debug_profiling.h"
+
+namespace {
+
+std::atomic<int> connection_serial{0};
+std::atomic<std::uint64_t> next_pool_id{1};
+
+bool isInMemory(const QString &db_name) { return db_name.isEmpty() || db_name.startsWith(":memory:"); }
+
+void close(std::unique_ptr<PooledConnection> &connection) {
+  if (!connection) return;
+  const QString name = connection->db.connectionName();
+  connection->statements.clear();
+  connection->db.close();
+  connection.reset();
+  QSqlDatabase::removeDatabase(name);
+}
+
+// the connections one thread opened for one pool; closed on that thread
+struct ThreadConnections {
+  ThreadConnections() = default;
+  ThreadConnections(const ThreadConnections &) = delete;
+  ThreadConnections &operator=(const ThreadConnections &) = delete;
+  ~ThreadConnections() {
+    close(reader);
+    close(writer);
+  }
+
+  std::weak_ptr<const bool> pool_alive;
+  std::unique_ptr<PooledConnection> writer;
+  std::unique_ptr<PooledConnection> reader;
+};
+
+// pools destroyed after the thread's connections are gone (function-local statics
+// on the main thread) have nothing left to close
+thread_local bool connections_destroyed = false;
+
+struct ConnectionRegistry {
+  ~ConnectionRegistry() { connections_destroyed = true; }
+
+  // by pool id, which is never reused, so a new pool cannot pick up a dead one's connections
+  std::unordered_map<std::uint64_t, ThreadConnections> pools;
+};
+
+std::unordered_map<std::uint64_t, ThreadConnections> &threadConnections() {
+  thread_local ConnectionRegistry registry;
+  return registry.pools;
+}
+
+}  // namespace
+
+ConnectionLease::~ConnectionLease() { release(); }
+
+ConnectionLease::ConnectionLease(ConnectionLease &&other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)), connection_(std::exchange(other.connection_, nullptr)) {}
+
+ConnectionLease &ConnectionLease::operator=(ConnectionLease &&other) noexcept {
+  if (this != &other) {
+    release();
+    pool_ = std::exchange(other.pool_, nullptr);
+    connection_ = std::exchange(other.connection_, nullptr);
+  }
+  return *this;
+}
+
+void ConnectionLease::release() {
+  if (pool_ && connection_) pool_->release(connection_);
+  pool_ = nullptr;
+  connection_ = nullptr;
+}
+
+SQLiteConnectionPool::SQLiteConnectionPool(const QString &db_name, const SQLiteProfile &profile, Options options)
+    : id_(next_pool_id.fetch_add(1)),
+      alive_(std::make_shared<const bool>(true)),
+      db_name_(db_name),
+      database_name_(db_name),
+      in_memory_(isInMemory(db_name)),
+      profile_(profile),
+      options_(options),
+      // shared-cache connections lock whole tables and fail with SQLITE_LOCKED instead
+      // of waiting, so an in-memory pool keeps the single writer slot
+      readers_(in_memory_ ? 0 : options_.readers),
+      free_readers_(readers_) {
+  // every plain ":memory:" connection would be a separate database, so the
+  // connections of this pool share one named in-memory database instead
+  if (in_memory_) database_name_ = QString("file:pool_memdb%1?mode=memory&cache=shared").arg(id_);
+
+  // the writer goes first: it creates the file and switches the journal mode. It
+  // stays open with the pool, which also keeps a shared in-memory database alive.
+  threadConnection(ConnectionRole::Writer);
+
+  stats_.size = 1 + readers_;
+  LOG_INFO("Connection pool for {} opened with 1 writer and {} readers", db_name_.toStdString(), readers_);
+}
+
+SQLiteConnectionPool::~SQLiteConnectionPool() {
+  alive_.reset();
+  // other threads close theirs when they exit or open a connection for another pool
+  if (!connections_destroyed) threadConnections().erase(id_);
+}
+
+PooledConnection &SQLiteConnectionPool::threadConnection(ConnectionRole role) {
+  auto &connections = threadConnections();
+  auto it = connections.find(id_);
+  if (it == connections.end()) {
+    std::erase_if(connections, [](const auto &entry) { return entry.second.pool_alive.expired(); });
+    it = connections.try_emplace(id_).first;
+    it->second.pool_alive = alive_;
+  }
+
+  auto &connection = role == ConnectionRole::Writer ? it->second.writer : it->second.reader;
+  if (!connection) {
+    connection = std::make_unique<PooledConnection>(open(role), role, options_.statement_cache_capacity);
+  }
+  return *connection;
+}
+
+QSqlDatabase SQLiteConnectionPool::open(ConnectionRole role) {
+  const bool read_only = role == ConnectionRole::Reader;
+  const QString name = QString("%1_pool%2_%3%4")
+                           .arg(db_name_)
+                           .arg(id_)
+                           .arg(QString(read_only ? "reader" : "writer"))
+                           .arg(connection_serial.fetch_add(1));
+
+  auto db = QSqlDatabase::addDatabase("QSQLITE", name);
+  db.setDatabaseName(database_name_);
+  if (in_memory_) {
+    db.setConnectOptions("QSQLITE_OPEN_URI");
+  } else if (read_only) {
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+  }
+  if (!db.open()) {
+    qFatal("Failed to open DB");
+  }
+  if (!profile_.apply(db, read_only)) {
+    LOG_WARN("Connection {} opened without full profile", name.toStdString());
+  }
+  return db;
+}
+
+QSqlDatabase SQLiteConnectionPool::writerDatabase() { return threadConnection(ConnectionRole::Writer).db; }
+
+ConnectionLease SQLiteConnectionPool::acquireWriter() { return acquire(ConnectionRole::Writer); }
+
+ConnectionLease SQLiteConnectionPool::acquireReader() {
+  return acquire(readers_ == 0 ? ConnectionRole::Writer : ConnectionRole::Reader);
+}
+
+ConnectionLease SQLiteConnectionPool::acquire(ConnectionRole role) {
+  const auto started = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  bool acquired = false;
+  if (role == ConnectionRole::Writer) {
+    if (writer_released_.wait_for(lock, options_.acquire_timeout, [this] { return writer_free_; })) {
+      writer_free_ = false;
+      acquired = true;
+    }
+  } else if (reader_released_.wait_for(lock, options_.acquire_timeout, [this] { return free_readers_ > 0; })) {
+    --free_readers_;
+    acquired = true;
+  }
+
+  if (!acquired) {
+    ++stats_.timeouts;
+    auto *observer = observer_;
+    lock.unlock();
+    LOG_ERROR("No {} connection freed up within {} ms", role == ConnectionRole::Writer ? "writer" : "reader",
+              options_.acquire_timeout.count());
+    if (observer) observer->acquireTimedOut(role);
+    return {};
+  }
+
+  const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+  ++stats_.acquisitions;
+  stats_.total_wait += waited;
+  stats_.max_wait = std::max(stats_.max_wait, waited);
+  stats_.max_in_use = std::max(stats_.max_in_use, ++stats_.in_use);
+  const std::size_t in_use = stats_.in_use;
+  auto *observer = observer_;
+  lock.unlock();
+
+  if (observer) observer->connectionAcquired(role, waited, in_use);
+  return {this, &threadConnection(role)};
+}
+
+void SQLiteConnectionPool::release(PooledConnection *connection) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (connection->role == ConnectionRole::Writer) {
+    writer_free_ = true;
+  } else {
+    ++free_readers_;
+  }
+  const std::size_t in_use = --stats_.in_use;
+  auto *observer = observer_;
+  lock.unlock();
+
+  if (connection->role == ConnectionRole::Writer) {
+    writer_released_.notify_one();
+  } else {
+    reader_released_.notify_one();
+  }
+  if (observer) observer->connectionReleased(connection->role, in_use);
+}
+
+ConnectionPoolStats SQLiteConnectionPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void SQLiteConnectionPool::setObserver(IConnectionPoolObserver *observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  observer_ = observer;
+}
@@ -1,12 +1,58 @@
 #include "SQLiteDataBase.h"
 
-#include <QThread>
+#include <QRegularExpression>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
+#include <unordered_map>
 
 #include "Debug_profiling.h"
+#include "PreparedStatementCache.h"
 
 namespace {
+
+enum class StatementKind { Read, Write, Begin, End };
+
+std::atomic<std::uint64_t> next_database_id{1};
+
+// databases destroyed after the thread's leases are gone (function-local statics
+// on the main thread) have nothing left to erase
+thread_local bool thread_leases_destroyed = false;
+
+// by database id, which is never reused
+struct ThreadLeases {
+  ~ThreadLeases() { thread_leases_destroyed = true; }
+
+  std::unordered_map<std::uint64_t, std::shared_ptr<ConnectionLease>> pinned;
+  std::unordered_map<std::uint64_t, std::weak_ptr<ConnectionLease>> readers;
+};
+
+ThreadLeases &threadLeases() {
+  thread_local ThreadLeases leases;
+  return leases;
+}
+
+// a WITH clause can lead into INSERT/UPDATE/DELETE; a keyword that only shows up in
+// a string literal just sends the read to the writer, which is harmless
+bool isPlainSelectWith(const QString &sql) {
+  static const QRegularExpression write_verb(R"(\b(INSERT|UPDATE|DELETE|REPLACE)\b)",
+                                             QRegularExpression::CaseInsensitiveOption);
+  return !write_verb.match(sql).hasMatch();
+}
+
+StatementKind classify(const QString &sql) {
+  const QString trimmed = sql.trimmed();
+  auto startsWith = [&trimmed](const char *verb) { return trimmed.startsWith(QLatin1String(verb), Qt::CaseInsensitive); };
+
+  if (startsWith("SELECT") || startsWith("EXPLAIN")) return StatementKind::Read;
+  if (startsWith("WITH")) return isPlainSelectWith(trimmed) ? StatementKind::Read : StatementKind::Write;
+  if (startsWith("BEGIN")) return StatementKind::Begin;
+  if (startsWith("COMMIT") || startsWith("END") ||
+      (startsWith("ROLLBACK") && !trimmed.contains(QLatin1String(" TO "), Qt::CaseInsensitive))) {
+    return StatementKind::End;
+  }
+  return StatementKind::Write;
+}
+
 const QString CREATE_USERS_TABLE = R"(
         CREATE TABLE IF NOT EXISTS users (
             id INTEGER PRIMARY KEY,
@@ -54,6 +100,11 @@ const QString CREATE_MESSAGES_TABLE = R"(
         );
     )";
 
+// keyset pagination of chat history: WHERE chat_id = ? AND id < ? ORDER BY id DESC
+const QString CREATE_MESSAGES_CHAT_INDEX = R"(
+    CREATE INDEX IF NOT EXISTS idx_messages_chat_id ON messages(chat_id, id DESC);
+)";
+
 const QString CREATE_MESSAGES_STATUS_TABLE = R"(
         CREATE TABLE IF NOT EXISTS messages_status (
             message_id INT,
@@ -64,6 +115,10 @@ const QString CREATE_MESSAGES_STATUS_TABLE = R"(
         );
     )";
 
+const QString CREATE_MESSAGES_STATUS_RECEIVER_INDEX = R"(
+    CREATE INDEX IF NOT EXISTS idx_messages_status_receiver ON messages_status(receiver_id, message_id);
+)";
+
 const QString CREATE_MESSAGES_REACTION_TABLE = R"(
         CREATE TABLE IF NOT EXISTS messages_reaction (
             message_id INTEGER,
@@ -138,7 +193,9 @@ const QString CREATE_OUTBOX_TABLE = R"(CREATE TABLE IF NOT EXISTS outbox (
 bool SQLiteDatabase::initializeSchema() {
   const std::vector<QString> tables = {CREATE_USERS_TABLE,
                                        CREATE_MESSAGES_TABLE,
+                                       CREATE_MESSAGES_CHAT_INDEX,
                                        CREATE_MESSAGES_STATUS_TABLE,
+                                       CREATE_MESSAGES_STATUS_RECEIVER_INDEX,
                                        CREATE_CHATS_TABLE,
                                        CREATE_CHAT_MEMBERS_TABLE,
                                        CREATE_CREDENTIALS_TABLE,
@@ -149,8 +206,10 @@ bool SQLiteDatabase::initializeSchema() {
                                        CREATE_MESSAGES_REACTION_TABLE,
                                        CREATE_MESSAGES_REACTION_INFO_TABLE};
 
+  auto lease = pool_->acquireWriter();
+  if (!lease) return false;
   for (const auto &sql : tables) {
-    if (!executeSql(db(), sql)) {
+    if (!executeSql(lease.db(), sql)) {
       return false;
     }
   }
@@ -170,58 +229,159 @@ bool SQLiteDatabase::executeSql(const QSqlDatabase &db, const QString &sql) {
 
 bool SQLiteDatabase::deleteTable(const QString &name) {
   const QString sql = QString("DROP TABLE IF EXISTS \"%1\"").arg(name);
-  bool res = executeSql(db(), sql);
+  auto lease = pool_->acquireWriter();
+  bool res = lease && executeSql(lease.db(), sql);
   if (res) LOG_WARN("Deleted table: {}", name.toStdString());
   return res;
 }
 
 bool SQLiteDatabase::tableExists(const QString &table_name) {
-  QSqlQuery query(db());
+  auto lease = pool_->acquireReader();
+  if (!lease) return false;
+  QSqlQuery query(lease.db());
   query.prepare("SELECT name FROM sqlite_master WHERE type='table' AND name=?;");
   query.addBindValue(table_name);
   if (!query.exec()) return false;
   return query.next();
 }
 
-QSqlDatabase SQLiteDatabase::db() const {
-  const QString conn = QString("%1_%2").arg(db_name_).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+SQLiteDatabase::SQLiteDatabase(QString db_name, SQLiteProfile profile, std::size_t statement_cache_capacity,
+                               std::size_t readers)
+    : id_(next_database_id.fetch_add(1)),
+      db_name_(std::move(db_name)),
+      profile_(std::move(profile)),
+      statement_cache_capacity_(statement_cache_capacity),
+      pool_(std::make_unique<SQLiteConnectionPool>(
+          db_name_, profile_,
+          SQLiteConnectionPool::Options{.readers = readers, .statement_cache_capacity = statement_cache_capacity})) {}
+
+SQLiteDatabase::~SQLiteDatabase() {
+  // only this thread's entries can be reached; a transaction left open on another
+  // thread is a bug of its own
+  if (thread_leases_destroyed) return;
+  unpin();
+  threadLeases().readers.erase(id_);
+}
+
+QSqlDatabase SQLiteDatabase::db() const { return pool_->writerDatabase(); }
 
-  if (!QSqlDatabase::contains(conn)) {
-    auto db = QSqlDatabase::addDatabase("QSQLITE", conn);
-    db.setDatabaseName(db_name_);
-    if (!db.open()) {
-      qFatal("Failed to open DB");
-    }
-    return db;
+std::shared_ptr<ConnectionLease> SQLiteDatabase::pinnedLease() const {
+  const auto &pinned = threadLeases().pinned;
+  auto it = pinned.find(id_);
+  return it == pinned.end() ? nullptr : it->second;
+}
+
+void SQLiteDatabase::pin(std::shared_ptr<ConnectionLease> lease) const {
+  threadLeases().pinned[id_] = std::move(lease);
+}
+
+void SQLiteDatabase::unpin() const { threadLeases().pinned.erase(id_); }
+
+std::shared_ptr<ConnectionLease> SQLiteDatabase::activeReader() const {
+  auto &readers = threadLeases().readers;
+  auto it = readers.find(id_);
+  if (it == readers.end()) return nullptr;
+  auto reader = it->second.lock();
+  if (!reader) readers.erase(it);
+  return reader;
+}
+
+void SQLiteDatabase::setActiveReader(const std::shared_ptr<ConnectionLease> &lease) const {
+  threadLeases().readers[id_] = lease;
+}
+
+std::shared_ptr<ConnectionLease> SQLiteDatabase::leaseFor(const QString &sql) {
+  const StatementKind kind = classify(sql);
+
+  if (auto pinned = pinnedLease()) {
+    if (kind == StatementKind::Begin) LOG_WARN("Nested transaction on {}", db_name_.toStdString());
+    // the COMMIT query itself keeps the writer until it is destroyed
+    if (kind == StatementKind::End) unpin();
+    return pinned;
   }
 
-  return QSqlDatabase::database(conn);
+  if (kind == StatementKind::Read) {
+    if (auto reader = activeReader()) return reader;
+  }
+
+  auto lease = std::make_shared<ConnectionLease>(kind == StatementKind::Read ? pool_->acquireReader()
+                                                                             : pool_->acquireWriter());
+  if (!*lease) return nullptr;
+  if (kind == StatementKind::Begin) pin(lease);
+  if (kind == StatementKind::Read) setActiveReader(lease);
+  return lease;
 }
 
 bool SQLiteDatabase::exec(const QString &sql) {
-  QSqlQuery q(db());
+  auto lease = leaseFor(sql);
+  if (!lease) return false;
+  QSqlQuery q(lease->db());
   LOG_INFO("To execute {}", sql.toStdString());
   if (!q.exec(sql)) {
     LOG_ERROR("For sql {} execute failed: {}", sql.toStdString(), q.lastError().text().toStdString());
+    if (classify(sql) == StatementKind::Begin) unpin();
     return false;
   }
   LOG_INFO("Execute succced, affected : {} rows", q.numRowsAffected());
   return true;
 }
 
-bool SQLiteDatabase::commit() { return db().commit(); }
+bool SQLiteDatabase::transaction() {
+  if (pinnedLease()) {
+    LOG_WARN("Nested transaction on {}", db_name_.toStdString());
+    return false;
+  }
+  auto lease = std::make_shared<ConnectionLease>(pool_->acquireWriter());
+  if (!*lease || !lease->db().transaction()) return false;
+  pin(std::move(lease));
+  return true;
+}
+
+bool SQLiteDatabase::commit() {
+  auto pinned = pinnedLease();
+  if (!pinned) return false;
+  bool ok = pinned->db().commit();
+  unpin();
+  return ok;
+}
+
+void SQLiteDatabase::rollback() {
+  auto pinned = pinnedLease();
+  if (!pinned) return;
+  pinned->db().rollback();
+  unpin();
+}
 
 std::unique_ptr<IQuery> SQLiteDatabase::prepare(const QString &sql) {
-  auto query = std::make_unique<SQLiteQuery>(db());  // TODO: factory??
+  auto lease = leaseFor(sql);
+  if (!lease) {
+    LOG_ERROR("No connection available for sql {}", sql.toStdString());
+    return nullptr;
+  }
+
+  auto &cache = lease->statements();
+  const QString key = PreparedStatementCache::normalize(sql);
+
+  if (statement_cache_capacity_ > 0) {
+    if (auto statement = cache.find(key)) {
+      ++statement_cache_hits_;
+      return std::make_unique<SQLiteQuery>(std::move(statement), std::move(lease));
+    }
+    ++statement_cache_misses_;
+  }
+
+  auto query = std::make_unique<SQLiteQuery>(lease->db(), lease);
   if (!query->prepare(sql)) {
     LOG_ERROR("For sql {} prepare failed: {}", sql.toStdString(), query->error().toStdString());
+    if (classify(sql) == StatementKind::Begin) unpin();
     return nullptr;
   }
+  if (statement_cache_capacity_ > 0) cache.insert(key, query->statement());
   return query;
 }
 
 std::unique_ptr<IQuery> SQLiteDatabase::prepare(const std::string &sql) { return prepare(QString::fromStdString(sql)); }
 
-void SQLiteDatabase::rollback() { db().rollback(); }
-
-bool SQLiteDatabase::transaction() { return db().transaction(); }
+StatementCacheStats SQLiteDatabase::statementCacheStats() const {
+  return StatementCacheStats{.hits = statement_cache_hits_.load(), .misses = statement_cache_misses_.load()};
+}
@@ -0,0 +1,29 @@
+#include "SQLiteProfile.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "Debug_profiling.h"
+
+QStringList SQLiteProfile::pragmas(bool read_only) const {
+  QStringList result;
+  if (!read_only) result << QString("PRAGMA journal_mode=%1").arg(journal_mode);
+  result << QString("PRAGMA synchronous=%1").arg(synchronous) << QString("PRAGMA mmap_size=%1").arg(mmap_size)
+         << QString("PRAGMA cache_size=%1").arg(cache_size) << QString("PRAGMA temp_store=%1").arg(temp_store)
+         << QString("PRAGMA busy_timeout=%1").arg(busy_timeout_ms);
+  if (!read_only) result << QString("PRAGMA wal_autocheckpoint=%1").arg(wal_autocheckpoint);
+  return result;
+}
+
+bool SQLiteProfile::apply(const QSqlDatabase &db, bool read_only) const {
+  bool ok = true;
+  QSqlQuery query(db);
+  for (const auto &pragma : pragmas(read_only)) {
+    if (!query.exec(pragma)) {
+      LOG_ERROR("'{}' failed on {}: {}", pragma.toStdString(), db.connectionName().toStdString(),
+                query.lastError().text().toStdString());
+      ok = false;
+    }
+  }
+  return ok;
+}
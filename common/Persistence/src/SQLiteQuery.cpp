@@ -1,28 +1,50 @@
 #include "query/SQLiteQuery.h"
 
-SQLiteQuery::SQLiteQuery(const QSqlDatabase &db) : q_(db) {}
+#include <QSqlRecord>
+
+#include "SQLiteConnectionPool.h"
+
+SQLiteQuery::SQLiteQuery(const QSqlDatabase &db, std::shared_ptr<ConnectionLease> lease)
+    : lease_(std::move(lease)), q_(std::make_shared<QSqlQuery>(db)) {}
+
+SQLiteQuery::SQLiteQuery(std::shared_ptr<QSqlQuery> prepared, std::shared_ptr<ConnectionLease> lease)
+    : lease_(std::move(lease)), q_(std::move(prepared)) {
+  // a cached statement may still hold the result set of its previous use
+  q_->finish();
+}
+
+SQLiteQuery::~SQLiteQuery() {
+  // release the sqlite statement so a cached copy does not keep a read transaction open
+  if (q_) q_->finish();
+}
 
 bool SQLiteQuery::prepare(const QString &sql) {
-  bool res = q_.prepare(sql);
+  bind_index_ = 0;
+  // we never seek back; without this Qt keeps every fetched row for random access
+  q_->setForwardOnly(true);
+  bool res = q_->prepare(sql);
   if (!res) {
-    LOG_ERROR("[SQLiteQuery] Prepare failed for sql {}: {}", sql.toStdString(), q_.lastError().text().toStdString());
+    LOG_ERROR("[SQLiteQuery] Prepare failed for sql {}: {}", sql.toStdString(), q_->lastError().text().toStdString());
   }
   return res;
 }
 
-void SQLiteQuery::bind(const QVariant &v) { q_.addBindValue(v); }
+void SQLiteQuery::bind(const QVariant &v) { q_->bindValue(bind_index_++, v); }
 
 bool SQLiteQuery::exec() {
-  bool res = q_.exec();
+  bool res = q_->exec();
+  bind_index_ = 0;
   // LOG_INFO("Exec : {}", res);
-  if (!res) LOG_INFO("Error {}", q_.lastError().text().toStdString());
+  if (!res) LOG_INFO("Error {}", q_->lastError().text().toStdString());
   return res;
 }
 
-bool SQLiteQuery::next() { return q_.next(); }
+bool SQLiteQuery::next() { return q_->next(); }
+
+QVariant SQLiteQuery::value(int i) const { return q_->value(i); }
 
-QVariant SQLiteQuery::value(int i) const { return q_.value(i); }
+QVariant SQLiteQuery::value(const std::string &field) const { return q_->value(QString::fromStdString(field)); }
 
-QVariant SQLiteQuery::value(const std::string &field) const { return q_.value(field); }
+int SQLiteQuery::indexOf(const std::string &field) const { return q_->record().indexOf(QString::fromStdString(field)); }
 
-QString SQLiteQuery::error() { return q_.lastError().text(); }
+QString SQLiteQuery::error() { return q_->lastError().text(); }
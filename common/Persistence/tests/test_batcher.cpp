@@ -0,0 +1,64 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Batcher.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct FlushLog {
+  std::mutex mutex;
+  std::vector<std::vector<int>> batches;
+  std::vector<std::chrono::steady_clock::time_point> flushed_at;
+
+  bool record(std::span<const int> rows) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    batches.emplace_back(rows.begin(), rows.end());
+    flushed_at.push_back(std::chrono::steady_clock::now());
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Test batcher groups rows into flushes") {
+  FlushLog log;
+
+  SECTION("Full batch expected flushed without waiting for max_delay") {
+    SaverBatcher<int> batcher([&log](std::span<const int> rows) { return log.record(rows); }, {},
+                              BatcherConfig{.max_batch_rows = 3, .max_delay = 10s});
+    for (int i = 1; i <= 3; ++i) REQUIRE(batcher.saveEntity(i));
+    batcher.flush();
+
+    REQUIRE(log.batches == std::vector<std::vector<int>>{{1, 2, 3}});
+  }
+
+  SECTION("Rows left after a partial take expected flushed max_delay after their own enqueue") {
+    // the first flush is slow, so rows 3-5 queue behind it; 3 and 4 go next as a full
+    // batch and 5 must not wait another max_delay counted from that take
+    constexpr auto kSlowFlush = 200ms;
+    constexpr auto kMaxDelay = 400ms;
+    SaverBatcher<int> batcher(
+        [&log, kSlowFlush](std::span<const int> rows) {
+          if (rows.front() == 1) std::this_thread::sleep_for(kSlowFlush);
+          return log.record(rows);
+        },
+        {}, BatcherConfig{.max_batch_rows = 2, .max_delay = kMaxDelay});
+
+    REQUIRE(batcher.saveEntity(1));
+    REQUIRE(batcher.saveEntity(2));
+    const auto queued_at = std::chrono::steady_clock::now();
+    for (int i = 3; i <= 5; ++i) REQUIRE(batcher.saveEntity(i));
+    while (batcher.pending() > 0) std::this_thread::sleep_for(5ms);
+    batcher.flush();
+
+    REQUIRE(log.batches == std::vector<std::vector<int>>{{1, 2}, {3, 4}, {5}});
+    REQUIRE(log.flushed_at.back() - queued_at < kMaxDelay + kSlowFlush / 2);
+  }
+}
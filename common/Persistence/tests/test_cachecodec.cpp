@@ -0,0 +1,96 @@
+#include <catch2/catch_all.hpp>
+
+#include "CacheCodec.h"
+#include "GenericRepository.h"
+#include "entities/Message.h"
+#include "entities/User.h"
+
+namespace {
+
+Message sampleMessage() {
+  Message message;
+  message.id = 42;
+  message.chat_id = 7;
+  message.sender_id = -3;
+  message.timestamp = 1'700'000'000'123;
+  message.text = std::string("hi\0there", 8);
+  message.local_id = "local-42";
+  message.answer_on = 41;
+  return message;
+}
+
+template <CacheFormat F>
+void requireRoundTrip() {
+  const Message message = sampleMessage();
+  Message without_answer = message;
+  without_answer.answer_on.reset();
+
+  auto decoded = cache_codec::decode<Message, F>(cache_codec::encode<Message, F>(message));
+  REQUIRE(decoded);
+  REQUIRE(decoded->id == message.id);
+  REQUIRE(decoded->sender_id == message.sender_id);
+  REQUIRE(decoded->timestamp == message.timestamp);
+  REQUIRE(decoded->text == message.text);
+  REQUIRE(decoded->local_id == message.local_id);
+  REQUIRE(decoded->answer_on == message.answer_on);
+
+  auto list = cache_codec::decodeList<Message, F>(
+      cache_codec::encode<Message, F>(std::vector<Message>{message, without_answer}));
+  REQUIRE(list);
+  REQUIRE(list->size() == 2);
+  REQUIRE_FALSE((*list)[1].answer_on.has_value());
+}
+
+}  // namespace
+
+TEST_CASE("Test cache codec round trips entities") {
+  SECTION("Json") { requireRoundTrip<CacheFormat::Json>(); }
+  SECTION("MessagePack") { requireRoundTrip<CacheFormat::MsgPack>(); }
+  SECTION("Fields") { requireRoundTrip<CacheFormat::Fields>(); }
+
+  SECTION("Fields expected the smallest value") {
+    const Message message = sampleMessage();
+    REQUIRE(cache_codec::encode<Message, CacheFormat::Fields>(message).size() <
+            cache_codec::encode<Message, CacheFormat::MsgPack>(message).size());
+    REQUIRE(cache_codec::encode<Message, CacheFormat::MsgPack>(message).size() <
+            cache_codec::encode<Message, CacheFormat::Json>(message).size());
+  }
+
+  SECTION("Query entry expected generation and write time readable before the rows") {
+    const std::string encoded = cache_codec::encodeQueryEntry("5f3a", 1234, std::vector<Message>{sampleMessage()});
+    auto view = cache_codec::readQueryEntry<Message>(encoded);
+    REQUIRE(view);
+    REQUIRE(view->generation == "5f3a");
+    REQUIRE(view->stored_at == 1234);
+    auto rows = cache_codec::decodeRows<Message>(view->rows);
+    REQUIRE(rows);
+    REQUIRE(rows->front().id == 42);
+  }
+}
+
+TEST_CASE("Test cache codec ignores values it did not write") {
+  const std::string encoded = cache_codec::encode(sampleMessage());
+
+  SECTION("Pre-codec JSON entry expected a miss") {
+    REQUIRE_FALSE(cache_codec::decode<Message>(reflection::toJson(sampleMessage()).dump()).has_value());
+  }
+
+  SECTION("Other format expected a miss") {
+    REQUIRE_FALSE(cache_codec::decode<Message, CacheFormat::Json>(encoded).has_value());
+  }
+
+  SECTION("Other entity schema expected a miss") {
+    REQUIRE(cache_codec::schemaVersion<Message>() != cache_codec::schemaVersion<User>());
+    REQUIRE_FALSE(cache_codec::decode<User>(encoded).has_value());
+  }
+
+  SECTION("Truncated value expected a miss") {
+    for (std::size_t size = 0; size < encoded.size(); ++size) {
+      REQUIRE_FALSE(cache_codec::decode<Message>(std::string_view(encoded).substr(0, size)).has_value());
+    }
+  }
+
+  SECTION("Trailing bytes expected a miss") {
+    REQUIRE_FALSE(cache_codec::decode<Message>(encoded + "x").has_value());
+  }
+}
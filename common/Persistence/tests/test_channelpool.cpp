@@ -0,0 +1,86 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include "ChannelPool.h"
+
+namespace {
+
+struct FakeChannel {
+  using ptr_t = std::shared_ptr<FakeChannel>;
+  int id;
+};
+
+ChannelPool<FakeChannel>::Options poolOptions(std::size_t size) {
+  return {.size = size, .acquire_timeout = std::chrono::milliseconds(20)};
+}
+
+}  // namespace
+
+TEST_CASE("Test channel pool reuses and replaces channels") {
+  int connects = 0;
+  bool broker_down = false;
+  auto factory = [&connects, &broker_down]() {
+    if (broker_down) throw std::runtime_error("connection refused");
+    return std::make_shared<FakeChannel>(FakeChannel{++connects});
+  };
+
+  SECTION("A released channel is reused instead of reconnecting") {
+    ChannelPool<FakeChannel> pool(factory, poolOptions(2));
+    for (int i = 0; i < 5; ++i) {
+      auto channel = pool.acquire();
+      REQUIRE(channel);
+      REQUIRE(channel->id == 1);
+    }
+
+    auto stats = pool.stats();
+    REQUIRE(connects == 1);
+    REQUIRE(stats.acquisitions == 5);
+    REQUIRE(stats.open == 1);
+    REQUIRE(stats.in_use == 0);
+  }
+
+  SECTION("No more than size channels are open and a busy pool times out") {
+    ChannelPool<FakeChannel> pool(factory, poolOptions(2));
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    REQUIRE(first->id != second->id);
+
+    REQUIRE_FALSE(pool.acquire());
+    REQUIRE(pool.stats().timeouts == 1);
+
+    first = {};
+    auto third = pool.acquire();
+    REQUIRE(third);
+    REQUIRE(connects == 2);
+  }
+
+  SECTION("An invalidated channel is replaced by a new connection") {
+    ChannelPool<FakeChannel> pool(factory, poolOptions(1));
+    {
+      auto channel = pool.acquire();
+      channel.invalidate();
+      REQUIRE_FALSE(channel);
+    }
+
+    auto channel = pool.acquire();
+    REQUIRE(channel->id == 2);
+    auto stats = pool.stats();
+    REQUIRE(stats.discarded == 1);
+    REQUIRE(stats.opened == 2);
+    REQUIRE(stats.open == 1);
+  }
+
+  SECTION("A failed connect gives its slot back") {
+    ChannelPool<FakeChannel> pool(factory, poolOptions(1));
+    broker_down = true;
+    REQUIRE_THROWS_AS(pool.acquire(), std::runtime_error);
+    REQUIRE(pool.stats().open == 0);
+
+    broker_down = false;
+    REQUIRE(pool.acquire());
+    REQUIRE(pool.stats().in_use == 0);
+  }
+}
@@ -1,7 +1,12 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <future>
+#include <thread>
+
 #include "GenericRepository.h"
+#include "NegativeCache.h"
 #include "entities/Chat.h"
 #include "entities/ChatMember.h"
 #include "entities/Message.h"
@@ -13,6 +18,27 @@
 #include "mocks/MockDatabase.h"
 #include "mocks/MockIdGenerator.h"
 
+namespace {
+
+// result rows with named columns, in whatever order the test gives them
+struct RowsQuery : IQuery {
+  std::vector<std::string> columns;
+  std::vector<QList<QVariant>> rows;
+  int current = -1;
+  void bind(const QVariant &) override {}
+  bool exec() override { return true; }
+  bool next() override { return ++current < static_cast<int>(rows.size()); }
+  QString error() override { return {}; }
+  QVariant value(int i) const override { return rows[current][i]; }
+  QVariant value(const std::string &) const override { return {}; }
+  int indexOf(const std::string &field) const override {
+    auto it = std::find(columns.begin(), columns.end(), field);
+    return it == columns.end() ? -1 : static_cast<int>(it - columns.begin());
+  }
+};
+
+}  // namespace
+
 TEST_CASE("Test saving entity in database") {
   MockQuery query;
   MockDatabase db;
@@ -176,7 +202,7 @@ TEST_CASE("Test integration with cache while saving") {
 
     auto user_from_cache = cache.get(entityKey);
     REQUIRE(user_from_cache != std::nullopt);
-    REQUIRE(nlohmann::json(user).dump() == *user_from_cache);
+    REQUIRE(cache_codec::encode(user) == *user_from_cache);
   }
 
   SECTION("Saved message_status with custom key exepected updated cache") {
@@ -194,9 +220,9 @@ TEST_CASE("Test integration with cache while saving") {
     REQUIRE(cache.getCalls(tableKey) == before_table + 1);
     REQUIRE(cache.getCalls(entityKey) == before_entity + 1);
 
-    auto json_from_cache = cache.get(entityKey);
-    REQUIRE(json_from_cache != std::nullopt);
-    REQUIRE(nlohmann::json(status).dump() == *json_from_cache);
+    auto cached = cache.get(entityKey);
+    REQUIRE(cached != std::nullopt);
+    REQUIRE(cache_codec::encode(status) == *cached);
   }
 
   SECTION("Saved user_credentials with custom key exepected updated cache") {
@@ -214,9 +240,9 @@ TEST_CASE("Test integration with cache while saving") {
     REQUIRE(cache.getCalls(tableKey) == before_table + 1);
     REQUIRE(cache.getCalls(entityKey) == before_entity + 1);
 
-    auto json_from_cache = cache.get(entityKey);
-    REQUIRE(json_from_cache != std::nullopt);
-    REQUIRE(nlohmann::json(credentials).dump() == *json_from_cache);
+    auto cached = cache.get(entityKey);
+    REQUIRE(cached != std::nullopt);
+    REQUIRE(cache_codec::encode(credentials) == *cached);
   }
 
   SECTION("Saved chat_members with custom key exepected updated cache") {
@@ -236,7 +262,7 @@ TEST_CASE("Test integration with cache while saving") {
 
     auto json = cache.get(entityKey);
     REQUIRE(json);
-    REQUIRE(nlohmann::json(member).dump() == *json);
+    REQUIRE(cache_codec::encode(member) == *json);
   }
 
   SECTION("Clear cache expected clear all data") {
@@ -252,3 +278,626 @@ TEST_CASE("Test integration with cache while saving") {
     REQUIRE_FALSE(cache.exists(entityKey));
   }
 }
+
+TEST_CASE("Save binds values in table column order") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+
+  SECTION("Save user expected insert over every users column") {
+    User user;
+    user.id = 6;
+    user.username = "roma";
+    user.email = "romanlobach@gmail.com";
+    user.tag = "roma222";
+
+    REQUIRE(rep.save(user));
+    REQUIRE(executor.lastSql == "INSERT OR REPLACE INTO users (id, username, email, tag) VALUES (?, ?, ?, ?)");
+    REQUIRE(executor.lastValues ==
+            QList<QVariant>{QVariant(6LL), QVariant("roma"), QVariant("romanlobach@gmail.com"), QVariant("roma222")});
+  }
+
+  SECTION("Save message without answer expected null answer_on") {
+    Message message(10, 2, 3, 1000, "text", "local");
+
+    REQUIRE(rep.save(message));
+    REQUIRE(executor.lastValues.size() == 7);
+    REQUIRE(executor.lastValues[1].toLongLong() == 2);
+    REQUIRE(executor.lastValues[3].toString() == "text");
+    REQUIRE(executor.lastValues[6].isNull());
+  }
+}
+
+TEST_CASE("Test saving batch of entities") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+
+  std::vector<ChatMember> members;
+  for (long long user_id = 1; user_id <= 3; ++user_id) {
+    ChatMember member;
+    member.chat_id = 7;
+    member.user_id = user_id;
+    members.push_back(member);
+  }
+
+  SECTION("Save batch expected one multi-row insert inside one transaction") {
+    REQUIRE(rep.saveAll(members));
+
+    REQUIRE(executor.last_sqls.size() == 3);
+    CHECK(executor.last_sqls[0] == "BEGIN IMMEDIATE");
+    CHECK(executor.last_sqls[1] == SqlBuilder::insertSql<ChatMember>(3).toStdString());
+    CHECK(executor.last_sqls[2] == "COMMIT");
+  }
+
+  SECTION("Save batch expected one cache pipeline and one generation bump") {
+    std::string tableKey = "table_generation:chat_members";
+    int before_table = cache.getCalls(tableKey);
+
+    REQUIRE(rep.saveAll(members));
+
+    REQUIRE(cache.set_pipeline_calls == 1);
+    REQUIRE(cache.set_calls == 0);
+    REQUIRE(cache.getCalls(tableKey) == before_table + 1);
+    auto json = cache.get("entity_cache:chat_members:7, 2");
+    REQUIRE(json);
+    REQUIRE(cache_codec::encode(members[1]) == *json);
+  }
+
+  SECTION("Save batch larger than parameter limit expected chunked inserts") {
+    const std::size_t chunk = SqlBuilder::batchSize<ChatMember>();
+    std::vector<ChatMember> many(chunk + 1, members.front());
+    for (std::size_t i = 0; i < many.size(); ++i) many[i].user_id = static_cast<long long>(i) + 1;
+
+    REQUIRE(rep.saveAll(many));
+
+    REQUIRE(executor.last_sqls.size() == 4);
+    CHECK(executor.last_sqls[1] == SqlBuilder::insertSql<ChatMember>(chunk).toStdString());
+    CHECK(executor.last_sqls[2] == SqlBuilder::insertSql<ChatMember>(1).toStdString());
+  }
+
+  SECTION("Save batch with invalid entity expected nothing executed") {
+    members[1].user_id = 0;
+    int before = executor.execute_calls;
+
+    REQUIRE_FALSE(rep.saveAll(members));
+    REQUIRE(executor.execute_calls == before);
+    REQUIRE(cache.set_pipeline_calls == 0);
+  }
+
+  SECTION("Failed execution expected untouched cache") {
+    executor.shouldFail = true;
+
+    REQUIRE_FALSE(rep.saveAll(members));
+    REQUIRE(cache.set_pipeline_calls == 0);
+  }
+}
+
+TEST_CASE("Test select query reads generations and cache entry in one round trip") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+
+  auto runJoinQuery = [&] {
+    auto query = QueryFactory::createSelect<Message>(&executor, cache);
+    query->join(MessageStatusTable::Table, MessageTable::Id, MessageStatusTable::fullField(MessageStatusTable::MessageId))
+        .where(MessageTable::ChatId, 1);
+    return query->execute();
+  };
+
+  SECTION("Cold query expected one getMany with the chat's generations, the status table's and the entry") {
+    runJoinQuery();
+
+    REQUIRE(cache.get_many_calls == 1);
+    REQUIRE(cache.last_get_many_keys.size() == 4);
+    REQUIRE(cache.last_get_many_keys[0] == "table_generation:messages:*");
+    REQUIRE(cache.last_get_many_keys[1] == "table_generation:messages:chat_id=1");
+    REQUIRE(cache.last_get_many_keys[2] == "table_generation:messages_status");
+    REQUIRE(cache.last_get_many_keys[3].starts_with("query_cache:"));
+  }
+
+  SECTION("Repeated query expected cache hit without executor call") {
+    runJoinQuery();
+    int executed = executor.execute_calls;
+
+    runJoinQuery();
+
+    REQUIRE(executor.execute_calls == executed);
+    REQUIRE(cache.get_many_calls == 2);
+  }
+
+  SECTION("Generation bump expected stale entry and a new database read") {
+    runJoinQuery();
+    int executed = executor.execute_calls;
+
+    cache.set("table_generation:messages_status", "1", std::chrono::seconds{30});
+    runJoinQuery();
+
+    REQUIRE(executor.execute_calls == executed + 1);
+  }
+
+  SECTION("Generation snapshot expected only the entry key on a warm query") {
+    struct SnapshotTtl {
+      SnapshotTtl() { GenerationSnapshot::instance().setTtl(std::chrono::seconds{10}); }
+      ~SnapshotTtl() { GenerationSnapshot::instance().setTtl(std::chrono::milliseconds{0}); }
+    } snapshot_ttl;
+    runJoinQuery();
+    runJoinQuery();
+
+    REQUIRE(cache.last_get_many_keys.size() == 1);
+    REQUIRE(cache.last_get_many_keys[0].starts_with("query_cache:"));
+
+    // a write through this process drops the snapshot for its table
+    MessageStatus status(1, 2, true, 10);
+    REQUIRE(rep.save(status));
+    runJoinQuery();
+    REQUIRE(cache.last_get_many_keys.size() == 2);
+    REQUIRE(cache.last_get_many_keys[0] == "table_generation:messages_status");
+  }
+}
+
+TEST_CASE("Test generation snapshot keeps a bounded number of scopes") {
+  struct SnapshotTtl {
+    SnapshotTtl() { GenerationSnapshot::instance().setTtl(std::chrono::seconds{10}); }
+    ~SnapshotTtl() { GenerationSnapshot::instance().setTtl(std::chrono::milliseconds{0}); }
+  } snapshot_ttl;
+  auto &snapshot = GenerationSnapshot::instance();
+  for (std::size_t i = 0; i < GenerationSnapshot::kMaxEntries; ++i) {
+    snapshot.store("messages:chat_id=" + std::to_string(i), "1");
+  }
+
+  SECTION("New scope expected not stored while every entry is fresh") {
+    snapshot.store("messages:chat_id=-1", "1");
+    REQUIRE_FALSE(snapshot.find("messages:chat_id=-1"));
+    REQUIRE(snapshot.find("messages:chat_id=0") == "1");
+  }
+
+  SECTION("Known scope expected still refreshed when full") {
+    snapshot.store("messages:chat_id=0", "2");
+    REQUIRE(snapshot.find("messages:chat_id=0") == "2");
+  }
+
+  SECTION("Invalidated scope expected to make room") {
+    snapshot.invalidate("messages:chat_id=0");
+    snapshot.store("messages:chat_id=-1", "1");
+    REQUIRE(snapshot.find("messages:chat_id=-1") == "1");
+  }
+}
+
+TEST_CASE("Test batch of select queries shares one cache round trip") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+
+  std::vector<std::unique_ptr<SelectQuery<MessageStatus>>> queries;
+  std::vector<const SelectQuery<MessageStatus> *> batch;
+  for (long long message_id = 1; message_id <= 3; ++message_id) {
+    queries.push_back(QueryFactory::createSelect<MessageStatus>(&executor, cache));
+    queries.back()->where(MessageStatusTable::MessageId, message_id);
+    batch.push_back(queries.back().get());
+  }
+
+  SECTION("Cold batch expected one getMany and one database read per query") {
+    auto results = SelectQuery<MessageStatus>::executeAll(batch);
+
+    REQUIRE(results.size() == 3);
+    REQUIRE(cache.get_many_calls == 1);
+    REQUIRE(cache.last_get_many_keys.size() == 4);
+    REQUIRE(cache.last_get_many_keys[0] == "table_generation:messages_status");
+    REQUIRE(cache.last_get_many_keys[1] != cache.last_get_many_keys[2]);
+    REQUIRE(executor.execute_calls == 3);
+  }
+
+  SECTION("Warm batch expected hits only") {
+    SelectQuery<MessageStatus>::executeAll(batch);
+    int executed = executor.execute_calls;
+
+    SelectQuery<MessageStatus>::executeAll(batch);
+
+    REQUIRE(executor.execute_calls == executed);
+    REQUIRE(cache.get_many_calls == 2);
+  }
+
+  SECTION("Empty batch expected no cache call") {
+    REQUIRE(SelectQuery<MessageStatus>::executeAll({}).empty());
+    REQUIRE(cache.get_many_calls == 0);
+  }
+}
+
+TEST_CASE("Test deleting batch of entities") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+  const std::vector<long long> ids{3, 5, 8};
+
+  SECTION("Delete batch expected one statement inside one transaction") {
+    REQUIRE(rep.deleteByIds<Message>(ids));
+
+    REQUIRE(executor.last_sqls.size() == 3);
+    CHECK(executor.last_sqls[0] == "BEGIN IMMEDIATE");
+    CHECK(executor.last_sqls[1] == "DELETE FROM messages WHERE id IN (?, ?, ?)");
+    CHECK(executor.last_sqls[2] == "COMMIT");
+  }
+
+  SECTION("Delete batch expected one cache removeMany and one generation bump") {
+    for (long long id : ids) cache.set("entity_cache:messages:" + std::to_string(id), "{}", std::chrono::seconds{30});
+    int before_table = cache.getCalls("table_generation:messages");
+
+    REQUIRE(rep.deleteByIds<Message>(ids));
+
+    REQUIRE(cache.remove_many_calls == 1);
+    REQUIRE(cache.getCalls("table_generation:messages") == before_table + 1);
+    REQUIRE_FALSE(cache.exists("entity_cache:messages:5"));
+  }
+
+  SECTION("Failed execution expected untouched cache") {
+    executor.shouldFail = true;
+
+    REQUIRE_FALSE(rep.deleteByIds<Message>(ids));
+    REQUIRE(cache.remove_many_calls == 0);
+  }
+}
+
+TEST_CASE("Test query cache generations scoped to a partition") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+
+  auto runChatQuery = [&](long long chat_id) {
+    auto query = QueryFactory::createSelect<Message>(&executor, cache);
+    query->where(MessageTable::ChatId, chat_id);
+    return query->execute();
+  };
+
+  auto makeMessage = [](long long id, long long chat_id) {
+    Message message;
+    message.id = id;
+    message.chat_id = chat_id;
+    message.sender_id = 1;
+    message.text = "text";
+    message.timestamp = 100;
+    message.local_id = "local" + std::to_string(id);
+    return message;
+  };
+
+  SECTION("Saved message expected table and own chat generations bumped") {
+    REQUIRE(rep.save(makeMessage(1, 2)));
+
+    REQUIRE(cache.getCalls("table_generation:messages") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages:chat_id=2") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages:*") == 0);
+  }
+
+  SECTION("Saved batch expected one bump per distinct chat in one round trip") {
+    const std::vector<Message> messages{makeMessage(1, 2), makeMessage(2, 2), makeMessage(3, 5)};
+    REQUIRE(rep.saveAll<Message>(messages));
+
+    REQUIRE(cache.incr_many_calls == 1);
+    REQUIRE(cache.getCalls("table_generation:messages") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages:chat_id=2") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages:chat_id=5") == 1);
+  }
+
+  SECTION("Bump of another chat expected cached page still served") {
+    runChatQuery(1);
+    int executed = executor.execute_calls;
+
+    cache.set("table_generation:messages:chat_id=2", "1", std::chrono::seconds{30});
+    cache.set("table_generation:messages", "1", std::chrono::seconds{30});
+    runChatQuery(1);
+    REQUIRE(executor.execute_calls == executed);
+
+    cache.set("table_generation:messages:*", "1", std::chrono::seconds{30});
+    runChatQuery(1);
+    REQUIRE(executor.execute_calls == executed + 1);
+  }
+
+  SECTION("Delete by id expected partition epoch bumped") {
+    REQUIRE(rep.deleteById<Message>(4));
+
+    REQUIRE(cache.getCalls("table_generation:messages") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages:*") == 1);
+  }
+
+  SECTION("Delete query expected partition bump only when it filters the partition column") {
+    auto by_receiver = QueryFactory::createDelete<MessageStatus>(&executor, cache);
+    by_receiver->where(MessageStatusTable::ReceiverId, 2);
+    by_receiver->execute();
+
+    REQUIRE(cache.getCalls("table_generation:messages_status:receiver_id=2") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages_status:*") == 0);
+
+    auto by_message = QueryFactory::createDelete<MessageStatus>(&executor, cache);
+    by_message->where(MessageStatusTable::MessageId, 3);
+    by_message->execute();
+
+    REQUIRE(cache.getCalls("table_generation:messages_status:*") == 1);
+    REQUIRE(cache.getCalls("table_generation:messages_status") == 2);
+  }
+
+  SECTION("Query without partition filter expected the table generation") {
+    auto query = QueryFactory::createSelect<Message>(&executor, cache);
+    query->where(MessageTable::SenderId, 1);
+    query->execute();
+
+    REQUIRE(cache.last_get_many_keys.size() == 2);
+    REQUIRE(cache.last_get_many_keys[0] == "table_generation:messages");
+  }
+}
+
+TEST_CASE("Test query cache refill policies") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+
+  auto runJoinQuery = [&](ISqlExecutor *query_executor) {
+    auto query = QueryFactory::createSelect<Message>(query_executor, cache);
+    query->join(MessageStatusTable::Table, MessageTable::Id,
+                MessageStatusTable::fullField(MessageStatusTable::MessageId))
+        .where(MessageTable::ChatId, 1);
+    auto result = query->execute();
+    return QueryFactory::getSelectResult(result).result;
+  };
+
+  SECTION("Load lock expected one SET NX per miss") {
+    struct LockTtl {
+      LockTtl() { QueryCachePolicy::instance().setLockTtl(std::chrono::milliseconds{20}); }
+      ~LockTtl() { QueryCachePolicy::instance().setLockTtl(std::chrono::milliseconds{0}); }
+    } lock_ttl;
+    runJoinQuery(&executor);
+
+    REQUIRE(cache.set_if_absent_calls == 1);
+    REQUIRE(executor.execute_calls == 1);
+
+    // the entry is gone but the lock of this generation is still held: the query
+    // waits for the lock ttl, finds no entry and loads by itself
+    cache.remove(cache.last_get_many_keys.back());
+    runJoinQuery(&executor);
+
+    REQUIRE(cache.set_if_absent_calls == 2);
+    REQUIRE(executor.execute_calls == 2);
+  }
+
+  SECTION("Stale entry expected served while another caller refreshes it") {
+    struct StaleWindow {
+      StaleWindow() { QueryCachePolicy::instance().setStaleWhileRevalidate(std::chrono::seconds{10}); }
+      ~StaleWindow() { QueryCachePolicy::instance().setStaleWhileRevalidate(std::chrono::milliseconds{0}); }
+    } stale_window;
+
+    runJoinQuery(&executor);
+    const std::string entry_key = cache.last_get_many_keys.back();
+    Message message;
+    message.id = 7;
+    message.chat_id = 1;
+    const std::string encoded = *cache.get(entry_key);
+    auto entry = cache_codec::readQueryEntry<Message>(encoded);
+    REQUIRE(entry);
+    auto stale_rows = cache_codec::encodeQueryEntry(entry->generation, entry->stored_at, std::vector<Message>{message});
+    cache.set(entry_key, stale_rows, std::chrono::seconds{30});
+    cache.set("table_generation:messages:chat_id=1", "1", std::chrono::seconds{30});
+
+    struct GatedExecutor : FakeSqlExecutor {
+      std::promise<void> entered;
+      std::promise<void> release;
+      SqlExecutorResult execute(const QString &sql, const QList<QVariant> &values) override {
+        entered.set_value();
+        release.get_future().wait();
+        return FakeSqlExecutor::execute(sql, values);
+      }
+    } refresher;
+    std::vector<Message> refreshed{message};
+    std::thread refresh([&] { refreshed = runJoinQuery(&refresher); });
+    refresher.entered.get_future().wait();
+
+    auto stale = runJoinQuery(&executor);
+    REQUIRE(stale.size() == 1);
+    REQUIRE(stale[0].id == 7);
+    REQUIRE(executor.execute_calls == 1);
+
+    refresher.release.set_value();
+    refresh.join();
+    REQUIRE(refresher.execute_calls == 1);
+    REQUIRE(refreshed.empty());
+  }
+
+  SECTION("Stale entry without a refresh in flight expected database read") {
+    runJoinQuery(&executor);
+    cache.set("table_generation:messages:chat_id=1", "1", std::chrono::seconds{30});
+    runJoinQuery(&executor);
+
+    REQUIRE(executor.execute_calls == 2);
+  }
+}
+
+TEST_CASE("Test finding entities by id through the entity cache") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+  GenericRepository rep(&executor, cache);
+
+  auto makeUser = [](long long id) {
+    User user;
+    user.id = id;
+    user.username = "name" + std::to_string(id);
+    user.email = "user" + std::to_string(id) + "@mail.com";
+    user.tag = "tag" + std::to_string(id);
+    return user;
+  };
+  REQUIRE(rep.save(makeUser(1)));
+  REQUIRE(rep.save(makeUser(2)));
+  const int executed = executor.execute_calls;
+
+  SECTION("Cached entity expected findOne without executor call") {
+    auto user = rep.findOne<User>(2);
+
+    REQUIRE(user);
+    REQUIRE(user->tag == "tag2");
+    REQUIRE(executor.execute_calls == executed);
+    REQUIRE(cache.get_many_calls == 1);
+  }
+
+  SECTION("Partial hit expected one getMany and one query for the missing ids only") {
+    const std::vector<long long> ids{2, 3, 1, 2, 4};
+    auto users = rep.findMany<User>(ids);
+
+    REQUIRE(cache.get_many_calls == 1);
+    REQUIRE(cache.last_get_many_keys ==
+            std::vector<std::string>{"table_generation:users", "entity_cache:users:2", "entity_cache:users:3",
+                                     "entity_cache:users:1", "entity_cache:users:4"});
+    REQUIRE(executor.execute_calls == executed + 1);
+    REQUIRE(executor.lastSql.toStdString() == "SELECT * FROM users WHERE id IN (?, ?)");
+    REQUIRE(executor.lastValues == QList<QVariant>{3, 4});
+    REQUIRE(users.size() == 2);
+    REQUIRE(users[0].id == 2);
+    REQUIRE(users[1].id == 1);
+  }
+
+  SECTION("Value the codec cannot read expected a database read") {
+    cache.set("entity_cache:users:1", reflection::toJson(makeUser(1)).dump(), std::chrono::seconds{30});
+    rep.findOne<User>(1);
+
+    REQUIRE(executor.execute_calls == executed + 1);
+    REQUIRE(executor.lastValues == QList<QVariant>{1});
+  }
+
+  SECTION("Deleted entity expected its entry gone and a database read") {
+    REQUIRE(rep.deleteById<User>(1));
+    const int after_delete = executor.execute_calls;
+
+    REQUIRE_FALSE(rep.findOne<User>(1).has_value());
+    REQUIRE(executor.execute_calls == after_delete + 1);
+  }
+
+  SECTION("Empty id list expected no cache call") {
+    REQUIRE(rep.findMany<User>(std::vector<long long>{}).empty());
+    REQUIRE(cache.get_many_calls == 0);
+  }
+
+  SECTION("Missing id expected a tombstone and no second database read") {
+    const auto before = negative_cache::stats().entity_hits;
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+    REQUIRE(executor.execute_calls == executed + 1);
+    REQUIRE(cache.get("entity_cache:users:9") == negative_cache::tombstone("0"));
+
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+    REQUIRE(executor.execute_calls == executed + 1);
+    REQUIRE(negative_cache::stats().entity_hits == before + 1);
+  }
+
+  SECTION("Saved entity expected to replace its tombstone") {
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+    REQUIRE(rep.save(makeUser(9)));
+    const int after_save = executor.execute_calls;
+
+    auto user = rep.findOne<User>(9);
+    REQUIRE(user);
+    REQUIRE(user->tag == "tag9");
+    REQUIRE(executor.execute_calls == after_save);
+  }
+
+  SECTION("Tombstone of an older table generation expected a database read") {
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+    cache.set("table_generation:users", "1", std::chrono::seconds{30});
+
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+    REQUIRE(executor.execute_calls == executed + 2);
+    REQUIRE(cache.get("entity_cache:users:9") == negative_cache::tombstone("1"));
+  }
+
+  SECTION("Negative ttl off expected no generation key and no tombstone") {
+    struct NegativeOff {
+      NegativeOff() { QueryCachePolicy::instance().setNegativeTtl(std::chrono::seconds{0}); }
+      ~NegativeOff() { QueryCachePolicy::instance().setNegativeTtl(std::chrono::seconds{5}); }
+    } negative_off;
+    REQUIRE_FALSE(rep.findOne<User>(9).has_value());
+
+    REQUIRE(cache.last_get_many_keys == std::vector<std::string>{"entity_cache:users:9"});
+    REQUIRE_FALSE(cache.exists("entity_cache:users:9"));
+  }
+}
+
+TEST_CASE("Test empty query results are cached for the negative ttl") {
+  MockCache cache;
+  FakeSqlExecutor executor;
+
+  auto findByEmail = [&] {
+    auto query = QueryFactory::createSelect<User>(&executor, cache);
+    query->where(UserTable::Email, "nobody@mail.com");
+    auto result = query->execute();
+    return QueryFactory::getSelectResult(result).result;
+  };
+
+  SECTION("Repeated lookup expected one database read and a negative hit") {
+    const auto before = negative_cache::stats().query_hits;
+    REQUIRE(findByEmail().empty());
+    REQUIRE(findByEmail().empty());
+
+    REQUIRE(executor.execute_calls == 1);
+    REQUIRE(negative_cache::stats().query_hits == before + 1);
+  }
+
+  SECTION("Negative ttl off expected every lookup to read the database") {
+    struct NegativeOff {
+      NegativeOff() { QueryCachePolicy::instance().setNegativeTtl(std::chrono::seconds{0}); }
+      ~NegativeOff() { QueryCachePolicy::instance().setNegativeTtl(std::chrono::seconds{5}); }
+    } negative_off;
+    findByEmail();
+    findByEmail();
+
+    REQUIRE(executor.execute_calls == 2);
+  }
+}
+
+TEST_CASE("Test entity cache leaves rows loaded from the database to the write paths") {
+  struct RowsExecutor : ISqlExecutor {
+    std::vector<QList<QVariant>> rows;
+    int execute_calls = 0;
+    SqlExecutorResult execute(const QString &, const QList<QVariant> &) override {
+      ++execute_calls;
+      auto query = std::make_unique<RowsQuery>();
+      query->columns = {"id", "username", "email", "tag"};
+      query->rows = rows;
+      return SqlExecutorResult(std::move(query));
+    }
+  } executor;
+  executor.rows = {{5, "five", "five@mail.com", "tag5"}};
+  MockCache cache;
+
+  auto users = entity_cache::findByIds<User>(&executor, cache, std::vector<long long>{5});
+  REQUIRE(users.size() == 1);
+  REQUIRE(users[0].email == "five@mail.com");
+  REQUIRE(cache.set_many_calls == 0);
+  REQUIRE_FALSE(cache.exists("entity_cache:users:5"));
+
+  // a delete racing the read: the row it loaded must not come back from the cache
+  executor.rows.clear();
+  users = entity_cache::findByIds<User>(&executor, cache, std::vector<long long>{5});
+  REQUIRE(users.empty());
+  REQUIRE(executor.execute_calls == 2);
+}
+
+TEST_CASE("Test rows are read by column name") {
+  auto query = std::make_unique<RowsQuery>();
+  SqlBuilder builder;
+
+  SECTION("Columns in another order than the entity fields expected matched by name") {
+    query->columns = {"tag", "email", "username", "id"};
+    query->rows = {{"tag5", "five@mail.com", "five", 5}, {"tag6", "six@mail.com", "six", 6}};
+    std::unique_ptr<IQuery> result = std::move(query);
+    auto users = builder.buildResults<User>(result);
+
+    REQUIRE(users.size() == 2);
+    REQUIRE(users[1].id == 6);
+    REQUIRE(users[1].username == "six");
+    REQUIRE(users[1].email == "six@mail.com");
+    REQUIRE(users[1].tag == "tag6");
+  }
+
+  SECTION("Column missing from the result expected default value") {
+    query->columns = {"id", "email"};
+    query->rows = {{7, "seven@mail.com"}};
+    std::unique_ptr<IQuery> result = std::move(query);
+    auto users = builder.buildResults<User>(result);
+
+    REQUIRE(users.size() == 1);
+    REQUIRE(users[0].email == "seven@mail.com");
+    REQUIRE(users[0].username.empty());
+  }
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_all.hpp>
+
+#include <string>
+#include <thread>
+
+#include "LocalCache.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+LocalCacheConfig exactTtl(std::size_t shards = 4, std::size_t max_bytes = 1024 * 1024) {
+  return LocalCacheConfig{.shards = shards, .max_bytes = max_bytes, .ttl_policy = TtlPolicy(TtlRule{.jitter = 0.0})};
+}
+
+}  // namespace
+
+TEST_CASE("Test local cache basic operations") {
+  LocalCache cache(exactTtl());
+
+  cache.set("query_cache:1", "rows", 60s);
+  REQUIRE(cache.get("query_cache:1") == "rows");
+  REQUIRE_FALSE(cache.get("missing").has_value());
+
+  SECTION("getMany keeps the order of the keys") {
+    cache.set("query_cache:2", "more rows", 60s);
+    auto values = cache.getMany({"query_cache:2", "missing", "query_cache:1"});
+    REQUIRE(values.size() == 3);
+    REQUIRE(values[0] == "more rows");
+    REQUIRE_FALSE(values[1].has_value());
+    REQUIRE(values[2] == "rows");
+  }
+
+  SECTION("incr starts at 1 and keeps counting") {
+    cache.incr("table_generation:messages");
+    cache.incr("table_generation:messages");
+    REQUIRE(cache.get("table_generation:messages") == "2");
+  }
+
+  SECTION("incr leaves a non integer value untouched") {
+    cache.incr("query_cache:1");
+    REQUIRE(cache.get("query_cache:1") == "rows");
+  }
+
+  SECTION("setIfAbsent only writes missing keys") {
+    REQUIRE(cache.setIfAbsent("lock:1", "a", 60'000ms));
+    REQUIRE_FALSE(cache.setIfAbsent("lock:1", "b", 60'000ms));
+    REQUIRE(cache.get("lock:1") == "a");
+  }
+
+  SECTION("remove, removeMany and clearCache drop keys") {
+    cache.set("query_cache:2", "more rows", 60s);
+    cache.remove("query_cache:1");
+    REQUIRE_FALSE(cache.get("query_cache:1").has_value());
+    cache.removeMany({"query_cache:2"});
+    REQUIRE_FALSE(cache.get("query_cache:2").has_value());
+
+    cache.incr("table_generation:messages");
+    cache.clearCache();
+    auto stats = cache.stats();
+    REQUIRE(stats.entries == 0);
+    REQUIRE(stats.bytes == 0);
+  }
+}
+
+TEST_CASE("Test local cache expires keys after their ttl") {
+  LocalCache cache(exactTtl());
+
+  REQUIRE(cache.setIfAbsent("lock:1", "a", 20ms));
+  std::this_thread::sleep_for(50ms);
+
+  REQUIRE_FALSE(cache.get("lock:1").has_value());
+  REQUIRE(cache.setIfAbsent("lock:1", "b", 20ms));
+  REQUIRE(cache.stats().expirations == 1);
+}
+
+TEST_CASE("Test local cache evicts only keys with a ttl") {
+  // one shard with room for a handful of entries
+  LocalCache cache(exactTtl(1, 1024));
+
+  cache.incr("table_generation:messages");
+  for (int i = 0; i < 50; ++i) cache.set("query_cache:" + std::to_string(i), std::string(64, 'x'), 60s);
+
+  auto stats = cache.stats();
+  REQUIRE(stats.evictions > 0);
+  REQUIRE(stats.bytes <= 1024);
+  REQUIRE(cache.get("table_generation:messages") == "1");
+  REQUIRE(cache.get("query_cache:49").has_value());
+  REQUIRE_FALSE(cache.get("query_cache:0").has_value());
+
+  SECTION("Recently read keys outlive colder ones") {
+    cache.get("query_cache:48");
+    cache.set("query_cache:50", std::string(64, 'x'), 60s);
+    cache.set("query_cache:51", std::string(64, 'x'), 60s);
+    REQUIRE(cache.get("query_cache:48").has_value());
+  }
+}
@@ -0,0 +1,175 @@
+#include <catch2/catch_all.hpp>
+
+#include <thread>
+
+#include "NearCache.h"
+#include "mocks/MockCache.h"
+
+TEST_CASE("Test near cache serves repeated reads from L1") {
+  MockCache remote;
+  remote.set("table_generation:messages", "3");
+  NearCache cache(remote);
+
+  REQUIRE(cache.get("table_generation:messages") == "3");
+  REQUIRE(cache.get("table_generation:messages") == "3");
+  REQUIRE(remote.get_calls == 1);
+
+  auto stats = cache.stats();
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.entries == 1);
+  REQUIRE(stats.bytes > 0);
+
+  SECTION("Misses are not kept") {
+    REQUIRE_FALSE(cache.get("missing").has_value());
+    REQUIRE_FALSE(cache.get("missing").has_value());
+    REQUIRE(remote.get_calls == 3);
+  }
+
+  SECTION("getMany only asks the remote cache for keys missing in L1") {
+    remote.set("query_cache:1", "rows");
+    auto values = cache.getMany({"table_generation:messages", "query_cache:1"});
+    REQUIRE(values[0] == "3");
+    REQUIRE(values[1] == "rows");
+    REQUIRE(remote.last_get_many_keys == std::vector<std::string>{"query_cache:1"});
+
+    values = cache.getMany({"table_generation:messages", "query_cache:1"});
+    REQUIRE(values[1] == "rows");
+    REQUIRE(remote.get_many_calls == 1);
+  }
+
+  SECTION("getAsync answers an L1 hit without the remote cache") {
+    auto value = cache.getAsync("table_generation:messages");
+    REQUIRE(value.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+    REQUIRE(value.get() == "3");
+    REQUIRE(remote.get_calls == 1);
+    REQUIRE(remote.get_many_calls == 0);
+  }
+
+  SECTION("getAsync forwards a miss and keeps the fetched value") {
+    remote.set("query_cache:1", "rows");
+    REQUIRE(cache.getAsync("query_cache:1").get() == "rows");
+    REQUIRE(remote.last_get_many_keys == std::vector<std::string>{"query_cache:1"});
+
+    REQUIRE(cache.getAsync("query_cache:1").get() == "rows");
+    REQUIRE(remote.get_many_calls == 1);
+  }
+
+  SECTION("getManyAsync only asks the remote cache for keys missing in L1") {
+    remote.set("query_cache:1", "rows");
+    auto values = cache.getManyAsync({"table_generation:messages", "query_cache:1"}).get();
+    REQUIRE(values[0] == "3");
+    REQUIRE(values[1] == "rows");
+    REQUIRE(remote.last_get_many_keys == std::vector<std::string>{"query_cache:1"});
+
+    auto hits = cache.getManyAsync({"table_generation:messages", "query_cache:1"});
+    REQUIRE(hits.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+    REQUIRE(hits.get()[1] == "rows");
+    REQUIRE(remote.get_many_calls == 1);
+  }
+}
+
+TEST_CASE("Test near cache drops L1 copies on local changes") {
+  MockCache remote;
+  remote.set("table_generation:messages", "3");
+  NearCache cache(remote);
+  std::vector<std::string> published;
+  int publishes = 0;
+  cache.setPublisher([&](const std::vector<std::string> &keys) {
+    ++publishes;
+    published.insert(published.end(), keys.begin(), keys.end());
+  });
+  REQUIRE(cache.get("table_generation:messages") == "3");
+
+  SECTION("incr") {
+    cache.incr("table_generation:messages");
+    remote.set("table_generation:messages", "4");
+    REQUIRE(cache.get("table_generation:messages") == "4");
+    REQUIRE(published == std::vector<std::string>{"table_generation:messages"});
+  }
+
+  SECTION("remove") {
+    cache.remove("table_generation:messages");
+    REQUIRE_FALSE(cache.get("table_generation:messages").has_value());
+    REQUIRE(published == std::vector<std::string>{"table_generation:messages"});
+  }
+
+  SECTION("set writes through and keeps the new value") {
+    cache.set("table_generation:messages", "5", std::chrono::seconds{30});
+    REQUIRE(remote.exists("table_generation:messages"));
+    const int gets = remote.get_calls;
+    REQUIRE(cache.get("table_generation:messages") == "5");
+    REQUIRE(remote.get_calls == gets);
+  }
+
+  SECTION("setAsync updates L1 at once and writes through") {
+    auto done = cache.setAsync("table_generation:messages", "6", std::chrono::seconds{30});
+    REQUIRE(cache.get("table_generation:messages") == "6");
+    done.wait();
+    REQUIRE(remote.get("table_generation:messages") == "6");
+    REQUIRE(published == std::vector<std::string>{"table_generation:messages"});
+  }
+
+  SECTION("setMany and removeMany keep L1 in step") {
+    cache.setMany({{.key = "table_generation:messages", .value = "7", .ttl = std::chrono::seconds{30}},
+                   {.key = "table_generation:chats", .value = "2", .ttl = std::chrono::seconds{30}}});
+    REQUIRE(remote.set_many_calls == 1);
+    REQUIRE(cache.get("table_generation:chats") == "2");
+
+    cache.removeMany({"table_generation:messages", "table_generation:chats"});
+    REQUIRE(remote.remove_many_calls == 1);
+    REQUIRE_FALSE(cache.get("table_generation:messages").has_value());
+    REQUIRE(published.size() == 4);
+    REQUIRE(publishes == 2);  // one message per call, not per key
+  }
+
+  SECTION("invalidation from another instance") {
+    remote.set("table_generation:messages", "9");
+    cache.invalidate("table_generation:messages");
+    REQUIRE(cache.get("table_generation:messages") == "9");
+    REQUIRE(published.empty());
+  }
+
+  SECTION("clearCache") {
+    cache.clearCache();
+    REQUIRE(cache.stats().entries == 0);
+    REQUIRE(published == std::vector<std::string>{""});
+  }
+}
+
+TEST_CASE("Test near cache limits") {
+  MockCache remote;
+
+  SECTION("Entries expire after the L1 ttl") {
+    NearCache cache(remote, NearCacheConfig{.ttl = std::chrono::milliseconds(20)});
+    remote.set("key", "old");
+    REQUIRE(cache.get("key") == "old");
+    remote.set("key", "new");
+    REQUIRE(cache.get("key") == "old");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    REQUIRE(cache.get("key") == "new");
+    REQUIRE(cache.stats().expirations == 1);
+  }
+
+  SECTION("Least recently used entries are evicted to stay within the byte budget") {
+    NearCache cache(remote, NearCacheConfig{.shards = 1, .max_bytes = 4096});
+    const std::string value(1000, 'x');
+    for (int i = 0; i < 10; ++i) cache.set("key:" + std::to_string(i), value, std::chrono::seconds{30});
+
+    const auto stats = cache.stats();
+    REQUIRE(stats.bytes <= 4096);
+    REQUIRE(stats.evictions > 0);
+    const int gets = remote.get_calls;
+    REQUIRE(cache.get("key:9") == value);
+    REQUIRE(remote.get_calls == gets);
+  }
+
+  SECTION("Only configured prefixes are kept") {
+    NearCache cache(remote, NearCacheConfig{.prefixes = {"table_generation:"}});
+    remote.set("request:1", "queued");
+    REQUIRE(cache.get("request:1") == "queued");
+    REQUIRE(cache.get("request:1") == "queued");
+    REQUIRE(remote.get_calls == 2);
+    REQUIRE(cache.stats().entries == 0);
+  }
+}
@@ -145,3 +145,157 @@
 //     REQUIRE(created_key == expected_key);
 //   }
 // }
+
+#include <catch2/catch_all.hpp>
+
+#include <random>
+#include <unordered_set>
+
+#include "GenericRepository.h"
+#include "QueryKeyHasher.h"
+#include "SQLiteDataBase.h"
+#include "SqlExecutor.h"
+#include "entities/MessageStatus.h"
+#include "mocks/MockCache.h"
+
+TEST_CASE("Test select query streams rows through a cursor") {
+  SQLiteDatabase db("select_cursor_test.db");
+  REQUIRE(db.initializeSchema());
+  REQUIRE(db.exec("DELETE FROM messages_status"));
+  SqlExecutor executor(db);
+  MockCache cache;
+  GenericRepository rep(&executor, cache);
+
+  std::vector<MessageStatus> statuses;
+  for (int receiver = 1; receiver <= 25; ++receiver) statuses.emplace_back(7, receiver, receiver % 2 == 0, 100);
+  REQUIRE(rep.saveAll(statuses));
+  cache.clearCache();
+
+  auto query = QueryFactory::createSelect<MessageStatus>(&executor, cache);
+  query->where(MessageStatusTable::MessageId, 7);
+  query->orderBy(MessageStatusTable::ReceiverId);
+
+  SECTION("Range for expected every row in order") {
+    long long expected_receiver = 1;
+    auto cursor = query->stream();
+    for (const auto &status : cursor) {
+      REQUIRE(status.receiver_id == expected_receiver++);
+      REQUIRE(status.message_id == 7);
+    }
+    REQUIRE(cursor.ok());
+    REQUIRE(cursor.rowsRead() == 25);
+  }
+
+  SECTION("Chunks expected bounded size until exhausted") {
+    auto cursor = query->stream();
+    std::vector<std::size_t> sizes;
+    while (true) {
+      auto chunk = cursor.nextChunk(10);
+      if (chunk.empty()) break;
+      sizes.push_back(chunk.size());
+    }
+    REQUIRE(sizes == std::vector<std::size_t>{10, 10, 5});
+  }
+
+  SECTION("Streaming expected no cache reads or writes") {
+    int set_before = cache.set_calls;
+    int pipeline_before = cache.set_pipeline_calls;
+    auto cursor = query->stream();
+    while (cursor.next()) {
+    }
+    REQUIRE(cache.set_calls == set_before);
+    REQUIRE(cache.set_pipeline_calls == pipeline_before);
+  }
+
+  SECTION("Invalid sql expected failed cursor without rows") {
+    auto bad = QueryFactory::createSelect<MessageStatus>(&executor, cache);
+    bad->where("no_such_column", 1);
+    auto cursor = bad->stream();
+    REQUIRE_FALSE(cursor.ok());
+    REQUIRE_FALSE(cursor.next().has_value());
+  }
+
+  SECTION("Nested read while cursor is open expected to reuse its connection") {
+    auto cursor = query->stream();
+    REQUIRE(cursor.next().has_value());
+    const auto in_use = db.poolStats().in_use;
+
+    auto execute_results = executor.execute("SELECT COUNT(*) FROM messages_status", {});
+    REQUIRE(execute_results.query);
+    REQUIRE(db.poolStats().in_use == in_use);
+  }
+}
+
+TEST_CASE("Test query cache keys") {
+  const QString sql = "SELECT * FROM messages WHERE chat_id = ? AND sender_id = ?";
+
+  SECTION("Key is deterministic and fixed size") {
+    const auto key = makeQueryCacheKey(sql, {1, 2});
+    REQUIRE(key == makeQueryCacheKey(sql, {1, 2}));
+    REQUIRE(key.starts_with("query_cache:"));
+    REQUIRE(key.size() == std::string("query_cache:").size() + 32);
+    REQUIRE(makeQueryCacheKey(sql + " LIMIT 20", {1, 2}).size() == key.size());
+  }
+
+  SECTION("Parameter order matters") {
+    REQUIRE(makeQueryCacheKey(sql, {1, 2}) != makeQueryCacheKey(sql, {2, 1}));
+    REQUIRE(makeQueryCacheKey(sql, {7, 7}) != makeQueryCacheKey(sql, {}));
+  }
+
+  SECTION("Parameter types are distinguished but integer widths are not") {
+    REQUIRE(makeQueryCacheKey(sql, {1}) != makeQueryCacheKey(sql, {QString("1")}));
+    REQUIRE(makeQueryCacheKey(sql, {1}) != makeQueryCacheKey(sql, {1.0}));
+    REQUIRE(makeQueryCacheKey(sql, {QVariant()}) != makeQueryCacheKey(sql, {QString()}));
+    REQUIRE(makeQueryCacheKey(sql, {3}) == makeQueryCacheKey(sql, {3LL}));
+  }
+
+  SECTION("Concatenated values do not collide") {
+    REQUIRE(makeQueryCacheKey(sql, {QString("ab"), QString("c")}) !=
+            makeQueryCacheKey(sql, {QString("a"), QString("bc")}));
+    REQUIRE(makeQueryCacheKey("SELECT 1", {QString("2")}) != makeQueryCacheKey("SELECT 12", {QString()}));
+  }
+
+  SECTION("Generation stamp depends on tables, generations and their order") {
+    const std::vector<std::pair<std::string, std::string>> stamp{{"messages", "3"}, {"messages_status", "1"}};
+    REQUIRE(hashGenerations(stamp) == hashGenerations(stamp));
+    REQUIRE(hashGenerations(stamp) != hashGenerations({{"messages", "31"}, {"messages_status", ""}}));
+    REQUIRE(hashGenerations(stamp) != hashGenerations({{"messages_status", "1"}, {"messages", "3"}}));
+    REQUIRE(hashGenerations(stamp) != hashGenerations({{"messages", "4"}, {"messages_status", "1"}}));
+  }
+
+  SECTION("Random distinct parameter lists give distinct keys") {
+    std::mt19937_64 rng(Catch::getSeed());
+    std::uniform_int_distribution<int> length(0, 4);
+    std::uniform_int_distribution<long long> number(-1000, 1000);
+    std::uniform_int_distribution<int> kind(0, 2);
+
+    std::unordered_set<std::string> params_seen;
+    std::unordered_set<std::string> keys;
+    int collisions = 0;
+    for (int i = 0; i < 100'000; ++i) {
+      QVector<QVariant> params;
+      std::string canonical;
+      const int size = length(rng);
+      for (int j = 0; j < size; ++j) {
+        const long long value = number(rng);
+        switch (kind(rng)) {
+          case 0:
+            params.push_back(value);
+            canonical += "i" + std::to_string(value) + ";";
+            break;
+          case 1:
+            params.push_back(QString::number(value));
+            canonical += "s" + std::to_string(value) + ";";
+            break;
+          default:
+            params.push_back(static_cast<double>(value) / 8);
+            canonical += "d" + std::to_string(value) + ";";
+            break;
+        }
+      }
+      if (!params_seen.insert(canonical).second) continue;
+      if (!keys.insert(makeQueryCacheKey(sql, params)).second) ++collisions;
+    }
+    REQUIRE(collisions == 0);
+  }
+}
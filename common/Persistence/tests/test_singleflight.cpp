@@ -0,0 +1,69 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "SingleFlight.h"
+
+TEST_CASE("Test single flight coalesces concurrent loads") {
+  SingleFlight<std::vector<int>> flights;
+  std::atomic<int> loads{0};
+
+  SECTION("Callers arriving during a load expected to share its result") {
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    constexpr int kWaiters = 8;
+    std::vector<std::vector<int>> results(kWaiters + 1);
+
+    std::vector<std::thread> callers;
+    callers.emplace_back([&] {
+      results[0] = flights.run("chat:1", [&] {
+        ++loads;
+        released.wait();
+        return std::vector<int>{1, 2, 3};
+      });
+    });
+    while (!flights.inFlight("chat:1")) std::this_thread::yield();
+
+    for (int i = 1; i <= kWaiters; ++i) {
+      callers.emplace_back([&, i] {
+        results[i] = flights.run("chat:1", [&] {
+          ++loads;
+          return std::vector<int>{};
+        });
+      });
+    }
+    while (flights.stats().joined < kWaiters) std::this_thread::yield();
+
+    release.set_value();
+    for (auto &caller : callers) caller.join();
+
+    REQUIRE(loads == 1);
+    for (const auto &result : results) REQUIRE(result == std::vector<int>{1, 2, 3});
+    REQUIRE(flights.stats().loads == 1);
+    REQUIRE_FALSE(flights.inFlight("chat:1"));
+  }
+
+  SECTION("Finished load expected the next caller to load again") {
+    flights.run("chat:1", [&] {
+      ++loads;
+      return std::vector<int>{1};
+    });
+    flights.run("chat:1", [&] {
+      ++loads;
+      return std::vector<int>{2};
+    });
+
+    REQUIRE(loads == 2);
+    REQUIRE(flights.stats().joined == 0);
+  }
+
+  SECTION("Failed load expected the exception for the caller and a forgotten key") {
+    REQUIRE_THROWS_AS(flights.run("chat:1", []() -> std::vector<int> { throw std::runtime_error("db is down"); }),
+                      std::runtime_error);
+    REQUIRE_FALSE(flights.inFlight("chat:1"));
+  }
+}
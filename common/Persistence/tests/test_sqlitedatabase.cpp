@@ -1,5 +1,7 @@
 #include <QSqlQuery>
 #include <catch2/catch_all.hpp>
+#include <memory>
+#include <thread>
 
 #include "SQLiteDataBase.h"
 
@@ -40,3 +42,254 @@ TEST_CASE("Test sqlitedatabase create tables") {
   //   REQUIRE_FALSE(db_.tableExists(database_, "test_table"));
   // }
 }
+
+TEST_CASE("Test sqlitedatabase reuses prepared statements") {
+  TestSqliteDatabase db("prepared_statements_test.db");
+  REQUIRE(db.exec("CREATE TABLE IF NOT EXISTS stmt_cache (id INTEGER PRIMARY KEY, name TEXT)"));
+  const QString insert_sql = "INSERT OR REPLACE INTO stmt_cache (id, name) VALUES (?, ?); ";
+
+  SECTION("Same sql prepared twice expected one miss and one hit") {
+    auto before = db.statementCacheStats();
+
+    for (int i = 1; i <= 2; ++i) {
+      auto query = db.prepare(insert_sql);
+      REQUIRE(query);
+      query->bind(i);
+      query->bind(QString("name_%1").arg(i));
+      REQUIRE(query->exec());
+    }
+
+    auto after = db.statementCacheStats();
+    REQUIRE(after.misses == before.misses + 1);
+    REQUIRE(after.hits == before.hits + 1);
+  }
+
+  SECTION("Reused statement expected rebinds values") {
+    for (int i = 10; i <= 12; ++i) {
+      auto query = db.prepare(insert_sql);
+      REQUIRE(query);
+      query->bind(i);
+      query->bind(QString("name_%1").arg(i));
+      REQUIRE(query->exec());
+    }
+
+    auto select = db.prepare("SELECT name FROM stmt_cache WHERE id = ?");
+    REQUIRE(select);
+    select->bind(11);
+    REQUIRE(select->exec());
+    REQUIRE(select->next());
+    REQUIRE(select->value(0).toString() == "name_11");
+  }
+
+  SECTION("Statement still in use expected fresh statement instead of reuse") {
+    auto first = db.prepare("SELECT id FROM stmt_cache");
+    REQUIRE(first);
+    REQUIRE(first->exec());
+
+    auto before = db.statementCacheStats();
+    auto second = db.prepare("SELECT id FROM stmt_cache");
+    REQUIRE(second);
+    REQUIRE(db.statementCacheStats().misses == before.misses + 1);
+  }
+
+  SECTION("Whitespace inside a literal expected kept and a separate statement") {
+    REQUIRE(db.exec("DELETE FROM stmt_cache"));
+    for (const QString name : {"a  b", "a b"}) {
+      auto query = db.prepare(QString("INSERT INTO stmt_cache (name) VALUES ('%1')").arg(name));
+      REQUIRE(query);
+      REQUIRE(query->exec());
+    }
+
+    auto select = db.prepare("SELECT name FROM stmt_cache ORDER BY id");
+    REQUIRE(select);
+    REQUIRE(select->exec());
+    REQUIRE(select->next());
+    REQUIRE(select->value(0).toString() == "a  b");
+    REQUIRE(select->next());
+    REQUIRE(select->value(0).toString() == "a b");
+  }
+
+  SECTION("Disabled cache expected no hits") {
+    TestSqliteDatabase uncached("prepared_statements_test.db", 0);
+    for (int i = 0; i < 3; ++i) {
+      auto query = uncached.prepare("SELECT id FROM stmt_cache");
+      REQUIRE(query);
+    }
+    REQUIRE(uncached.statementCacheStats().hits == 0);
+  }
+}
+
+TEST_CASE("Test sqlitedatabase applies connection profile") {
+  auto pragmaValue = [](const SQLiteDatabase &database, const QString &pragma) {
+    QSqlQuery query(database.db());
+    REQUIRE(query.exec(QString("PRAGMA %1").arg(pragma)));
+    REQUIRE(query.next());
+    return query.value(0);
+  };
+
+  SECTION("Write heavy profile expected WAL and relaxed sync") {
+    TestSqliteDatabase db("profile_write_heavy_test.db", SQLiteProfile::writeHeavy());
+    REQUIRE(pragmaValue(db, "journal_mode").toString().toLower() == "wal");
+    REQUIRE(pragmaValue(db, "synchronous").toInt() == 1);  // NORMAL
+    REQUIRE(pragmaValue(db, "temp_store").toInt() == 2);   // MEMORY
+    REQUIRE(pragmaValue(db, "cache_size").toInt() == SQLiteProfile::writeHeavy().cache_size);
+    REQUIRE(pragmaValue(db, "busy_timeout").toInt() == SQLiteProfile::writeHeavy().busy_timeout_ms);
+  }
+
+  SECTION("Read heavy profile expected larger page cache") {
+    TestSqliteDatabase db("profile_read_heavy_test.db", SQLiteProfile::readHeavy());
+    REQUIRE(pragmaValue(db, "cache_size").toInt() == SQLiteProfile::readHeavy().cache_size);
+    REQUIRE(db.profile().mmap_size == SQLiteProfile::readHeavy().mmap_size);
+  }
+
+  SECTION("Legacy profile expected rollback journal") {
+    TestSqliteDatabase db("profile_legacy_test.db", SQLiteProfile::legacy());
+    REQUIRE(pragmaValue(db, "journal_mode").toString().toLower() == "delete");
+    REQUIRE(pragmaValue(db, "synchronous").toInt() == 2);  // FULL
+  }
+}
+
+TEST_CASE("Test sqlite connection pool leases") {
+  SQLiteConnectionPool pool("connection_pool_test.db", SQLiteProfile::balanced(),
+                            SQLiteConnectionPool::Options{.readers = 2, .acquire_timeout = std::chrono::milliseconds(20)});
+
+  SECTION("Pool expected one writer plus readers") { REQUIRE(pool.stats().size == 3); }
+
+  SECTION("Writer is exclusive expected second acquire times out") {
+    auto writer = pool.acquireWriter();
+    REQUIRE(writer);
+    REQUIRE(writer.role() == ConnectionRole::Writer);
+
+    auto second = pool.acquireWriter();
+    REQUIRE_FALSE(second);
+    REQUIRE(pool.stats().timeouts == 1);
+  }
+
+  SECTION("Readers exhausted expected timeout until one is released") {
+    auto first = pool.acquireReader();
+    {
+      auto second = pool.acquireReader();
+      REQUIRE(second);
+      REQUIRE_FALSE(pool.acquireReader());
+      REQUIRE(pool.stats().in_use == 2);
+    }
+    REQUIRE(pool.acquireReader());
+    REQUIRE(pool.stats().max_in_use == 2);
+  }
+
+  SECTION("Reader connection expected read only") {
+    auto reader = pool.acquireReader();
+    QSqlQuery query(reader.db());
+    REQUIRE_FALSE(query.exec("CREATE TABLE IF NOT EXISTS pool_read_only (id INTEGER)"));
+  }
+
+  SECTION("Released lease expected back in pool") {
+    {
+      auto writer = pool.acquireWriter();
+      REQUIRE(pool.stats().in_use == 1);
+    }
+    REQUIRE(pool.stats().in_use == 0);
+    REQUIRE(pool.acquireWriter());
+  }
+}
+
+TEST_CASE("Test sqlitedatabase pins writer for a transaction") {
+  TestSqliteDatabase db("connection_pool_tx_test.db");
+  REQUIRE(db.exec("CREATE TABLE IF NOT EXISTS pool_tx (id INTEGER PRIMARY KEY)"));
+  REQUIRE(db.exec("DELETE FROM pool_tx"));
+
+  SECTION("Statements between BEGIN and COMMIT expected on one connection") {
+    REQUIRE(db.exec("BEGIN IMMEDIATE"));
+    REQUIRE(db.poolStats().in_use == 1);
+    REQUIRE(db.exec("INSERT INTO pool_tx (id) VALUES (1)"));
+    REQUIRE(db.exec("INSERT INTO pool_tx (id) VALUES (2)"));
+    REQUIRE(db.poolStats().in_use == 1);
+    REQUIRE(db.exec("COMMIT"));
+    REQUIRE(db.poolStats().in_use == 0);
+
+    auto count = db.prepare("SELECT COUNT(*) FROM pool_tx");
+    REQUIRE(count);
+    REQUIRE(count->exec());
+    REQUIRE(count->next());
+    REQUIRE(count->value(0).toInt() == 2);
+  }
+
+  SECTION("Rollback expected writer released and changes dropped") {
+    REQUIRE(db.transaction());
+    REQUIRE(db.exec("INSERT INTO pool_tx (id) VALUES (3)"));
+    db.rollback();
+    REQUIRE(db.poolStats().in_use == 0);
+
+    auto count = db.prepare("SELECT COUNT(*) FROM pool_tx WHERE id = 3");
+    REQUIRE(count);
+    REQUIRE(count->exec());
+    REQUIRE(count->next());
+    REQUIRE(count->value(0).toInt() == 0);
+  }
+
+  SECTION("Query result alive expected its connection stays leased") {
+    auto select = db.prepare("SELECT id FROM pool_tx");
+    REQUIRE(select);
+    REQUIRE(db.poolStats().in_use == 1);
+    select.reset();
+    REQUIRE(db.poolStats().in_use == 0);
+  }
+
+  SECTION("WITH leading into an INSERT expected on the writer") {
+    REQUIRE(db.exec("WITH ids(id) AS (SELECT 4) INSERT INTO pool_tx (id) SELECT id FROM ids"));
+
+    auto count = db.prepare("WITH ids(id) AS (SELECT 4) SELECT COUNT(*) FROM pool_tx WHERE id IN ids");
+    REQUIRE(count);
+    REQUIRE(count->exec());
+    REQUIRE(count->next());
+    REQUIRE(count->value(0).toInt() == 1);
+  }
+
+  SECTION("Database destroyed inside a transaction expected its writer released") {
+    auto doomed = std::make_unique<TestSqliteDatabase>("connection_pool_tx_test.db");
+    REQUIRE(doomed->exec("BEGIN IMMEDIATE"));
+    doomed.reset();
+
+    // a new instance, possibly at the same address, starts without a pinned writer
+    auto fresh = std::make_unique<TestSqliteDatabase>("connection_pool_tx_test.db");
+    REQUIRE(fresh->exec("INSERT INTO pool_tx (id) VALUES (5)"));
+    REQUIRE(fresh->poolStats().in_use == 0);
+  }
+}
+
+TEST_CASE("Test sqlitedatabase connections on other threads") {
+  SECTION("File database expected reads and writes from a worker thread") {
+    TestSqliteDatabase db("connection_pool_thread_test.db");
+    REQUIRE(db.exec("CREATE TABLE IF NOT EXISTS pool_thread (id INTEGER PRIMARY KEY)"));
+    REQUIRE(db.exec("DELETE FROM pool_thread"));
+
+    bool written = false;
+    int seen = -1;
+    std::thread worker([&] {
+      written = db.exec("INSERT INTO pool_thread (id) VALUES (1)");
+      auto count = db.prepare("SELECT COUNT(*) FROM pool_thread");
+      if (count && count->exec() && count->next()) seen = count->value(0).toInt();
+    });
+    worker.join();
+
+    REQUIRE(written);
+    REQUIRE(seen == 1);
+    REQUIRE(db.poolStats().in_use == 0);
+  }
+
+  SECTION("In-memory database expected shared between threads") {
+    TestSqliteDatabase db(":memory:");
+    REQUIRE(db.exec("CREATE TABLE pool_memory (id INTEGER PRIMARY KEY)"));
+
+    bool written = false;
+    std::thread worker([&] { written = db.exec("INSERT INTO pool_memory (id) VALUES (7)"); });
+    worker.join();
+    REQUIRE(written);
+
+    auto select = db.prepare("SELECT id FROM pool_memory");
+    REQUIRE(select);
+    REQUIRE(select->exec());
+    REQUIRE(select->next());
+    REQUIRE(select->value(0).toInt() == 7);
+  }
+}
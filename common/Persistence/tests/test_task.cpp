@@ -0,0 +1,100 @@
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "PooledAllocator.h"
+#include "Task.h"
+
+namespace {
+
+// counts live copies, so a relocation that leaks or double-destroys its source shows up
+struct Tracked {
+  static inline int live = 0;
+
+  Tracked() { ++live; }
+  Tracked(const Tracked &) { ++live; }
+  Tracked(Tracked &&) noexcept { ++live; }
+  ~Tracked() { --live; }
+  Tracked &operator=(const Tracked &) = default;
+  Tracked &operator=(Tracked &&) noexcept = default;
+};
+
+// true when the callable that runs `task` lives inside the Task object itself
+bool runsInline(Task &task, const void *&callable) {
+  task();
+  const auto *begin = reinterpret_cast<const std::byte *>(&task);
+  const auto *at = static_cast<const std::byte *>(callable);
+  return at >= begin && at < begin + sizeof(Task);
+}
+
+}  // namespace
+
+TEST_CASE("Test task storage") {
+  SECTION("Small callables are stored inline and large ones on the heap") {
+    const void *callable = nullptr;
+    auto small = [&callable, tag = 0]() mutable { callable = &tag; };
+    auto large = [&callable, payload = std::array<char, Task::kInlineSize>{}]() mutable { callable = &payload; };
+    STATIC_REQUIRE(Task::kStoredInline<decltype(small)>);
+    STATIC_REQUIRE_FALSE(Task::kStoredInline<decltype(large)>);
+
+    Task inline_task(small);
+    Task heap_task(large);
+    REQUIRE(runsInline(inline_task, callable));
+    REQUIRE_FALSE(runsInline(heap_task, callable));
+  }
+
+  SECTION("A callable whose move may throw goes to the heap") {
+    struct ThrowingMove {
+      ThrowingMove() = default;
+      ThrowingMove(ThrowingMove &&) noexcept(false) {}
+      void operator()() const {}
+    };
+    STATIC_REQUIRE_FALSE(Task::kStoredInline<ThrowingMove>);
+  }
+
+  SECTION("Move-only callables survive relocation, inline and on the heap") {
+    std::string result;
+    {
+      Task inline_task([owned = std::make_unique<std::string>("inline"), tracked = Tracked(), &result] {
+        result += *owned;
+      });
+      Task heap_task([owned = std::make_unique<std::string>("heap"), tracked = Tracked(),
+                      padding = std::array<char, Task::kInlineSize>{}, &result] { result += *owned; });
+      REQUIRE(Tracked::live == 2);
+
+      Task moved(std::move(inline_task));
+      REQUIRE_FALSE(inline_task);
+      Task assigned;
+      assigned = std::move(heap_task);
+      REQUIRE_FALSE(heap_task);
+      moved = std::move(assigned);  // destroys the inline callable, takes over the heap one
+      REQUIRE(Tracked::live == 1);
+
+      moved();
+      REQUIRE(result == "heap");
+    }
+    REQUIRE(Tracked::live == 0);
+  }
+}
+
+TEST_CASE("Test pooled allocator") {
+  SECTION("A block freed on another thread is reused by that thread") {
+    PooledAllocator<std::array<char, 64>> allocator;
+    auto *block = allocator.allocate(1);
+
+    void *reused = nullptr;
+    std::thread([&allocator, block, &reused] {
+      allocator.deallocate(block, 1);
+      auto *again = allocator.allocate(1);
+      reused = again;
+      allocator.deallocate(again, 1);
+    }).join();  // the thread's cache frees the block on exit
+
+    REQUIRE(reused == block);
+  }
+}
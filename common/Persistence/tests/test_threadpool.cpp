@@ -0,0 +1,198 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingThreadPool.h"
+#include "threadpool.h"
+
+namespace {
+
+// occupies the single worker of `pool` until the returned promise is set
+template <typename Pool>
+std::promise<void> blockWorker(Pool &pool) {
+  std::promise<void> gate;
+  std::atomic<bool> running{false};
+  pool.post([opened = gate.get_future().share(), &running] {
+    running = true;
+    opened.wait();
+  });
+  while (!running) std::this_thread::yield();
+  return gate;
+}
+
+}  // namespace
+
+TEMPLATE_TEST_CASE("Test thread pool queue limits", "", ThreadPool, WorkStealingThreadPool) {
+  SECTION("Reject throws once the queue is at capacity") {
+    TestType pool(1, ThreadPoolLimits{.capacity = 2, .policy = OverflowPolicy::Reject});
+    auto gate = blockWorker(pool);
+    pool.post([] {});
+    pool.post([] {});
+
+    REQUIRE(pool.saturated());
+    REQUIRE_THROWS_AS(pool.post([] {}), ThreadPoolFullError);
+
+    gate.set_value();
+    pool.waitAll();
+    auto stats = pool.stats();
+    REQUIRE_FALSE(pool.saturated());
+    REQUIRE(stats.rejected == 1);
+    REQUIRE(stats.started == 3);
+    REQUIRE(stats.queued == 0);
+  }
+
+  SECTION("DropOldestLow sheds low priority tasks before rejecting") {
+    TestType pool(1, ThreadPoolLimits{.capacity = 2, .policy = OverflowPolicy::DropOldestLow});
+    std::atomic<int> ran{0};
+    auto gate = blockWorker(pool);
+    auto low = pool.submit([&ran] { ran += 1; }, TaskPriority::Low);
+    pool.post([&ran] { ran += 10; });
+
+    pool.post([&ran] { ran += 100; });                      // takes the slot of the low task
+    pool.post([&ran] { ran += 1000; }, TaskPriority::Low);  // no older low task: dropped itself
+    REQUIRE_THROWS_AS(pool.post([] {}), ThreadPoolFullError);
+
+    gate.set_value();
+    pool.waitAll();
+    REQUIRE(ran == 110);
+    REQUIRE_THROWS_AS(low.get(), std::future_error);
+    REQUIRE(pool.stats().dropped == 2);
+    REQUIRE(pool.stats().rejected == 1);
+  }
+
+  SECTION("Block makes producers wait and loses nothing") {
+    TestType pool(2, ThreadPoolLimits{.capacity = 4, .policy = OverflowPolicy::Block});
+    std::atomic<int> ran{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+      producers.emplace_back([&] {
+        for (int i = 0; i < 500; ++i) pool.post([&ran] { ++ran; });
+      });
+    }
+    for (auto &producer : producers) producer.join();
+    pool.waitAll();
+
+    REQUIRE(ran == 2000);
+    REQUIRE(pool.stats().started == 2000);
+    REQUIRE(pool.stats().queued == 0);
+  }
+}
+
+TEMPLATE_TEST_CASE("Test thread pool priority lanes", "", ThreadPool, WorkStealingThreadPool) {
+  TestType pool(1);
+  std::mutex order_mutex;
+  std::vector<int> order;
+  auto record = [&order_mutex, &order](int id) {
+    return [&order_mutex, &order, id] {
+      const std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(id);
+    };
+  };
+
+  SECTION("Interactive tasks run ahead of queued background tasks") {
+    auto gate = blockWorker(pool);
+    pool.post(record(1), TaskPriority::Background);
+    pool.post(record(2), TaskPriority::Low);
+    pool.post(record(3), TaskPriority::Interactive);
+    gate.set_value();
+    pool.waitAll();
+
+    REQUIRE(order == std::vector<int>{3, 1, 2});
+  }
+
+  SECTION("A background task is not starved by a stream of interactive ones") {
+    auto gate = blockWorker(pool);
+    pool.post(record(0), TaskPriority::Background);
+    for (int i = 1; i <= 20; ++i) pool.post(record(i), TaskPriority::Interactive);
+    gate.set_value();
+    pool.waitAll();
+
+    const auto background = std::find(order.begin(), order.end(), 0);
+    REQUIRE(background != order.end());
+    REQUIRE(std::distance(order.begin(), background) <= static_cast<std::ptrdiff_t>(LaneTurn::kInteractiveBurst));
+  }
+}
+
+TEMPLATE_TEST_CASE("Test thread pool task failures", "", ThreadPool, WorkStealingThreadPool) {
+  TestType pool(1);
+
+  SECTION("submit reports the exception through the future") {
+    auto failed = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    auto value = pool.submit([] { return 42; });
+
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+    REQUIRE(value.get() == 42);
+  }
+
+  SECTION("A throwing post does not take the worker down") {
+    std::atomic<int> ran{0};
+    pool.post([] { throw std::runtime_error("boom"); });
+    pool.post([] { throw 7; });
+    pool.post([&ran] { ++ran; });
+    pool.waitAll();
+
+    REQUIRE(ran == 1);
+    REQUIRE(pool.submit([] { return 1; }).get() == 1);
+  }
+}
+
+TEST_CASE("Test work stealing thread pool") {
+  SECTION("waitAll waits for tasks enqueued by running tasks") {
+    WorkStealingThreadPool pool(4);
+    std::atomic<int> ran{0};
+    std::function<void(int)> fan_out = [&pool, &ran, &fan_out](int depth) {
+      ++ran;
+      if (depth == 0) return;
+      for (int i = 0; i < 4; ++i) pool.post([&fan_out, depth] { fan_out(depth - 1); });
+    };
+    pool.post([&fan_out] { fan_out(4); });
+    pool.waitAll();
+
+    REQUIRE(ran == 1 + 4 + 16 + 64 + 256);
+  }
+
+  SECTION("Idle workers steal from a busy worker's deque") {
+    WorkStealingThreadPool pool(2);
+    constexpr int kChildren = 16;
+    std::atomic<int> ran{0};
+    std::atomic<bool> stolen{false};
+    std::promise<void> children_done;
+    pool.post([&] {
+      const auto parent = std::this_thread::get_id();
+      for (int i = 0; i < kChildren; ++i) {
+        pool.post([&, parent] {
+          if (std::this_thread::get_id() != parent) stolen = true;
+          if (++ran == kChildren) children_done.set_value();
+        });
+      }
+      // the children sit in this worker's own deque; only the other worker can run them
+      children_done.get_future().wait_for(std::chrono::seconds(5));
+    });
+    pool.waitAll();
+
+    REQUIRE(ran == kChildren);
+    REQUIRE(stolen);
+  }
+
+  SECTION("Destruction runs the queued tasks before the workers exit") {
+    std::atomic<int> ran{0};
+    {
+      WorkStealingThreadPool pool(1);
+      auto gate = blockWorker(pool);
+      for (int i = 0; i < 100; ++i) pool.post([&ran] { ++ran; });
+      gate.set_value();
+    }
+
+    REQUIRE(ran == 100);
+  }
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "TtlPolicy.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Test ttl policy rules") {
+  TtlPolicy policy(TtlRule{.jitter = 0.0, .min = 1s, .max = 1h});
+  policy.setRule("query_cache:", TtlRule{.jitter = 0.2, .min = 5s, .max = 60s});
+  policy.setRule("query_cache:hot:", TtlRule{.base = 10s, .jitter = 0.0});
+
+  SECTION("Key without a family expected the default rule and the requested ttl") {
+    REQUIRE(policy.apply("entity_cache:users:1", 30s) == 30s);
+  }
+
+  SECTION("Longest matching prefix expected to win") {
+    REQUIRE(policy.ruleFor("query_cache:hot:1").base == 10s);
+    REQUIRE(policy.apply("query_cache:hot:1", 30s) == 10s);
+    REQUIRE(policy.ruleFor("query_cache:1").jitter == 0.2);
+  }
+
+  SECTION("Jittered ttl expected within the proportional spread") {
+    std::chrono::milliseconds lowest = 1h;
+    std::chrono::milliseconds highest = 0ms;
+    for (int i = 0; i < 10'000; ++i) {
+      const auto ttl = policy.apply("query_cache:1", 30s);
+      lowest = std::min(lowest, ttl);
+      highest = std::max(highest, ttl);
+    }
+
+    REQUIRE(lowest >= 24s);
+    REQUIRE(highest <= 36s);
+    REQUIRE(highest - lowest > 6s);  // actually spread, not a constant
+  }
+
+  SECTION("Ttl outside the family bounds expected clamped") {
+    REQUIRE(policy.apply("query_cache:1", 1s) >= 5s);
+    REQUIRE(policy.apply("query_cache:1", 10min) == 60s);
+    REQUIRE(policy.apply("entity_cache:users:1", 0s) == 1s);
+  }
+
+  SECTION("Family without a max expected no upper bound") {
+    policy.setRule("session:", TtlRule{.jitter = 0.0});
+    REQUIRE(policy.apply("session:1", 48h) == 48h);
+    REQUIRE(TtlPolicy().ruleFor("entity_cache:users:1").max == 0s);
+  }
+
+  SECTION("Rule set again for a prefix expected to replace it") {
+    policy.setRule("query_cache:", TtlRule{.jitter = 0.0});
+    REQUIRE(policy.apply("query_cache:1", 30s) == 30s);
+  }
+}
+
+TEST_CASE("Test ttl policy keeps the live key count bounded under a write load") {
+  // 200 new keys per simulated second for two hours, each asking for 30 s.
+  // Keys live for the ttl the policy returns; the count of live keys must
+  // settle around rate * ttl instead of growing with the run.
+  TtlPolicy policy;
+  constexpr int kWritesPerSecond = 200;
+  constexpr auto kRun = 2h;
+  constexpr auto kRequested = 30s;
+
+  std::priority_queue<std::chrono::milliseconds, std::vector<std::chrono::milliseconds>, std::greater<>> expiries;
+  std::size_t peak = 0;
+  long long written = 0;
+  for (std::chrono::milliseconds now = 0ms; now < kRun; now += 1s) {
+    while (!expiries.empty() && expiries.top() <= now) expiries.pop();
+    for (int i = 0; i < kWritesPerSecond; ++i) {
+      expiries.push(now + policy.apply("query_cache:" + std::to_string(written++), kRequested));
+    }
+    peak = std::max(peak, expiries.size());
+  }
+
+  // default rule: +-10 % jitter, so no key outlives 33 s
+  REQUIRE(peak <= kWritesPerSecond * 34);
+  REQUIRE(expiries.size() <= kWritesPerSecond * 34);
+}
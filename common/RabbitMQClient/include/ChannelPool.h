@@ -0,0 +1,162 @@
+#ifndef CHANNELPOOL_H
+#define CHANNELPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+struct ChannelPoolStats {
+  std::uint64_t acquisitions{0};
+  std::uint64_t opened{0};     // connections made by the factory, the first ones included
+  std::uint64_t discarded{0};  // channels closed after a failure
+  std::uint64_t timeouts{0};
+  std::size_t open{0};
+  std::size_t in_use{0};
+};
+
+// Long-lived channels (for SimpleAmqpClient, a Channel is one broker connection)
+// shared by publishing threads. A channel is used by one thread at a time, under a
+// Lease. Channels are opened on first demand, up to Options::size, and a lease
+// whose channel failed is invalidated: the pool forgets the channel and the next
+// acquire() connects again in its place.
+//
+// `Channel` provides `ptr_t`, a shared handle as in AmqpClient::Channel::ptr_t.
+template <typename Channel>
+class ChannelPool {
+ public:
+  using ChannelPtr = typename Channel::ptr_t;
+  using Factory = std::function<ChannelPtr()>;
+
+  struct Options {
+    std::size_t size = 4;
+    std::chrono::milliseconds acquire_timeout{5000};
+  };
+
+  // Exclusive use of one channel; returned to the pool on destruction.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(ChannelPool *pool, ChannelPtr channel) : pool_(pool), channel_(std::move(channel)) {}
+    ~Lease() { release(); }
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    Lease(Lease &&other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)), channel_(std::exchange(other.channel_, ChannelPtr())) {}
+    Lease &operator=(Lease &&other) noexcept {
+      if (this != &other) {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        channel_ = std::exchange(other.channel_, ChannelPtr());
+      }
+      return *this;
+    }
+
+    explicit operator bool() const { return static_cast<bool>(channel_); }
+    Channel &operator*() const { return *channel_; }
+    Channel *operator->() const { return &*channel_; }
+
+    // the channel failed (closed by the broker or a dead socket): drop it instead of
+    // handing it to the next publisher
+    void invalidate() {
+      if (pool_ && channel_) pool_->discard();
+      pool_ = nullptr;
+      channel_ = ChannelPtr();
+    }
+
+   private:
+    void release() {
+      if (pool_ && channel_) pool_->release(std::move(channel_));
+      pool_ = nullptr;
+      channel_ = ChannelPtr();
+    }
+
+    ChannelPool *pool_{nullptr};
+    ChannelPtr channel_;
+  };
+
+  ChannelPool(Factory factory, Options options) : factory_(std::move(factory)), options_(options) {
+    idle_.reserve(options_.size);
+  }
+
+  ChannelPool(const ChannelPool &) = delete;
+  ChannelPool &operator=(const ChannelPool &) = delete;
+
+  // an idle channel, or a new one while fewer than Options::size are open. Empty
+  // lease when none frees up within acquire_timeout; a failed connect propagates
+  // the factory's exception.
+  Lease acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!released_.wait_for(lock, options_.acquire_timeout,
+                            [this] { return !idle_.empty() || stats_.open < options_.size; })) {
+      ++stats_.timeouts;
+      return {};
+    }
+
+    ++stats_.acquisitions;
+    ++stats_.in_use;
+    if (!idle_.empty()) {
+      // most recently used first, so a quiet period lets the others sit idle
+      ChannelPtr channel = std::move(idle_.back());
+      idle_.pop_back();
+      return {this, std::move(channel)};
+    }
+
+    // the slot is taken before connecting, so concurrent acquires cannot overshoot size
+    ++stats_.open;
+    lock.unlock();
+    try {
+      ChannelPtr channel = factory_();
+      lock.lock();
+      ++stats_.opened;
+      return {this, std::move(channel)};
+    } catch (...) {
+      if (!lock.owns_lock()) lock.lock();
+      --stats_.open;
+      --stats_.in_use;
+      lock.unlock();
+      released_.notify_one();
+      throw;
+    }
+  }
+
+  [[nodiscard]] ChannelPoolStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  void release(ChannelPtr channel) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      idle_.push_back(std::move(channel));
+      --stats_.in_use;
+    }
+    released_.notify_one();
+  }
+
+  void discard() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --stats_.open;
+      --stats_.in_use;
+      ++stats_.discarded;
+    }
+    released_.notify_one();
+  }
+
+  Factory factory_;
+  Options options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+  std::vector<ChannelPtr> idle_;
+  ChannelPoolStats stats_;
+};
+
+#endif  // CHANNELPOOL_H
@@ -4,6 +4,7 @@
 #include <SimpleAmqpClient/SimpleAmqpClient.h>
 
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -12,6 +13,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ChannelPool.h"
 #include "Debug_profiling.h"
 #include "interfaces/IRabitMQClient.h"
 #include "threadpool.h"
@@ -21,6 +23,7 @@ struct RabbitMQConfig {
   int port;
   std::string user;
   std::string password;
+  std::size_t publisher_channels = 4;  // broker connections kept open for publish()
 };
 
 struct IThreadPool;
@@ -41,14 +44,23 @@ class RabbitMQClient : public IEventBus, public IEventBusLifecycle {
   void stop() override;
 
  private:
-  void declareExchange(const std::string &exchange, const std::string &type, bool durable);
+  AmqpClient::Channel::ptr_t openChannel() const;
+  // declares on `channel` the first time an exchange is used; the set of declared
+  // exchanges is shared by every publisher and consumer thread
+  void declareExchange(AmqpClient::Channel &channel, const std::string &exchange, const std::string &type,
+                       bool durable);
+  void forgetExchange(const std::string &exchange);
+  // holds a consumer back, without pulling or acking, while the pool queue is at capacity
+  void waitForPoolCapacity() const;
 
   std::atomic<bool> running_{false};
   IThreadPool *pool_;
   std::vector<std::thread> consumer_threads_;
   std::mutex consumer_threads_mutex_;
   std::unordered_set<std::string> declared_exchanges_;
-  const RabbitMQConfig &rabit_mq_config_;
+  std::mutex declared_exchanges_mutex_;
+  const RabbitMQConfig rabit_mq_config_;
+  ChannelPool<AmqpClient::Channel> publisher_channels_;
 };
 
 #endif  // RABBITMQCLIENT
@@ -1,44 +1,90 @@
 #include "RabbitMQClient.h"
 
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
 #include "Debug_profiling.h"
 
+namespace {
+
+// unacked deliveries per consumer: while a consumer holds one back, the broker keeps the rest
+constexpr std::uint16_t kConsumerPrefetch = 1;
+constexpr auto kSaturatedBackoff = std::chrono::milliseconds(5);
+// how long publish() waits for a pooled channel when every one is in use
+constexpr auto kPublisherAcquireTimeout = std::chrono::milliseconds(5000);
+// the second attempt runs on a fresh connection
+constexpr int kPublishAttempts = 2;
+
+}  // namespace
+
 RabbitMQClient::RabbitMQClient(const RabbitMQConfig &rabit_mq_config, IThreadPool *pool)
-    : pool_(pool), rabit_mq_config_(rabit_mq_config) {}
+    : pool_(pool),
+      rabit_mq_config_(rabit_mq_config),
+      publisher_channels_([this]() { return openChannel(); },
+                          {.size = rabit_mq_config.publisher_channels, .acquire_timeout = kPublisherAcquireTimeout}) {}
 
 RabbitMQClient::~RabbitMQClient() { RabbitMQClient::stop(); }
 
-void RabbitMQClient::declareExchange(const std::string &exchange, const std::string &type, bool durable) {
-  if (declared_exchanges_.contains(exchange)) {
-    LOG_INFO("{} already exist", exchange);
-    return;
-  }
+AmqpClient::Channel::ptr_t RabbitMQClient::openChannel() const {
+  return AmqpClient::Channel::Create(rabit_mq_config_.host, rabit_mq_config_.port, rabit_mq_config_.user,
+                                     rabit_mq_config_.password);
+}
 
-  try {
-    auto channel = AmqpClient::Channel::Create(rabit_mq_config_.host, rabit_mq_config_.port, rabit_mq_config_.user,
-                                               rabit_mq_config_.password);
-    channel->DeclareExchange(exchange, type, durable, false, false);
-    declared_exchanges_.insert(exchange);
-    LOG_INFO("[rabbit] Declared exchange '{}'", exchange);
-  } catch (const AmqpClient::AmqpException &e) {
-    LOG_WARN("[rabbit] Error while declaring '{}': {}", exchange, e.what());
+void RabbitMQClient::declareExchange(AmqpClient::Channel &channel, const std::string &exchange,
+                                     const std::string &type, bool durable) {
+  {
+    std::scoped_lock lock(declared_exchanges_mutex_);
+    if (declared_exchanges_.contains(exchange)) return;
   }
+
+  // not held across the round trip: two threads may both declare, which the broker accepts
+  channel.DeclareExchange(exchange, type, durable, false, false);
+  std::scoped_lock lock(declared_exchanges_mutex_);
+  declared_exchanges_.insert(exchange);
+  LOG_INFO("[rabbit] Declared exchange '{}'", exchange);
+}
+
+void RabbitMQClient::forgetExchange(const std::string &exchange) {
+  std::scoped_lock lock(declared_exchanges_mutex_);
+  declared_exchanges_.erase(exchange);
 }
 
 void RabbitMQClient::publish(const PublishRequest &publish_request) {
   LOG_INFO("Publish: {} | {}", publish_request.exchange, publish_request.routing_key);
-  declareExchange(publish_request.exchange, publish_request.exchange_type, false);
-  try {
-    auto channel = AmqpClient::Channel::Create(rabit_mq_config_.host, rabit_mq_config_.port, rabit_mq_config_.user,
-                                               rabit_mq_config_.password);
-    auto msg = AmqpClient::BasicMessage::Create(publish_request.message);
-    msg->DeliveryMode(AmqpClient::BasicMessage::dm_persistent);
-    LOG_INFO("[rabbit] Try to publish message '{}' to exchange '{}' with key '{}'", publish_request.message,
-             publish_request.exchange, publish_request.exchange_type);
-    channel->BasicPublish(publish_request.exchange, publish_request.routing_key, msg);
-    LOG_INFO("[rabbit] Published message '{}' to exchange '{}' with key '{}'", publish_request.message,
-             publish_request.exchange, publish_request.exchange_type);
-  } catch (const std::exception &e) {
-    LOG_ERROR("[rabbit] Publish failed: {}", e.what());
+  auto msg = AmqpClient::BasicMessage::Create(publish_request.message);
+  msg->DeliveryMode(AmqpClient::BasicMessage::dm_persistent);
+
+  for (int attempt = 1;; ++attempt) {
+    try {
+      auto channel = publisher_channels_.acquire();
+      if (!channel) {
+        LOG_ERROR("[rabbit] No publisher channel freed up, dropping message to exchange '{}'",
+                  publish_request.exchange);
+        return;
+      }
+      try {
+        declareExchange(*channel, publish_request.exchange, publish_request.exchange_type, false);
+        LOG_INFO("[rabbit] Try to publish message '{}' to exchange '{}' with key '{}'", publish_request.message,
+                 publish_request.exchange, publish_request.exchange_type);
+        channel->BasicPublish(publish_request.exchange, publish_request.routing_key, msg);
+      } catch (...) {
+        // the broker closes a channel on error and a dead socket fails every call:
+        // connect again, and declare again in case the broker restarted
+        channel.invalidate();
+        forgetExchange(publish_request.exchange);
+        throw;
+      }
+      LOG_INFO("[rabbit] Published message '{}' to exchange '{}' with key '{}'", publish_request.message,
+               publish_request.exchange, publish_request.exchange_type);
+      return;
+    } catch (const std::exception &e) {
+      if (attempt == kPublishAttempts) {
+        LOG_ERROR("[rabbit] Publish failed: {}", e.what());
+        return;
+      }
+      LOG_WARN("[rabbit] Publish failed ({}), retrying on a new channel", e.what());
+    }
   }
 }
 
@@ -48,9 +94,8 @@ void RabbitMQClient::subscribe(const SubscribeRequest &subscribe_request, const
 
   auto consumer_thread = std::thread([=, this]() {
     try {
-      declareExchange(subscribe_request.exchange, subscribe_request.exchange_type, false);
-      auto channel = AmqpClient::Channel::Create(rabit_mq_config_.host, rabit_mq_config_.port, rabit_mq_config_.user,
-                                                 rabit_mq_config_.password);
+      auto channel = openChannel();
+      declareExchange(*channel, subscribe_request.exchange, subscribe_request.exchange_type, false);
       // channel->DeclareExchange(subscribe_request.exchange,
       // subscribe_request.exchangeType, true, false, false);
       channel->DeclareQueue(subscribe_request.queue, false, false, false, false);
@@ -59,11 +104,13 @@ void RabbitMQClient::subscribe(const SubscribeRequest &subscribe_request, const
       LOG_INFO("[rabbit] Queue '{}' bound to exchange '{}' with key '{}'", subscribe_request.queue,
                subscribe_request.exchange, subscribe_request.routing_key);
 
-      const std::string consumer_tag = channel->BasicConsume(subscribe_request.queue, "", false, false, false);
+      const std::string consumer_tag =
+          channel->BasicConsume(subscribe_request.queue, "", false, false, false, kConsumerPrefetch);
       LOG_INFO("[rabbit] Subscribed to '{}':'{}' in queue '{}'", subscribe_request.exchange,
                subscribe_request.routing_key, subscribe_request.queue);
 
       while (running_) {
+        waitForPoolCapacity();
         AmqpClient::Envelope::ptr_t envelope;
         if (!channel->BasicConsumeMessage(consumer_tag, envelope, 200)) continue;
 
@@ -72,13 +119,22 @@ void RabbitMQClient::subscribe(const SubscribeRequest &subscribe_request, const
         LOG_INFO("[rabbit] Received payload: {}", payload);
         LOG_INFO("[rabbit] Received event: {}", event);
 
-        pool_->enqueue([callback, event, payload]() {
-          try {
-            callback(event, payload);
-          } catch (const std::exception &e) {
-            LOG_ERROR("[rabbit] Callback error: {}", e.what());
-          }
-        });
+        try {
+          // under OverflowPolicy::Block this waits for room, so the ack is held back too
+          pool_->post(
+              [callback, event = std::move(event), payload = std::move(payload)]() {
+                try {
+                  callback(event, payload);
+                } catch (const std::exception &e) {
+                  LOG_ERROR("[rabbit] Callback error: {}", e.what());
+                }
+              },
+              TaskPriority::Background);
+        } catch (const ThreadPoolFullError &e) {
+          LOG_WARN("[rabbit] {}, requeueing delivery of '{}'", e.what(), subscribe_request.queue);
+          channel->BasicReject(envelope, true);
+          continue;
+        }
 
         channel->BasicAck(envelope);
       }
@@ -91,6 +147,13 @@ void RabbitMQClient::subscribe(const SubscribeRequest &subscribe_request, const
   consumer_threads_.emplace_back(std::move(consumer_thread));
 }
 
+void RabbitMQClient::waitForPoolCapacity() const {
+  if (!pool_->saturated()) return;
+  LOG_WARN("[rabbit] Thread pool queue is full, pausing consumption");
+  while (running_ && pool_->saturated()) std::this_thread::sleep_for(kSaturatedBackoff);
+  LOG_INFO("[rabbit] Thread pool queue drained, resuming consumption");
+}
+
 void RabbitMQClient::stop() {
   running_ = false;
   std::scoped_lock lock(consumer_threads_mutex_);
@@ -0,0 +1,17 @@
+#ifndef BACKEND_REDISCACHE_CACHEBACKEND_H_
+#define BACKEND_REDISCACHE_CACHEBACKEND_H_
+
+#include <cstdint>
+
+#include "interfaces/ICacheService.h"
+
+enum class CacheBackend : std::uint8_t { Redis, Local };
+
+// CACHE_BACKEND=local selects LocalCache (single node, CI, offline benchmarks);
+// unset or "redis" keeps RedisCache. Unknown values fall back to Redis with a warning.
+CacheBackend cacheBackendFromEnv();
+
+// RedisCache::instance() or LocalCache::instance(); configure() the chosen one first
+ICacheService &cacheInstance(CacheBackend backend = cacheBackendFromEnv());
+
+#endif  // BACKEND_REDISCACHE_CACHEBACKEND_H_
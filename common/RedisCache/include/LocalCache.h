@@ -0,0 +1,94 @@
+#ifndef BACKEND_REDISCACHE_LOCALCACHE_H_
+#define BACKEND_REDISCACHE_LOCALCACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TtlPolicy.h"
+#include "interfaces/ICacheService.h"
+
+struct LocalCacheConfig {
+  std::size_t shards = 16;
+  std::size_t max_bytes = 256 * 1024 * 1024;  // whole cache, split evenly between shards
+  TtlPolicy ttl_policy;
+};
+
+struct LocalCacheStats {
+  std::uint64_t evictions{0};
+  std::uint64_t expirations{0};
+  std::uint64_t rejected{0};  // writes dropped because only keys without a ttl were left to evict
+  std::size_t entries{0};
+  std::size_t bytes{0};
+};
+
+// In-process ICacheService for single-node installs, tests and benchmarks, in
+// place of RedisCache. Keys are spread over mutex-guarded shards. Expired keys are
+// dropped when read and swept from a shard before it evicts. Like Redis with
+// volatile-lru, only keys that have a ttl are evicted (least recently used first):
+// incr counters such as table generations never disappear, since a counter
+// falling back to 0 could make old query cache entries look fresh again.
+class LocalCache : public ICacheService {
+ public:
+  // must run before the first instance() call; later calls are ignored
+  static void configure(LocalCacheConfig config);
+  static LocalCache &instance();
+
+  explicit LocalCache(LocalCacheConfig config = {});
+
+  void clearCache() override;
+  void remove(const std::string &key) override;
+  void incr(const std::string &key) override;
+  std::optional<std::string> get(const std::string &key) override;
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override;
+  void set(const std::string &key, const std::string &value, std::chrono::seconds ttl) override;
+  void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
+                    std::chrono::seconds ttl) override;
+  void setMany(const std::vector<CacheEntry> &entries) override;
+  void removeMany(const std::vector<std::string> &keys) override;
+  bool setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) override;
+
+  [[nodiscard]] LocalCacheStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string value;
+    std::optional<Clock::time_point> expires_at;
+    std::list<std::string>::iterator lru;  // only meaningful with expires_at
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;  // keys with a ttl, most recently used first
+    std::size_t bytes{0};
+  };
+
+  Shard &shardFor(const std::string &key);
+  void store(Shard &shard, const std::string &key, std::string value, std::optional<std::chrono::milliseconds> ttl);
+  void erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator it);
+  // the live entry of `key`, dropping it when it has expired
+  std::unordered_map<std::string, Entry>::iterator findLive(Shard &shard, const std::string &key);
+  void sweepExpired(Shard &shard);
+
+  static std::size_t footprint(const std::string &key, const std::string &value);
+
+  LocalCacheConfig config_;
+  std::size_t shard_budget_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<std::uint64_t> evictions_{0};
+  std::atomic<std::uint64_t> expirations_{0};
+  std::atomic<std::uint64_t> rejected_{0};
+};
+
+#endif  // BACKEND_REDISCACHE_LOCALCACHE_H_
@@ -0,0 +1,131 @@
+#ifndef BACKEND_REDISCACHE_NEARCACHE_H_
+#define BACKEND_REDISCACHE_NEARCACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "interfaces/ICacheService.h"
+
+struct NearCacheConfig {
+  std::size_t shards = 16;
+  std::size_t max_bytes = 64 * 1024 * 1024;  // whole L1, split evenly between shards
+  // upper bound for an L1 copy; bounds staleness when an invalidation is missed
+  std::chrono::milliseconds ttl{2000};
+  // only keys with one of these prefixes are kept in L1; empty keeps everything
+  std::vector<std::string> prefixes;
+};
+
+struct NearCacheStats {
+  std::uint64_t hits{0};
+  std::uint64_t misses{0};
+  std::uint64_t evictions{0};
+  std::uint64_t expirations{0};
+  std::uint64_t invalidations{0};
+  std::size_t entries{0};
+  std::size_t bytes{0};
+};
+
+// Two-tier ICacheService: a bounded, sharded in-process L1 in front of a remote
+// cache (L2, normally RedisCache). Reads are served from L1 while the copy is
+// younger than the L1 ttl; misses go to L2 and are copied into L1. Local writes,
+// remove and incr drop the L1 copy and are announced through the publisher, so
+// other instances can drop theirs (see RedisInvalidationChannel).
+class NearCache : public ICacheService {
+ public:
+  // every key changed by one call, so a batch write costs one message
+  using Publisher = std::function<void(const std::vector<std::string> &keys)>;
+
+  explicit NearCache(ICacheService &remote, NearCacheConfig config = {});
+
+  void clearCache() override;
+  void remove(const std::string &key) override;
+  void incr(const std::string &key) override;
+  std::optional<std::string> get(const std::string &key) override;
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override;
+  void set(const std::string &key, const std::string &value, std::chrono::seconds ttl) override;
+  void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
+                    std::chrono::seconds ttl) override;
+  void setMany(const std::vector<CacheEntry> &entries) override;
+  void removeMany(const std::vector<std::string> &keys) override;
+  void incrMany(const std::vector<std::string> &keys) override;
+  // lock keys are never kept in L1
+  bool setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) override;
+  // L1 hits come back as ready futures; misses go to the remote getManyAsync in
+  // one call and are stored in L1 when the returned future is read
+  std::future<std::optional<std::string>> getAsync(const std::string &key) override;
+  std::future<std::vector<std::optional<std::string>>> getManyAsync(const std::vector<std::string> &keys) override;
+  // L1 is updated right away; only the remote write is asynchronous
+  std::future<void> setAsync(const std::string &key, const std::string &value, std::chrono::seconds ttl) override;
+
+  // drops the L1 copy only; an empty key drops everything
+  void invalidate(const std::string &key);
+  // called with the keys this instance changed, once per call; an empty key means all keys
+  void setPublisher(Publisher publisher);
+
+  [[nodiscard]] NearCacheStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string value;
+    Clock::time_point expires_at;
+    std::list<std::string>::iterator lru;
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;  // most recently used first
+    std::size_t bytes{0};
+    // bumped whenever a key of the shard is written or invalidated, so an L2 read
+    // that raced with the change does not put the old value back into L1
+    std::uint64_t epoch{0};
+  };
+
+  // keys of a getMany that L1 could not answer, with the epochs seen by lookup
+  struct Misses {
+    std::vector<std::size_t> index;
+    std::vector<std::uint64_t> epochs;
+    std::vector<std::string> keys;
+  };
+
+  Shard &shardFor(const std::string &key);
+  [[nodiscard]] bool cacheable(const std::string &key) const;
+  std::optional<std::string> lookup(const std::string &key, std::uint64_t &epoch);
+  void store(const std::string &key, const std::string &value, std::chrono::seconds ttl,
+             std::optional<std::uint64_t> expected_epoch = std::nullopt);
+  void erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator it);
+  void dropLocal(const std::string &key);
+  void publish(const std::vector<std::string> &keys);
+  Misses lookupMany(const std::vector<std::string> &keys, std::vector<std::optional<std::string>> &values);
+  void fillMisses(const std::vector<std::string> &keys, std::vector<std::optional<std::string>> &values,
+                  const Misses &misses, std::vector<std::optional<std::string>> fetched);
+
+  static std::size_t footprint(const std::string &key, const std::string &value);
+
+  ICacheService &remote_;
+  NearCacheConfig config_;
+  std::size_t shard_budget_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::mutex publisher_mutex_;
+  Publisher publisher_;
+
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> misses_{0};
+  std::atomic<std::uint64_t> evictions_{0};
+  std::atomic<std::uint64_t> expirations_{0};
+  std::atomic<std::uint64_t> invalidations_{0};
+};
+
+#endif  // BACKEND_REDISCACHE_NEARCACHE_H_
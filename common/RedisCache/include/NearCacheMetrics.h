@@ -0,0 +1,26 @@
+#ifndef BACKEND_REDISCACHE_NEARCACHEMETRICS_H_
+#define BACKEND_REDISCACHE_NEARCACHEMETRICS_H_
+
+#include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+
+#include <string>
+#include <vector>
+
+#include "NearCache.h"
+
+// Prometheus view of NearCache::stats(), read at scrape time so the cache hot
+// path only touches its own relaxed counters. Register with
+// Exposer::RegisterCollectable, labelled by `cache`.
+class NearCacheMetrics : public prometheus::Collectable {
+ public:
+  NearCacheMetrics(const NearCache &cache, std::string name);
+
+  std::vector<prometheus::MetricFamily> Collect() const override;
+
+ private:
+  const NearCache &cache_;
+  std::string name_;
+};
+
+#endif  // BACKEND_REDISCACHE_NEARCACHEMETRICS_H_
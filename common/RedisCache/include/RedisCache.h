@@ -3,16 +3,44 @@
 
 #include <sw/redis++/redis.h>
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
 
+#include "TtlPolicy.h"
 #include "interfaces/ICacheService.h"
 
+class ThreadPool;
+
+struct RedisConfig {
+  std::string host = "127.0.0.1";
+  int port = 6379;
+  std::size_t pool_size = 8;
+  // how long a caller waits for a free pooled connection; 0 waits forever
+  std::chrono::milliseconds pool_wait_timeout{100};
+  std::chrono::milliseconds connect_timeout{100};
+  std::chrono::milliseconds socket_timeout{200};
+  bool keep_alive = true;
+  // threads running getAsync/getManyAsync/setAsync; at most pool_size are useful
+  std::size_t async_threads = 4;
+  // queued async calls; when full the oldest setAsync is dropped, and a get
+  // with no setAsync to drop runs on the calling thread
+  std::size_t async_queue_capacity = 1024;
+  // ttl written by set/setMany/setPipelines, per key family
+  TtlPolicy ttl_policy;
+};
+
 class RedisCache : public ICacheService {
  public:
+  // must run before the first instance() call; later calls are ignored
+  static void configure(RedisConfig config);
   static RedisCache &instance();
+
+  // standalone client, e.g. for benchmarks; services share instance()
+  explicit RedisCache(RedisConfig config);
+  ~RedisCache() override;
   RedisCache(const RedisCache &) = delete;
   RedisCache &operator=(const RedisCache &) = delete;
   RedisCache(RedisCache &&) = delete;
@@ -30,14 +58,30 @@ class RedisCache : public ICacheService {
 
   std::optional<std::string> get(const std::string &key) override;
 
+  std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) override;
+  void setMany(const std::vector<CacheEntry> &entries) override;
+  void removeMany(const std::vector<std::string> &keys) override;
+  void incrMany(const std::vector<std::string> &keys) override;
+  bool setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) override;
+
+  std::future<std::optional<std::string>> getAsync(const std::string &key) override;
+  std::future<std::vector<std::optional<std::string>>> getManyAsync(const std::vector<std::string> &keys) override;
+  std::future<void> setAsync(const std::string &key, const std::string &value, std::chrono::seconds ttl) override;
+
+  [[nodiscard]] const RedisConfig &config() const { return config_; }
+
  private:
-  std::unique_ptr<sw::redis::Redis> redis_;
+  RedisConfig config_;
   std::mutex init_mutex_;
+  std::unique_ptr<sw::redis::Redis> redis_;
+  // set once redis_ is connected: the fast path reads it without init_mutex_
+  std::atomic<sw::redis::Redis *> ready_{nullptr};
+  // declared after redis_ so that in-flight async calls finish before it is destroyed
+  std::unique_ptr<ThreadPool> io_pool_;
+  std::once_flag io_pool_once_;
 
   sw::redis::Redis &getRedis();
-  int getTtlWithJitter(std::chrono::seconds ttl);
-
-  RedisCache() = default;
+  ThreadPool &ioPool();
 };
 
 #endif  // BACKEND_REDISCACHE_REDISCACHE_H_
@@ -0,0 +1,42 @@
+#ifndef BACKEND_REDISCACHE_REDISINVALIDATIONCHANNEL_H_
+#define BACKEND_REDISCACHE_REDISINVALIDATIONCHANNEL_H_
+
+#include <sw/redis++/redis.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NearCache.h"
+#include "RedisCache.h"
+
+// Keeps the L1 of several NearCache instances coherent over Redis pub/sub: keys
+// changed locally are published on `channel`, and keys published by other
+// instances are dropped from the local L1. A message is "<instance id>\n<key>\n<key>..."
+// with every key of one NearCache call; an instance ignores its own. The whole L1 is dropped after every (re)subscribe,
+// since messages sent while disconnected are lost.
+class RedisInvalidationChannel {
+ public:
+  // connects to the Redis server of `config`, the one RedisCache talks to
+  RedisInvalidationChannel(NearCache &cache, std::string channel, const RedisConfig &config);
+  ~RedisInvalidationChannel();
+  RedisInvalidationChannel(const RedisInvalidationChannel &) = delete;
+  RedisInvalidationChannel &operator=(const RedisInvalidationChannel &) = delete;
+
+  void publish(const std::vector<std::string> &keys);
+
+ private:
+  void listen();
+  void onMessage(const std::string &message);
+
+  NearCache &cache_;
+  std::string channel_;
+  std::string instance_id_;
+  std::unique_ptr<sw::redis::Redis> redis_;
+  std::atomic<bool> running_{true};
+  std::thread listener_;
+};
+
+#endif  // BACKEND_REDISCACHE_REDISINVALIDATIONCHANNEL_H_
@@ -0,0 +1,41 @@
+#ifndef BACKEND_REDISCACHE_TTLPOLICY_H_
+#define BACKEND_REDISCACHE_TTLPOLICY_H_
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct TtlRule {
+  // 0 keeps the ttl the caller asked for; otherwise every key of the family gets this one
+  std::chrono::seconds base{0};
+  // proportional spread: the ttl is drawn uniformly from base * [1 - jitter, 1 + jitter]
+  double jitter = 0.1;
+  std::chrono::seconds min{1};
+  // 0 leaves the ttl uncapped; set it for the families a caller must not keep for long
+  std::chrono::seconds max{0};
+};
+
+// TTL that RedisCache actually writes for a key. Keys are grouped in families by
+// prefix ("query_cache:", "entity_cache:", ...); the longest matching prefix picks
+// the rule, other keys use the default one. The jitter spreads the expiry of keys
+// written together so they do not all expire in the same second. Rules are set
+// while configuring and only read afterwards; apply() is safe from any thread
+// and draws from a per-thread generator.
+class TtlPolicy {
+ public:
+  TtlPolicy() = default;
+  explicit TtlPolicy(TtlRule default_rule);
+
+  void setRule(std::string prefix, TtlRule rule);
+  [[nodiscard]] const TtlRule &ruleFor(std::string_view key) const;
+
+  [[nodiscard]] std::chrono::milliseconds apply(std::string_view key, std::chrono::milliseconds requested) const;
+
+ private:
+  TtlRule default_rule_;
+  std::vector<std::pair<std::string, TtlRule>> rules_;
+};
+
+#endif  // BACKEND_REDISCACHE_TTLPOLICY_H_
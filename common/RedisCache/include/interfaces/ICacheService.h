@@ -1,9 +1,18 @@
 #ifndef ICACHESERVICE_H
 #define ICACHESERVICE_H
 
+#include <chrono>
+#include <future>
+#include <optional>
 #include <string>
 #include <vector>
 
+struct CacheEntry {
+  std::string key;
+  std::string value;
+  std::chrono::seconds ttl;
+};
+
 class ICacheService {
  public:
   virtual ~ICacheService() = default;
@@ -11,9 +20,52 @@ class ICacheService {
   virtual void remove(const std::string &key) = 0;
   virtual void incr(const std::string &key) = 0;
   virtual std::optional<std::string> get(const std::string &key) = 0;
+  // one round trip; result[i] is the value of keys[i]
+  virtual std::vector<std::optional<std::string>> getMany(const std::vector<std::string> &keys) = 0;
   virtual void set(const std::string &key, const std::string &value, std::chrono::seconds ttl) = 0;
   virtual void setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
                             std::chrono::seconds ttl) = 0;
+  // one round trip each; setMany keeps every entry's own ttl
+  virtual void setMany(const std::vector<CacheEntry> &entries) = 0;
+  virtual void removeMany(const std::vector<std::string> &keys) = 0;
+
+  // INCR of every key in one round trip; the default issues them one by one
+  virtual void incrMany(const std::vector<std::string> &keys) {
+    for (const auto &key : keys) incr(key);
+  }
+
+  // SET NX with a ttl, for short cross-instance locks; true if this caller stored
+  // the key. Backends without a shared store cannot coordinate: every caller wins.
+  virtual bool setIfAbsent(const std::string & /*key*/, const std::string & /*value*/,
+                           std::chrono::milliseconds /*ttl*/) {
+    return true;
+  }
+
+  // Asynchronous variants, so callers can overlap cache I/O with other work. The
+  // defaults run synchronously and return a ready future; a discarded future
+  // does not block.
+  virtual std::future<std::optional<std::string>> getAsync(const std::string &key) {
+    return ready(get(key));
+  }
+
+  virtual std::future<std::vector<std::optional<std::string>>> getManyAsync(const std::vector<std::string> &keys) {
+    return ready(getMany(keys));
+  }
+
+  virtual std::future<void> setAsync(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
+    set(key, value, ttl);
+    std::promise<void> done;
+    done.set_value();
+    return done.get_future();
+  }
+
+ protected:
+  template <typename T>
+  static std::future<T> ready(T value) {
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future();
+  }
 };
 
 #endif  // ICACHESERVICE_H
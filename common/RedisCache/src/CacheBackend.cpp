@@ -0,0 +1,23 @@
+#include "CacheBackend.h"
+
+#include <cstdlib>
+#include <string_view>
+
+#include "Debug_profiling.h"
+#include "LocalCache.h"
+#include "RedisCache.h"
+
+CacheBackend cacheBackendFromEnv() {
+  const char *value = std::getenv("CACHE_BACKEND");
+  if (value == nullptr) return CacheBackend::Redis;
+
+  const std::string_view backend(value);
+  if (backend == "local") return CacheBackend::Local;
+  if (!backend.empty() && backend != "redis") LOG_WARN("Unknown CACHE_BACKEND '{}', using redis", backend);
+  return CacheBackend::Redis;
+}
+
+ICacheService &cacheInstance(CacheBackend backend) {
+  if (backend == CacheBackend::Local) return LocalCache::instance();
+  return RedisCache::instance();
+}
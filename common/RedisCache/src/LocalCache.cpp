@@ -0,0 +1,201 @@
+#include "LocalCache.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+#include "Debug_profiling.h"
+
+namespace {
+
+// rough per-entry cost of the map node, list node and two key copies besides the payload
+constexpr std::size_t kEntryOverhead = 96;
+
+std::mutex config_mutex;
+LocalCacheConfig configured;
+bool instance_created = false;
+
+}  // namespace
+
+void LocalCache::configure(LocalCacheConfig config) {
+  std::scoped_lock lock(config_mutex);
+  if (instance_created) {
+    LOG_WARN("LocalCache::configure called after the first instance() call, ignored");
+    return;
+  }
+  configured = std::move(config);
+}
+
+LocalCache &LocalCache::instance() {
+  static LocalCache inst([] {
+    std::scoped_lock lock(config_mutex);
+    instance_created = true;
+    return configured;
+  }());
+  return inst;
+}
+
+LocalCache::LocalCache(LocalCacheConfig config) : config_(std::move(config)) {
+  config_.shards = std::max<std::size_t>(config_.shards, 1);
+  shard_budget_ = config_.max_bytes / config_.shards;
+  shards_.reserve(config_.shards);
+  for (std::size_t i = 0; i < config_.shards; ++i) shards_.push_back(std::make_unique<Shard>());
+}
+
+std::size_t LocalCache::footprint(const std::string &key, const std::string &value) {
+  return 2 * key.size() + value.size() + kEntryOverhead;
+}
+
+LocalCache::Shard &LocalCache::shardFor(const std::string &key) {
+  return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void LocalCache::erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator it) {
+  shard.bytes -= footprint(it->first, it->second.value);
+  if (it->second.expires_at) shard.lru.erase(it->second.lru);
+  shard.entries.erase(it);
+}
+
+std::unordered_map<std::string, LocalCache::Entry>::iterator LocalCache::findLive(Shard &shard,
+                                                                                  const std::string &key) {
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end() || !it->second.expires_at || *it->second.expires_at > Clock::now()) return it;
+  erase(shard, it);
+  expirations_.fetch_add(1, std::memory_order_relaxed);
+  return shard.entries.end();
+}
+
+void LocalCache::sweepExpired(Shard &shard) {
+  const auto now = Clock::now();
+  for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+    auto next = std::next(it);
+    if (it->second.expires_at && *it->second.expires_at <= now) {
+      erase(shard, it);
+      expirations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    it = next;
+  }
+}
+
+void LocalCache::store(Shard &shard, const std::string &key, std::string value,
+                       std::optional<std::chrono::milliseconds> ttl) {
+  const std::size_t size = footprint(key, value);
+  if (auto it = shard.entries.find(key); it != shard.entries.end()) erase(shard, it);
+
+  if (shard.bytes + size > shard_budget_) sweepExpired(shard);
+  while (shard.bytes + size > shard_budget_ && !shard.lru.empty()) {
+    erase(shard, shard.entries.find(shard.lru.back()));
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // keys without a ttl (incr counters) are kept even over budget
+  if (shard.bytes + size > shard_budget_ && ttl) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN("[LocalCache] No room for '{}' ({} bytes), dropped", key, size);
+    return;
+  }
+
+  Entry entry;
+  entry.value = std::move(value);
+  if (ttl) {
+    shard.lru.push_front(key);
+    entry.expires_at = Clock::now() + *ttl;
+    entry.lru = shard.lru.begin();
+  }
+  shard.entries.emplace(key, std::move(entry));
+  shard.bytes += size;
+}
+
+void LocalCache::clearCache() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->entries.clear();
+    shard->lru.clear();
+    shard->bytes = 0;
+  }
+}
+
+void LocalCache::remove(const std::string &key) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (auto it = shard.entries.find(key); it != shard.entries.end()) erase(shard, it);
+}
+
+void LocalCache::incr(const std::string &key) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = findLive(shard, key);
+  if (it == shard.entries.end()) {
+    store(shard, key, "1", std::nullopt);
+    return;
+  }
+
+  // like INCR: the value must be an integer and the key keeps its ttl
+  auto &value = it->second.value;
+  long long current = 0;
+  auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), current);
+  if (error != std::errc{} || end != value.data() + value.size()) {
+    LOG_ERROR("Error to incr key: {} - value is not an integer", key);
+    return;
+  }
+  shard.bytes -= footprint(key, value);
+  value = std::to_string(current + 1);
+  shard.bytes += footprint(key, value);
+}
+
+std::optional<std::string> LocalCache::get(const std::string &key) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = findLive(shard, key);
+  if (it == shard.entries.end()) return std::nullopt;
+  if (it->second.expires_at) shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+  return it->second.value;
+}
+
+std::vector<std::optional<std::string>> LocalCache::getMany(const std::vector<std::string> &keys) {
+  std::vector<std::optional<std::string>> values;
+  values.reserve(keys.size());
+  for (const auto &key : keys) values.push_back(get(key));
+  return values;
+}
+
+void LocalCache::set(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
+  const auto applied_ttl = config_.ttl_policy.apply(key, ttl);
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  store(shard, key, value, applied_ttl);
+}
+
+void LocalCache::setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
+                              std::chrono::seconds ttl) {
+  for (std::size_t i = 0; i < keys.size() && i < results.size(); ++i) set(keys[i], results[i], ttl);
+}
+
+void LocalCache::setMany(const std::vector<CacheEntry> &entries) {
+  for (const auto &entry : entries) set(entry.key, entry.value, entry.ttl);
+}
+
+void LocalCache::removeMany(const std::vector<std::string> &keys) {
+  for (const auto &key : keys) remove(key);
+}
+
+bool LocalCache::setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (findLive(shard, key) != shard.entries.end()) return false;
+  store(shard, key, value, std::max(ttl, std::chrono::milliseconds{1}));
+  return true;
+}
+
+LocalCacheStats LocalCache::stats() const {
+  LocalCacheStats stats{
+      .evictions = evictions_.load(std::memory_order_relaxed),
+      .expirations = expirations_.load(std::memory_order_relaxed),
+      .rejected = rejected_.load(std::memory_order_relaxed),
+  };
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->entries.size();
+    stats.bytes += shard->bytes;
+  }
+  return stats;
+}
@@ -0,0 +1,311 @@
+#include "NearCache.h"
+
+#include <algorithm>
+#include <future>
+#include <utility>
+
+#include "Debug_profiling.h"
+
+namespace {
+
+// rough per-entry cost of the map node, list node and two key copies besides the payload
+constexpr std::size_t kEntryOverhead = 96;
+
+}  // namespace
+
+NearCache::NearCache(ICacheService &remote, NearCacheConfig config)
+    : remote_(remote), config_(std::move(config)) {
+  config_.shards = std::max<std::size_t>(config_.shards, 1);
+  shard_budget_ = config_.max_bytes / config_.shards;
+  shards_.reserve(config_.shards);
+  for (std::size_t i = 0; i < config_.shards; ++i) shards_.push_back(std::make_unique<Shard>());
+}
+
+std::size_t NearCache::footprint(const std::string &key, const std::string &value) {
+  return 2 * key.size() + value.size() + kEntryOverhead;
+}
+
+NearCache::Shard &NearCache::shardFor(const std::string &key) {
+  return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+bool NearCache::cacheable(const std::string &key) const {
+  if (config_.prefixes.empty()) return true;
+  return std::ranges::any_of(config_.prefixes, [&](const std::string &prefix) { return key.starts_with(prefix); });
+}
+
+void NearCache::erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator it) {
+  shard.bytes -= footprint(it->first, it->second.value);
+  shard.lru.erase(it->second.lru);
+  shard.entries.erase(it);
+}
+
+std::optional<std::string> NearCache::lookup(const std::string &key, std::uint64_t &epoch) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  epoch = shard.epoch;
+
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) return std::nullopt;
+  if (it->second.expires_at <= Clock::now()) {
+    erase(shard, it);
+    expirations_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+  return it->second.value;
+}
+
+void NearCache::store(const std::string &key, const std::string &value, std::chrono::seconds ttl,
+                      std::optional<std::uint64_t> expected_epoch) {
+  const std::size_t size = footprint(key, value);
+  if (size > shard_budget_) return;
+
+  auto lifetime = std::chrono::duration_cast<std::chrono::milliseconds>(ttl);
+  lifetime = lifetime.count() > 0 ? std::min(lifetime, config_.ttl) : config_.ttl;
+
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (expected_epoch && *expected_epoch != shard.epoch) return;
+  if (!expected_epoch) ++shard.epoch;
+
+  if (auto it = shard.entries.find(key); it != shard.entries.end()) erase(shard, it);
+
+  while (shard.bytes + size > shard_budget_ && !shard.lru.empty()) {
+    erase(shard, shard.entries.find(shard.lru.back()));
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  shard.lru.push_front(key);
+  shard.entries.emplace(key, Entry{.value = value, .expires_at = Clock::now() + lifetime, .lru = shard.lru.begin()});
+  shard.bytes += size;
+}
+
+void NearCache::dropLocal(const std::string &key) {
+  auto &shard = shardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  ++shard.epoch;
+  if (auto it = shard.entries.find(key); it != shard.entries.end()) erase(shard, it);
+}
+
+void NearCache::invalidate(const std::string &key) {
+  invalidations_.fetch_add(1, std::memory_order_relaxed);
+  if (!key.empty()) {
+    dropLocal(key);
+    return;
+  }
+
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    ++shard->epoch;
+    shard->entries.clear();
+    shard->lru.clear();
+    shard->bytes = 0;
+  }
+}
+
+void NearCache::setPublisher(Publisher publisher) {
+  std::lock_guard<std::mutex> lock(publisher_mutex_);
+  publisher_ = std::move(publisher);
+}
+
+void NearCache::publish(const std::vector<std::string> &keys) {
+  if (keys.empty()) return;
+  Publisher publisher;
+  {
+    std::lock_guard<std::mutex> lock(publisher_mutex_);
+    publisher = publisher_;
+  }
+  if (!publisher) return;
+  try {
+    publisher(keys);
+  } catch (const std::exception &e) {
+    LOG_WARN("[NearCache] Failed to publish invalidation of {} keys: {}", keys.size(), e.what());
+  }
+}
+
+void NearCache::clearCache() {
+  remote_.clearCache();
+  invalidate({});
+  publish({std::string()});
+}
+
+void NearCache::remove(const std::string &key) {
+  remote_.remove(key);
+  if (!cacheable(key)) return;
+  dropLocal(key);
+  publish({key});
+}
+
+void NearCache::incr(const std::string &key) {
+  remote_.incr(key);
+  if (!cacheable(key)) return;
+  dropLocal(key);
+  publish({key});
+}
+
+std::optional<std::string> NearCache::get(const std::string &key) {
+  if (!cacheable(key)) return remote_.get(key);
+
+  std::uint64_t epoch = 0;
+  if (auto value = lookup(key, epoch)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return value;
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  auto value = remote_.get(key);
+  if (value) store(key, *value, std::chrono::seconds{0}, epoch);
+  return value;
+}
+
+std::vector<std::optional<std::string>> NearCache::getMany(const std::vector<std::string> &keys) {
+  std::vector<std::optional<std::string>> values(keys.size());
+  const auto misses = lookupMany(keys, values);
+  if (misses.keys.empty()) return values;
+
+  fillMisses(keys, values, misses, remote_.getMany(misses.keys));
+  return values;
+}
+
+std::future<std::optional<std::string>> NearCache::getAsync(const std::string &key) {
+  if (!cacheable(key)) return remote_.getAsync(key);
+
+  std::uint64_t epoch = 0;
+  if (auto value = lookup(key, epoch)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return ready(std::move(value));
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return std::async(std::launch::deferred, [this, key, epoch, pending = remote_.getManyAsync({key})]() mutable {
+    auto fetched = pending.get();
+    std::optional<std::string> value = fetched.empty() ? std::nullopt : std::move(fetched[0]);
+    if (value) store(key, *value, std::chrono::seconds{0}, epoch);
+    return value;
+  });
+}
+
+std::future<std::vector<std::optional<std::string>>> NearCache::getManyAsync(const std::vector<std::string> &keys) {
+  std::vector<std::optional<std::string>> values(keys.size());
+  auto misses = lookupMany(keys, values);
+  if (misses.keys.empty()) return ready(std::move(values));
+
+  auto pending = remote_.getManyAsync(misses.keys);
+  return std::async(std::launch::deferred, [this, keys, values = std::move(values), misses = std::move(misses),
+                                            pending = std::move(pending)]() mutable {
+    fillMisses(keys, values, misses, pending.get());
+    return std::move(values);
+  });
+}
+
+NearCache::Misses NearCache::lookupMany(const std::vector<std::string> &keys,
+                                        std::vector<std::optional<std::string>> &values) {
+  Misses misses;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    std::uint64_t epoch = 0;
+    if (cacheable(keys[i])) {
+      if ((values[i] = lookup(keys[i], epoch))) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    misses.index.push_back(i);
+    misses.epochs.push_back(epoch);
+    misses.keys.push_back(keys[i]);
+  }
+  return misses;
+}
+
+void NearCache::fillMisses(const std::vector<std::string> &keys, std::vector<std::optional<std::string>> &values,
+                           const Misses &misses, std::vector<std::optional<std::string>> fetched) {
+  fetched.resize(misses.keys.size());
+  for (std::size_t j = 0; j < misses.index.size(); ++j) {
+    const std::size_t i = misses.index[j];
+    values[i] = std::move(fetched[j]);
+    if (values[i] && cacheable(keys[i])) store(keys[i], *values[i], std::chrono::seconds{0}, misses.epochs[j]);
+  }
+}
+
+void NearCache::set(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
+  remote_.set(key, value, ttl);
+  if (!cacheable(key)) return;
+  store(key, value, ttl);
+  publish({key});
+}
+
+void NearCache::setMany(const std::vector<CacheEntry> &entries) {
+  remote_.setMany(entries);
+  std::vector<std::string> changed;
+  for (const auto &entry : entries) {
+    if (!cacheable(entry.key)) continue;
+    store(entry.key, entry.value, entry.ttl);
+    changed.push_back(entry.key);
+  }
+  publish(changed);
+}
+
+void NearCache::removeMany(const std::vector<std::string> &keys) {
+  remote_.removeMany(keys);
+  std::vector<std::string> changed;
+  for (const auto &key : keys) {
+    if (!cacheable(key)) continue;
+    dropLocal(key);
+    changed.push_back(key);
+  }
+  publish(changed);
+}
+
+void NearCache::incrMany(const std::vector<std::string> &keys) {
+  remote_.incrMany(keys);
+  std::vector<std::string> changed;
+  for (const auto &key : keys) {
+    if (!cacheable(key)) continue;
+    dropLocal(key);
+    changed.push_back(key);
+  }
+  publish(changed);
+}
+
+bool NearCache::setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) {
+  return remote_.setIfAbsent(key, value, ttl);
+}
+
+std::future<void> NearCache::setAsync(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
+  auto done = remote_.setAsync(key, value, ttl);
+  if (cacheable(key)) {
+    store(key, value, ttl);
+    publish({key});
+  }
+  return done;
+}
+
+void NearCache::setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
+                             std::chrono::seconds ttl) {
+  remote_.setPipelines(keys, results, ttl);
+  std::vector<std::string> changed;
+  for (std::size_t i = 0; i < keys.size() && i < results.size(); ++i) {
+    if (!cacheable(keys[i])) continue;
+    store(keys[i], results[i], ttl);
+    changed.push_back(keys[i]);
+  }
+  publish(changed);
+}
+
+NearCacheStats NearCache::stats() const {
+  NearCacheStats stats{
+      .hits = hits_.load(std::memory_order_relaxed),
+      .misses = misses_.load(std::memory_order_relaxed),
+      .evictions = evictions_.load(std::memory_order_relaxed),
+      .expirations = expirations_.load(std::memory_order_relaxed),
+      .invalidations = invalidations_.load(std::memory_order_relaxed),
+  };
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->entries.size();
+    stats.bytes += shard->bytes;
+  }
+  return stats;
+}
@@ -0,0 +1,47 @@
+#include "NearCacheMetrics.h"
+
+#include <prometheus/client_metric.h>
+
+#include <utility>
+
+namespace {
+
+prometheus::MetricFamily family(const std::string &name, const std::string &help, prometheus::MetricType type,
+                                const std::string &cache, double value) {
+  prometheus::ClientMetric metric;
+  metric.label.push_back({"cache", cache});
+  if (type == prometheus::MetricType::Counter) {
+    metric.counter.value = value;
+  } else {
+    metric.gauge.value = value;
+  }
+  return prometheus::MetricFamily{name, help, type, {std::move(metric)}};
+}
+
+}  // namespace
+
+NearCacheMetrics::NearCacheMetrics(const NearCache &cache, std::string name) : cache_(cache), name_(std::move(name)) {}
+
+std::vector<prometheus::MetricFamily> NearCacheMetrics::Collect() const {
+  using prometheus::MetricType;
+  const NearCacheStats stats = cache_.stats();
+  const auto lookups = stats.hits + stats.misses;
+  const double hit_ratio = lookups == 0 ? 0.0 : static_cast<double>(stats.hits) / static_cast<double>(lookups);
+
+  return {
+      family("near_cache_hits_total", "Reads served from the in-process L1", MetricType::Counter, name_,
+             static_cast<double>(stats.hits)),
+      family("near_cache_misses_total", "Reads that went to the remote cache", MetricType::Counter, name_,
+             static_cast<double>(stats.misses)),
+      family("near_cache_hit_ratio", "hits / (hits + misses) since start", MetricType::Gauge, name_, hit_ratio),
+      family("near_cache_evictions_total", "Entries evicted to stay within the byte budget", MetricType::Counter,
+             name_, static_cast<double>(stats.evictions)),
+      family("near_cache_expirations_total", "Entries dropped because their L1 ttl ran out", MetricType::Counter,
+             name_, static_cast<double>(stats.expirations)),
+      family("near_cache_invalidations_total", "Local and remote invalidations applied to L1", MetricType::Counter,
+             name_, static_cast<double>(stats.invalidations)),
+      family("near_cache_entries", "Entries held in L1", MetricType::Gauge, name_, static_cast<double>(stats.entries)),
+      family("near_cache_bytes", "Estimated L1 memory in bytes", MetricType::Gauge, name_,
+             static_cast<double>(stats.bytes)),
+  };
+}
@@ -5,11 +5,11 @@
 #include <exception>
 #include <iterator>
 #include <optional>
-#include <random>
 #include <stdexcept>
 #include <vector>
 
 #include "Debug_profiling.h"
+#include "threadpool.h"
 #include "sw/redis++/errors.h"
 #include "sw/redis++/queued_redis.h"
 // #include "sw/redis++/queued_redis.hpp"
@@ -17,21 +17,24 @@
 
 namespace {
 
-template <typename Duration>
-std::chrono::seconds getRangedTtl(Duration ttl) {
-  const auto base_ms = std::chrono::duration_cast<std::chrono::seconds>(ttl).count();
-  constexpr int kMinTimeOfTtl = 300;
+std::mutex config_mutex;
+RedisConfig configured;
+bool instance_created = false;
 
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> dist(-30 * 60 * 1000,
-                                          30 * 60 * 1000);  // +-30 min in ms
-  const int jitter_ms = dist(gen);
+}  // namespace
 
-  return std::chrono::seconds(std::max(static_cast<int>(base_ms + jitter_ms), kMinTimeOfTtl));
+void RedisCache::configure(RedisConfig config) {
+  std::scoped_lock lock(config_mutex);
+  if (instance_created) {
+    LOG_WARN("RedisCache::configure called after the first instance() call, ignored");
+    return;
+  }
+  configured = std::move(config);
 }
 
-}  // namespace
+RedisCache::RedisCache(RedisConfig config) : config_(std::move(config)) {}
+
+RedisCache::~RedisCache() = default;
 
 void RedisCache::remove(const std::string &key) {
   try {
@@ -41,34 +44,69 @@ void RedisCache::remove(const std::string &key) {
   }
 }
 
-void RedisCache::incr(const std::string &key) { redis_->incr(key); }
+void RedisCache::incr(const std::string &key) {
+  try {
+    getRedis().incr(key);
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error to incr key: {} - error {}", key, e.what());
+  }
+}
 
 RedisCache &RedisCache::instance() {
-  static RedisCache inst;
+  static RedisCache inst([] {
+    std::scoped_lock lock(config_mutex);
+    instance_created = true;
+    return configured;
+  }());
   return inst;
 }
 
 sw::redis::Redis &RedisCache::getRedis() {
+  if (auto *redis = ready_.load(std::memory_order_acquire)) return *redis;
+
   std::scoped_lock lock(init_mutex_);
   if (!redis_) {
+    sw::redis::ConnectionOptions options;
+    options.host = config_.host;
+    options.port = config_.port;
+    options.connect_timeout = config_.connect_timeout;
+    options.socket_timeout = config_.socket_timeout;
+    options.keep_alive = config_.keep_alive;
+
+    sw::redis::ConnectionPoolOptions pool_options;
+    pool_options.size = config_.pool_size;
+    pool_options.wait_timeout = config_.pool_wait_timeout;
+
     try {
-      redis_ = std::make_unique<sw::redis::Redis>("tcp://127.0.0.1:6379");
+      redis_ = std::make_unique<sw::redis::Redis>(options, pool_options);
     } catch (const std::exception &e) {
       throw std::runtime_error(std::string("Redis init failed: ") + e.what());
     }
+    LOG_INFO("Redis client for {}:{} with {} pooled connections", config_.host, config_.port, config_.pool_size);
+    ready_.store(redis_.get(), std::memory_order_release);
   }
   return *redis_;
 }
 
+ThreadPool &RedisCache::ioPool() {
+  std::call_once(io_pool_once_, [this] {
+    io_pool_ = std::make_unique<ThreadPool>(
+        std::max<std::size_t>(config_.async_threads, 1),
+        ThreadPoolLimits{.capacity = config_.async_queue_capacity, .policy = OverflowPolicy::DropOldestLow});
+  });
+  return *io_pool_;
+}
+
 void RedisCache::set(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
   try {
-    auto ranged_ttl = getRangedTtl(ttl);
-    getRedis().set(key, value, ranged_ttl);
-    LOG_INFO("Set {} - {} for {} seconds", key, value, ranged_ttl.count());
+    const auto applied_ttl = config_.ttl_policy.apply(key, ttl);
+    getRedis().set(key, value, applied_ttl);
+    // values are binary cache payloads, so only their size is logged
+    LOG_DEBUG("Set {} ({} bytes) for {} ms", key, value.size(), applied_ttl.count());
   } catch (const std::exception &e) {
-    LOG_ERROR("Error whyle set {} and value {} - error", key, value, e.what());
+    LOG_ERROR("Error whyle set {} ({} bytes) - error {}", key, value.size(), e.what());
   } catch (...) {
-    LOG_ERROR("Invalid Error whyle set {} and value {}", key, value);
+    LOG_ERROR("Invalid Error whyle set {} ({} bytes)", key, value.size());
   }
 }
 
@@ -77,35 +115,118 @@ std::optional<std::string> RedisCache::get(const std::string &key) {
     // if (auto value = getRedis().get(key)) return *value;
     return getRedis().get(key);
   } catch (const std::exception &e) {
-    LOG_ERROR("Error whyle get {} and value {} - error", key, e.what());
+    LOG_ERROR("Error whyle get {} - error {}", key, e.what());
     return std::nullopt;
   } catch (...) {
-    LOG_ERROR("Invalid Error whyle get {} and value", key);
+    LOG_ERROR("Invalid Error whyle get {}", key);
     return std::nullopt;
   }
 
   return std::nullopt;
 }
 
+std::vector<std::optional<std::string>> RedisCache::getMany(const std::vector<std::string> &keys) {
+  std::vector<std::optional<std::string>> values;
+  if (keys.empty()) return values;
+  values.reserve(keys.size());
+  try {
+    getRedis().mget(keys.begin(), keys.end(), std::back_inserter(values));
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error whyle mget {} keys - error {}", keys.size(), e.what());
+    values.assign(keys.size(), std::nullopt);
+  }
+  return values;
+}
+
+void RedisCache::setMany(const std::vector<CacheEntry> &entries) {
+  if (entries.empty()) return;
+  try {
+    // borrows a pooled connection instead of opening a new one per call
+    auto pipe = getRedis().pipeline(false);
+    for (const auto &entry : entries) pipe.set(entry.key, entry.value, config_.ttl_policy.apply(entry.key, entry.ttl));
+    pipe.exec();
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error whyle set {} keys - error {}", entries.size(), e.what());
+  }
+}
+
+void RedisCache::removeMany(const std::vector<std::string> &keys) {
+  if (keys.empty()) return;
+  try {
+    getRedis().del(keys.begin(), keys.end());
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error to delete {} keys - error {}", keys.size(), e.what());
+  }
+}
+
+void RedisCache::incrMany(const std::vector<std::string> &keys) {
+  if (keys.empty()) return;
+  try {
+    auto pipe = getRedis().pipeline(false);
+    for (const auto &key : keys) pipe.incr(key);
+    pipe.exec();
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error to incr {} keys - error {}", keys.size(), e.what());
+  }
+}
+
+bool RedisCache::setIfAbsent(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) {
+  try {
+    return getRedis().set(key, value, ttl, sw::redis::UpdateType::NOT_EXIST);
+  } catch (const std::exception &e) {
+    // fail open: the caller loads by itself rather than waiting for nobody
+    LOG_ERROR("Error to set {} if absent - error {}", key, e.what());
+    return true;
+  }
+}
+
 void RedisCache::setPipelines(const std::vector<std::string> &keys, const std::vector<std::string> &results,
                               std::chrono::seconds ttl) {
   try {
     assert(keys.size() == results.size() || keys.size() == 1);
 
-    auto pipe = redis_->pipeline();
+    auto pipe = getRedis().pipeline(false);
 
     for (size_t i = 0; i < keys.size(); ++i) {
       const std::string &key = keys.size() == 1 ? keys[0] : keys[i];
       const std::string &value = results[i];
-      pipe.set(key, value, ttl);
+      pipe.set(key, value, config_.ttl_policy.apply(key, ttl));
     }
 
     pipe.exec();
-  } catch (const sw::redis::Error &e) {
+  } catch (const std::exception &e) {
     LOG_ERROR("Error set pipline {}", e.what());
   } catch (...) {
-    LOG_ERROR("Invalid Error set pipline {}");
+    LOG_ERROR("Invalid Error set pipline");
   }
 }
 
-void RedisCache::clearCache() { redis_->flushall(); }
+void RedisCache::clearCache() {
+  try {
+    getRedis().flushall();
+  } catch (const std::exception &e) {
+    LOG_ERROR("Error flushall - error {}", e.what());
+  }
+}
+
+// get/getMany/set never throw, so the get futures always hold a value; a setAsync
+// shed by a full pool leaves its future with a broken_promise error
+std::future<std::optional<std::string>> RedisCache::getAsync(const std::string &key) {
+  try {
+    return ioPool().submit([this, key] { return get(key); }, TaskPriority::Interactive);
+  } catch (const ThreadPoolFullError &) {
+    return ready(get(key));
+  }
+}
+
+std::future<std::vector<std::optional<std::string>>> RedisCache::getManyAsync(const std::vector<std::string> &keys) {
+  try {
+    return ioPool().submit([this, keys] { return getMany(keys); }, TaskPriority::Interactive);
+  } catch (const ThreadPoolFullError &) {
+    return ready(getMany(keys));
+  }
+}
+
+std::future<void> RedisCache::setAsync(const std::string &key, const std::string &value, std::chrono::seconds ttl) {
+  return ioPool().submit([this, key, value, ttl] { set(key, value, ttl); }, TaskPriority::Low);
+}
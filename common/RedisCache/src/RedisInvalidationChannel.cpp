@@ -0,0 +1,103 @@
+#include "RedisInvalidationChannel.h"
+
+#include <chrono>
+#include <random>
+#include <string_view>
+#include <utility>
+
+#include "Debug_profiling.h"
+#include "sw/redis++/errors.h"
+
+namespace {
+
+// how often the listener wakes up to check whether it should stop
+constexpr auto kListenTimeout = std::chrono::milliseconds(200);
+constexpr auto kReconnectDelay = std::chrono::milliseconds(500);
+
+std::string makeInstanceId() {
+  std::random_device rd;
+  std::mt19937_64 gen(rd());
+  return std::to_string(gen());
+}
+
+}  // namespace
+
+RedisInvalidationChannel::RedisInvalidationChannel(NearCache &cache, std::string channel, const RedisConfig &config)
+    : cache_(cache), channel_(std::move(channel)), instance_id_(makeInstanceId()) {
+  sw::redis::ConnectionOptions options;
+  options.host = config.host;
+  options.port = config.port;
+  options.connect_timeout = config.connect_timeout;
+  options.socket_timeout = kListenTimeout;
+  options.keep_alive = config.keep_alive;
+
+  // writers publish concurrently, so they get the same number of connections as RedisCache
+  sw::redis::ConnectionPoolOptions pool_options;
+  pool_options.size = config.pool_size;
+  pool_options.wait_timeout = config.pool_wait_timeout;
+  redis_ = std::make_unique<sw::redis::Redis>(options, pool_options);
+
+  cache_.setPublisher([this](const std::vector<std::string> &keys) { publish(keys); });
+  listener_ = std::thread([this] { listen(); });
+}
+
+RedisInvalidationChannel::~RedisInvalidationChannel() {
+  cache_.setPublisher({});
+  running_ = false;
+  if (listener_.joinable()) listener_.join();
+}
+
+void RedisInvalidationChannel::publish(const std::vector<std::string> &keys) {
+  std::string message = instance_id_;
+  for (const auto &key : keys) {
+    message += '\n';
+    message += key;
+  }
+
+  try {
+    redis_->publish(channel_, message);
+  } catch (const sw::redis::Error &e) {
+    LOG_WARN("[NearCache] Publish to {} failed: {}", channel_, e.what());
+  }
+}
+
+void RedisInvalidationChannel::onMessage(const std::string &message) {
+  auto separator = message.find('\n');
+  if (separator == std::string::npos) return;
+  if (std::string_view(message).substr(0, separator) == instance_id_) return;
+
+  while (separator != std::string::npos) {
+    const auto start = separator + 1;
+    separator = message.find('\n', start);
+    // an empty key drops the whole L1
+    cache_.invalidate(message.substr(start, separator == std::string::npos ? std::string::npos : separator - start));
+  }
+}
+
+void RedisInvalidationChannel::listen() {
+  while (running_) {
+    try {
+      auto subscriber = redis_->subscriber();
+      subscriber.on_message(
+          [this](const std::string & /*channel*/, const std::string &message) { onMessage(message); });
+      subscriber.on_meta([this](sw::redis::Subscriber::MsgType type, sw::redis::OptionalString /*channel*/,
+                                long long /*count*/) {
+        if (type != sw::redis::Subscriber::MsgType::SUBSCRIBE) return;
+        cache_.invalidate({});
+        LOG_INFO("[NearCache] Listening for invalidations on {}", channel_);
+      });
+      subscriber.subscribe(channel_);
+
+      while (running_) {
+        try {
+          subscriber.consume();
+        } catch (const sw::redis::TimeoutError &) {
+        }
+      }
+    } catch (const sw::redis::Error &e) {
+      LOG_WARN("[NearCache] Invalidation channel {} lost: {}", channel_, e.what());
+      cache_.invalidate({});
+      std::this_thread::sleep_for(kReconnectDelay);
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#include "TtlPolicy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+namespace {
+
+std::mt19937_64 &threadRng() {
+  thread_local std::mt19937_64 rng{std::random_device{}()};
+  return rng;
+}
+
+}  // namespace
+
+TtlPolicy::TtlPolicy(TtlRule default_rule) : default_rule_(default_rule) {
+  assert(default_rule_.max.count() == 0 || default_rule_.min <= default_rule_.max);
+}
+
+void TtlPolicy::setRule(std::string prefix, TtlRule rule) {
+  assert(rule.max.count() == 0 || rule.min <= rule.max);
+  assert(rule.jitter >= 0 && rule.jitter < 1);
+  auto it = std::ranges::find(rules_, prefix, &std::pair<std::string, TtlRule>::first);
+  if (it != rules_.end()) {
+    it->second = rule;
+  } else {
+    rules_.emplace_back(std::move(prefix), rule);
+  }
+}
+
+const TtlRule &TtlPolicy::ruleFor(std::string_view key) const {
+  const TtlRule *rule = &default_rule_;
+  std::size_t matched = 0;
+  for (const auto &[prefix, family_rule] : rules_) {
+    if (prefix.size() >= matched && key.starts_with(prefix)) {
+      rule = &family_rule;
+      matched = prefix.size();
+    }
+  }
+  return *rule;
+}
+
+std::chrono::milliseconds TtlPolicy::apply(std::string_view key, std::chrono::milliseconds requested) const {
+  const TtlRule &rule = ruleFor(key);
+  const auto base = rule.base.count() > 0 ? std::chrono::milliseconds(rule.base) : requested;
+
+  auto ttl = base;
+  if (rule.jitter > 0) {
+    std::uniform_real_distribution<double> spread(1.0 - rule.jitter, 1.0 + rule.jitter);
+    ttl = std::chrono::milliseconds(std::llround(static_cast<double>(base.count()) * spread(threadRng())));
+  }
+  ttl = std::max(ttl, std::chrono::milliseconds(rule.min));
+  return rule.max.count() > 0 ? std::min(ttl, std::chrono::milliseconds(rule.max)) : ttl;
+}
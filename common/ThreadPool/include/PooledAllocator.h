@@ -0,0 +1,56 @@
+#ifndef COMMON_THREADPOOL_POOLEDALLOCATOR_H_
+#define COMMON_THREADPOOL_POOLEDALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+
+// Per-thread cache of fixed-size blocks behind PooledAllocator. A freed block goes
+// to the cache of the thread that frees it, up to kMaxCachedBlocks; bigger or
+// over-aligned requests go straight to operator new.
+namespace task_block_cache {
+
+constexpr std::size_t kBlockSize = 128;        // a promise state and its result slot are 16-64 bytes
+constexpr std::size_t kMaxCachedBlocks = 4096;  // two blocks per outstanding submit(), at most 512 KB
+
+void *allocate(std::size_t bytes);
+void deallocate(void *block, std::size_t bytes) noexcept;
+
+}  // namespace task_block_cache
+
+// Allocator for the std::promise shared state of IThreadPool::submit, so a task
+// with a result does not cost two fresh heap allocations.
+template <typename T>
+struct PooledAllocator {
+  using value_type = T;
+
+  PooledAllocator() noexcept = default;
+  template <typename U>
+  PooledAllocator(const PooledAllocator<U> &) noexcept {}  // NOLINT(google-explicit-constructor): rebind
+
+  T *allocate(std::size_t n) {
+    if constexpr (alignof(T) > alignof(std::max_align_t)) {
+      return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    } else {
+      return static_cast<T *>(task_block_cache::allocate(n * sizeof(T)));
+    }
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    if constexpr (alignof(T) > alignof(std::max_align_t)) {
+      ::operator delete(p, std::align_val_t{alignof(T)});
+    } else {
+      task_block_cache::deallocate(p, n * sizeof(T));
+    }
+  }
+
+  template <typename U>
+  bool operator==(const PooledAllocator<U> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const PooledAllocator<U> &) const noexcept {
+    return false;
+  }
+};
+
+#endif  // COMMON_THREADPOOL_POOLEDALLOCATOR_H_
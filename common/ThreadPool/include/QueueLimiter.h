@@ -0,0 +1,84 @@
+#ifndef COMMON_THREADPOOL_QUEUELIMITER_H_
+#define COMMON_THREADPOOL_QUEUELIMITER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+
+enum class OverflowPolicy : std::uint8_t {
+  Block,          // the producer waits until a worker takes a task
+  Reject,         // enqueue throws ThreadPoolFullError
+  DropOldestLow,  // the oldest queued TaskPriority::Low task makes room, otherwise Reject
+};
+
+struct ThreadPoolLimits {
+  std::size_t capacity = 0;  // queued (not yet started) tasks, 0 = unbounded
+  OverflowPolicy policy = OverflowPolicy::Block;
+};
+
+class ThreadPoolFullError : public std::runtime_error {
+ public:
+  ThreadPoolFullError() : std::runtime_error("thread pool queue is full") {}
+};
+
+// upper bounds in seconds of the queue wait histogram; the last bucket is +Inf
+inline constexpr std::array<double, 8> kTaskWaitBuckets = {0.00001, 0.0001, 0.001, 0.01, 0.1, 1, 10, 60};
+
+struct ThreadPoolStats {
+  std::size_t queued{0};
+  std::size_t capacity{0};
+  std::uint64_t rejected{0};
+  std::uint64_t dropped{0};
+  std::uint64_t blocked{0};  // enqueue calls that waited for room
+  std::uint64_t started{0};
+  double wait_seconds_sum{0};
+  std::array<std::uint64_t, kTaskWaitBuckets.size() + 1> wait_buckets{};  // per bucket, not cumulative
+};
+
+// Admission control shared by the pools: counts queued tasks against
+// ThreadPoolLimits::capacity and makes producers wait under OverflowPolicy::Block.
+// What to do with a full queue under the other policies is left to the pool,
+// which owns the tasks. Counters are relaxed atomics read by stats().
+class QueueLimiter {
+ public:
+  explicit QueueLimiter(ThreadPoolLimits limits);
+
+  // takes a queue slot. Under Block waits for one; otherwise returns false when the
+  // queue is full. `exempt` producers (tasks enqueued from a worker) always get a
+  // slot, since a worker waiting for room in its own pool could deadlock it.
+  bool admit(bool exempt);
+  // a queued task left the queue without running (dropped to make room)
+  void release();
+  // a queued task was picked up by a worker after waiting `waited`
+  void started(std::chrono::nanoseconds waited);
+
+  void countRejected() { rejected_.fetch_add(1, std::memory_order_relaxed); }
+  void countDropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+  [[nodiscard]] bool saturated() const { return limits_.capacity != 0 && queued_.load() >= limits_.capacity; }
+  [[nodiscard]] const ThreadPoolLimits &limits() const { return limits_; }
+  [[nodiscard]] ThreadPoolStats stats() const;
+
+ private:
+  void freeSlot();
+
+  const ThreadPoolLimits limits_;
+  std::atomic<std::size_t> queued_{0};
+  std::atomic<std::size_t> waiting_{0};
+  std::mutex mutex_;
+  std::condition_variable space_condition_;
+
+  std::atomic<std::uint64_t> rejected_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> blocked_{0};
+  std::atomic<std::uint64_t> started_{0};
+  std::atomic<std::uint64_t> wait_nanos_sum_{0};
+  std::array<std::atomic<std::uint64_t>, kTaskWaitBuckets.size() + 1> wait_buckets_{};
+};
+
+#endif  // COMMON_THREADPOOL_QUEUELIMITER_H_
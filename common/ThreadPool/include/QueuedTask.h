@@ -0,0 +1,69 @@
+#ifndef COMMON_THREADPOOL_QUEUEDTASK_H_
+#define COMMON_THREADPOOL_QUEUEDTASK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+#include "interfaces/IThreadPool.h"
+
+// a Task as the pools queue it: the priority picks its lane and what may be shed,
+// and the enqueue time feeds the queue wait histogram of QueueLimiter
+struct QueuedTask {
+  Task task;
+  TaskPriority priority = TaskPriority::Background;
+  std::chrono::steady_clock::time_point enqueued_at;
+};
+
+enum class TaskLane : std::uint8_t { Interactive, Background };
+
+constexpr TaskLane laneOf(TaskPriority priority) {
+  return priority == TaskPriority::Interactive ? TaskLane::Interactive : TaskLane::Background;
+}
+
+constexpr TaskLane otherLane(TaskLane lane) {
+  return lane == TaskLane::Interactive ? TaskLane::Background : TaskLane::Interactive;
+}
+
+// FIFO queues of a pool (or of one worker), one per lane, so a backlog of
+// background writes does not sit in front of interactive reads
+struct TaskLanes {
+  std::deque<QueuedTask> interactive;
+  std::deque<QueuedTask> background;  // TaskPriority::Background and TaskPriority::Low
+
+  std::deque<QueuedTask> &operator[](TaskLane lane) { return lane == TaskLane::Interactive ? interactive : background; }
+  [[nodiscard]] bool empty() const { return interactive.empty() && background.empty(); }
+  void push(QueuedTask queued) { (*this)[laneOf(queued.priority)].push_back(std::move(queued)); }
+};
+
+// Starvation guard, one per worker: the interactive lane goes first, but after
+// kInteractiveBurst interactive tasks in a row the worker looks at the background
+// lane first, so queued background work still gets 1 in kInteractiveBurst + 1 runs.
+class LaneTurn {
+ public:
+  static constexpr std::size_t kInteractiveBurst = 8;
+
+  [[nodiscard]] TaskLane first() const {
+    return streak_ >= kInteractiveBurst ? TaskLane::Background : TaskLane::Interactive;
+  }
+  void ran(TaskLane lane) { streak_ = lane == TaskLane::Interactive && streak_ < kInteractiveBurst ? streak_ + 1 : 0; }
+
+ private:
+  std::size_t streak_ = 0;
+};
+
+// removes the oldest TaskPriority::Low task of `tasks` (front = oldest); the caller
+// destroys it outside its lock
+inline std::optional<QueuedTask> takeOldestLow(std::deque<QueuedTask> &tasks) {
+  auto oldest = std::find_if(tasks.begin(), tasks.end(),
+                             [](const QueuedTask &queued) { return queued.priority == TaskPriority::Low; });
+  if (oldest == tasks.end()) return std::nullopt;
+  QueuedTask dropped = std::move(*oldest);
+  tasks.erase(oldest);
+  return dropped;
+}
+
+#endif  // COMMON_THREADPOOL_QUEUEDTASK_H_
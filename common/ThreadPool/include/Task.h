@@ -0,0 +1,108 @@
+#ifndef COMMON_THREADPOOL_TASK_H_
+#define COMMON_THREADPOOL_TASK_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable for the pool queues. Unlike std::function it takes
+// move-only callables (a lambda owning a std::promise), and callables up to
+// kInlineSize bytes are stored in the Task itself instead of on the heap.
+class Task {
+ public:
+  static constexpr std::size_t kInlineSize = 112;
+
+  template <typename F>
+  static constexpr bool kStoredInline = sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<F>;
+
+  Task() noexcept = default;
+
+  template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task> &&
+                                                    std::is_invocable_v<std::decay_t<F> &>>>
+  Task(F &&f) {  // NOLINT(google-explicit-constructor): lambdas convert like they do to std::function
+    using Fn = std::decay_t<F>;
+    if constexpr (kStoredInline<Fn>) {
+      ::new (static_cast<void *>(storage_)) Fn(std::forward<F>(f));
+    } else {
+      ::new (static_cast<void *>(storage_)) Fn *(new Fn(std::forward<F>(f)));
+    }
+    ops_ = &kOps<Fn>;
+  }
+
+  Task(Task &&other) noexcept : ops_(other.ops_) {
+    if (ops_) ops_->relocate(other.storage_, storage_);
+    other.ops_ = nullptr;
+  }
+
+  Task &operator=(Task &&other) noexcept {
+    if (this == &other) return *this;
+    reset();
+    ops_ = other.ops_;
+    if (ops_) ops_->relocate(other.storage_, storage_);
+    other.ops_ = nullptr;
+    return *this;
+  }
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  ~Task() { reset(); }
+
+  void operator()() {
+    assert(ops_ && "invoking an empty Task");
+    ops_->invoke(storage_);
+  }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+ private:
+  struct Ops {
+    void (*invoke)(void *storage);
+    // move-constructs into `to` and destroys the source
+    void (*relocate)(void *from, void *to) noexcept;
+    void (*destroy)(void *storage) noexcept;
+  };
+
+  template <typename Fn>
+  static Fn &target(void *storage) noexcept {
+    if constexpr (kStoredInline<Fn>) {
+      return *std::launder(static_cast<Fn *>(storage));
+    } else {
+      return **std::launder(static_cast<Fn **>(storage));
+    }
+  }
+
+  template <typename Fn>
+  static constexpr Ops kOps{
+      [](void *storage) { target<Fn>(storage)(); },
+      [](void *from, void *to) noexcept {
+        if constexpr (kStoredInline<Fn>) {
+          Fn &source = target<Fn>(from);
+          ::new (to) Fn(std::move(source));
+          source.~Fn();
+        } else {
+          ::new (to) Fn *(*std::launder(static_cast<Fn **>(from)));
+        }
+      },
+      [](void *storage) noexcept {
+        if constexpr (kStoredInline<Fn>) {
+          target<Fn>(storage).~Fn();
+        } else {
+          delete &target<Fn>(storage);
+        }
+      },
+  };
+
+  void reset() noexcept {
+    if (ops_) ops_->destroy(storage_);
+    ops_ = nullptr;
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const Ops *ops_ = nullptr;
+};
+
+#endif  // COMMON_THREADPOOL_TASK_H_
@@ -0,0 +1,27 @@
+#ifndef COMMON_THREADPOOL_THREADPOOLMETRICS_H_
+#define COMMON_THREADPOOL_THREADPOOLMETRICS_H_
+
+#include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+
+#include <string>
+#include <vector>
+
+#include "interfaces/IThreadPool.h"
+
+// Prometheus view of IThreadPool::stats(): queue depth and capacity, rejected,
+// dropped and blocked enqueues, and a histogram of the time tasks wait in the
+// queue. Read at scrape time, so the pools only bump relaxed counters. Register
+// with Exposer::RegisterCollectable, labelled by `pool`.
+class ThreadPoolMetrics : public prometheus::Collectable {
+ public:
+  ThreadPoolMetrics(const IThreadPool &pool, std::string name);
+
+  std::vector<prometheus::MetricFamily> Collect() const override;
+
+ private:
+  const IThreadPool &pool_;
+  std::string name_;
+};
+
+#endif  // COMMON_THREADPOOL_THREADPOOLMETRICS_H_
@@ -0,0 +1,84 @@
+#ifndef COMMON_WORKSTEALINGTHREADPOOL_H_
+#define COMMON_WORKSTEALINGTHREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "QueueLimiter.h"
+#include "QueuedTask.h"
+#include "interfaces/IThreadPool.h"
+
+// IThreadPool where every worker owns a deque guarded by its own mutex instead
+// of all workers sharing one queue and one lock.
+// - a task enqueued from a worker goes to that worker's deque; the owner pops
+//   the newest task (LIFO, still hot in cache) and idle workers steal the oldest
+//   one (FIFO) from the other end
+// - a task enqueued from any other thread goes to one of the injection shards,
+//   picked per submitting thread, so producers rarely share a lock
+// - finished tasks only touch atomics; waitAll waiters are woken when the
+//   number of pending tasks drops to zero
+// - each deque has an interactive and a background lane; a worker takes
+//   interactive tasks first, with LaneTurn as the starvation guard
+// - ThreadPoolLimits bound the tasks queued across all deques (see QueueLimiter);
+//   tasks enqueued from a worker are never blocked or rejected
+class WorkStealingThreadPool : public IThreadPool {
+ public:
+  explicit WorkStealingThreadPool(size_t num_threads = std::thread::hardware_concurrency(),
+                                  ThreadPoolLimits limits = {});
+  ~WorkStealingThreadPool() override;
+  WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+  WorkStealingThreadPool(WorkStealingThreadPool &&) = delete;
+  WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+  WorkStealingThreadPool &operator=(WorkStealingThreadPool &&) = delete;
+
+  // blocks until every task enqueued so far, and every task they enqueue, has run;
+  // must not be called from a task of this pool
+  void waitAll();
+
+  [[nodiscard]] size_t size() const { return workers_.size(); }
+
+  [[nodiscard]] bool saturated() const override { return limiter_.saturated(); }
+  [[nodiscard]] ThreadPoolStats stats() const override { return limiter_.stats(); }
+
+ private:
+  struct TaskDeque {
+    std::mutex mutex;
+    TaskLanes lanes;
+  };
+
+  void enqueueTask(Task task, TaskPriority priority) override;
+
+  void workerLoop(size_t index);
+  // looks through every deque for a task of `first`, then of the other lane
+  std::optional<QueuedTask> findTask(size_t index, size_t &victim_seed, TaskLane first);
+  static std::optional<QueuedTask> popBack(TaskDeque &deque, TaskLane lane);
+  static std::optional<QueuedTask> popFront(TaskDeque &deque, TaskLane lane);
+  // the oldest TaskPriority::Low task over all deques, removed from its deque
+  std::optional<QueuedTask> takeOldestLowTask();
+  void wakeOne();
+
+  std::vector<std::unique_ptr<TaskDeque>> local_;      // one per worker
+  std::vector<std::unique_ptr<TaskDeque>> injection_;  // shared by external producers
+  std::vector<std::thread> workers_;
+
+  std::atomic<size_t> queued_{0};   // tasks sitting in a deque
+  std::atomic<size_t> pending_{0};  // tasks enqueued and not finished yet
+  std::atomic<size_t> sleeping_{0};
+  std::atomic<bool> stop_{false};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::mutex done_mutex_;
+  std::condition_variable done_condition_;
+
+  QueueLimiter limiter_;
+};
+
+#endif  // COMMON_WORKSTEALINGTHREADPOOL_H_
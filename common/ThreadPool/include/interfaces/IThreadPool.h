@@ -1,24 +1,75 @@
 #ifndef BACKEND_GENERICREPOSITORY_ITHREADPOOL_H_
 #define BACKEND_GENERICREPOSITORY_ITHREADPOOL_H_
 
-#include <functional>
+#include <cstdint>
+#include <exception>
 #include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "PooledAllocator.h"
+#include "QueueLimiter.h"
+#include "Task.h"
+
+// Interactive tasks have their own lane in the pools and run ahead of queued
+// background work (see LaneTurn for the starvation guard).
+enum class TaskPriority : std::uint8_t {
+  Interactive,  // a caller is waiting on the result: request handlers, cache reads
+  Background,   // writes, fan-out and other work nobody is blocked on
+  Low,          // background work that may be lost (cache writes): shed first under OverflowPolicy::DropOldestLow
+};
 
 struct IThreadPool {
   virtual ~IThreadPool() = default;
 
+  // fire-and-forget: no future and no shared state, and a callable that fits in
+  // Task::kInlineSize is queued without a heap allocation
   template <typename F>
-  auto enqueue(F &&f) -> std::future<decltype(f())> {
-    using ReturnType = decltype(f());
-    auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(f));
-    std::future<ReturnType> result = task->get_future();
-    enqueueTask([task]() { (*task)(); });
+  void post(F &&f, TaskPriority priority = TaskPriority::Background) {
+    enqueueTask(Task(std::forward<F>(f)), priority);
+  }
 
+  // runs f on the pool and returns its result (or exception) through a future whose
+  // shared state comes from the per-thread block cache of PooledAllocator
+  template <typename F>
+  auto submit(F &&f, TaskPriority priority = TaskPriority::Background)
+      -> std::future<std::invoke_result_t<std::decay_t<F> &>> {
+    using ReturnType = std::invoke_result_t<std::decay_t<F> &>;
+    std::promise<ReturnType> promise(std::allocator_arg, PooledAllocator<ReturnType>{});
+    std::future<ReturnType> result = promise.get_future();
+    Task task([promise = std::move(promise), fn = std::decay_t<F>(std::forward<F>(f))]() mutable {
+      try {
+        if constexpr (std::is_void_v<ReturnType>) {
+          fn();
+          promise.set_value();
+        } else {
+          promise.set_value(fn());
+        }
+      } catch (...) {
+        promise.set_exception(std::current_exception());
+      }
+    });
+    enqueueTask(std::move(task), priority);
     return result;
   }
 
+  // same as submit(); callers that drop the future should use post()
+  template <typename F>
+  auto enqueue(F &&f) -> std::future<std::invoke_result_t<std::decay_t<F> &>> {
+    return submit(std::forward<F>(f));
+  }
+
+  // true while the queue is at capacity: producers that can hold work back (the
+  // RabbitMQ consumers) should stop taking more until it drains
+  [[nodiscard]] virtual bool saturated() const { return false; }
+  [[nodiscard]] virtual ThreadPoolStats stats() const { return {}; }
+
  protected:
-  virtual void enqueueTask(std::function<void()> task) = 0;
+  // a full bounded queue is handled by the pool's OverflowPolicy: the call may block,
+  // throw ThreadPoolFullError, or drop a TaskPriority::Low task (its future then
+  // reports std::future_errc::broken_promise)
+  virtual void enqueueTask(Task task, TaskPriority priority) = 0;
 };
 
 #endif  // BACKEND_GENERICREPOSITORY_ITHREADPOOL_H_
@@ -2,20 +2,20 @@
 #define COMMON_THREADPOOL_H_
 
 #include <condition_variable>
-#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "QueueLimiter.h"
+#include "QueuedTask.h"
 #include "interfaces/IThreadPool.h"
 
 class ThreadPool : public IThreadPool {
  public:
-  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency(), ThreadPoolLimits limits = {});
   ~ThreadPool() override;
   ThreadPool(const ThreadPool &) = delete;
   ThreadPool(ThreadPool &&) = delete;
@@ -24,16 +24,20 @@ class ThreadPool : public IThreadPool {
 
   void waitAll();
 
+  [[nodiscard]] bool saturated() const override { return limiter_.saturated(); }
+  [[nodiscard]] ThreadPoolStats stats() const override { return limiter_.stats(); }
+
  private:
-  void enqueueTask(std::function<void()> task) override;
+  void enqueueTask(Task task, TaskPriority priority) override;
 
   std::vector<std::thread> workers_;
-  std::queue<std::function<void()>> tasks_;
+  TaskLanes tasks_;
   std::mutex queue_mutex_;
   std::condition_variable condition_;
   std::condition_variable done_condition_;
   bool stop_{false};
   size_t active_tasks_ = 0;
+  QueueLimiter limiter_;
 };
 
 #endif  // COMMON_THREADPOOL_H_
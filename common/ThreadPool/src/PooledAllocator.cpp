@@ -0,0 +1,50 @@
+#include "PooledAllocator.h"
+
+#include <vector>
+
+namespace task_block_cache {
+
+namespace {
+
+// blocks freed from thread_local destructors that run after the cache is gone
+// go back to operator delete
+thread_local bool cache_destroyed = false;
+
+struct BlockCache {
+  std::vector<void *> blocks;
+
+  BlockCache() { blocks.reserve(kMaxCachedBlocks); }
+  ~BlockCache() {
+    cache_destroyed = true;
+    for (void *block : blocks) ::operator delete(block);
+  }
+};
+
+BlockCache &cache() {
+  thread_local BlockCache instance;
+  return instance;
+}
+
+}  // namespace
+
+void *allocate(std::size_t bytes) {
+  if (bytes > kBlockSize || cache_destroyed) return ::operator new(bytes > kBlockSize ? bytes : kBlockSize);
+  auto &blocks = cache().blocks;
+  if (blocks.empty()) return ::operator new(kBlockSize);
+  void *block = blocks.back();
+  blocks.pop_back();
+  return block;
+}
+
+void deallocate(void *block, std::size_t bytes) noexcept {
+  if (bytes <= kBlockSize && !cache_destroyed) {
+    auto &blocks = cache().blocks;
+    if (blocks.size() < kMaxCachedBlocks) {
+      blocks.push_back(block);  // never reallocates: capacity is reserved up front
+      return;
+    }
+  }
+  ::operator delete(block);
+}
+
+}  // namespace task_block_cache
@@ -0,0 +1,70 @@
+#include "QueueLimiter.h"
+
+#include <algorithm>
+#include <iterator>
+
+QueueLimiter::QueueLimiter(ThreadPoolLimits limits) : limits_(limits) {}
+
+bool QueueLimiter::admit(bool exempt) {
+  if (limits_.capacity == 0 || exempt) {
+    queued_.fetch_add(1);
+    return true;
+  }
+
+  bool waited = false;
+  size_t current = queued_.load();
+  while (true) {
+    if (current < limits_.capacity) {
+      if (queued_.compare_exchange_weak(current, current + 1)) break;
+      continue;
+    }
+    if (limits_.policy != OverflowPolicy::Block) return false;
+
+    // same handshake as the worker sleep: waiting_ goes up before the recheck, so
+    // freeSlot either sees a waiter or we see the freed slot
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.fetch_add(1);
+    space_condition_.wait(lock, [&]() { return (current = queued_.load()) < limits_.capacity; });
+    waiting_.fetch_sub(1);
+    waited = true;
+  }
+
+  if (waited) blocked_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void QueueLimiter::freeSlot() {
+  queued_.fetch_sub(1);
+  if (waiting_.load() == 0) return;
+  const std::lock_guard<std::mutex> lock(mutex_);
+  space_condition_.notify_one();
+}
+
+void QueueLimiter::release() { freeSlot(); }
+
+void QueueLimiter::started(std::chrono::nanoseconds waited) {
+  freeSlot();
+  started_.fetch_add(1, std::memory_order_relaxed);
+  wait_nanos_sum_.fetch_add(static_cast<std::uint64_t>(std::max<std::int64_t>(waited.count(), 0)),
+                            std::memory_order_relaxed);
+  const double seconds = std::chrono::duration<double>(waited).count();
+  const auto bucket = std::distance(kTaskWaitBuckets.begin(),
+                                    std::lower_bound(kTaskWaitBuckets.begin(), kTaskWaitBuckets.end(), seconds));
+  wait_buckets_[static_cast<std::size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+}
+
+ThreadPoolStats QueueLimiter::stats() const {
+  ThreadPoolStats stats{
+      .queued = queued_.load(std::memory_order_relaxed),
+      .capacity = limits_.capacity,
+      .rejected = rejected_.load(std::memory_order_relaxed),
+      .dropped = dropped_.load(std::memory_order_relaxed),
+      .blocked = blocked_.load(std::memory_order_relaxed),
+      .started = started_.load(std::memory_order_relaxed),
+      .wait_seconds_sum = static_cast<double>(wait_nanos_sum_.load(std::memory_order_relaxed)) / 1e9,
+  };
+  for (std::size_t i = 0; i < wait_buckets_.size(); ++i) {
+    stats.wait_buckets[i] = wait_buckets_[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
@@ -0,0 +1,59 @@
+#include "ThreadPoolMetrics.h"
+
+#include <prometheus/client_metric.h>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+
+prometheus::MetricFamily family(const std::string &name, const std::string &help, prometheus::MetricType type,
+                                const std::string &pool, double value) {
+  prometheus::ClientMetric metric;
+  metric.label.push_back({"pool", pool});
+  if (type == prometheus::MetricType::Counter) {
+    metric.counter.value = value;
+  } else {
+    metric.gauge.value = value;
+  }
+  return prometheus::MetricFamily{name, help, type, {std::move(metric)}};
+}
+
+prometheus::MetricFamily waitHistogram(const ThreadPoolStats &stats, const std::string &pool) {
+  prometheus::ClientMetric metric;
+  metric.label.push_back({"pool", pool});
+  metric.histogram.sample_count = stats.started;
+  metric.histogram.sample_sum = stats.wait_seconds_sum;
+  std::uint64_t cumulative = 0;
+  for (std::size_t i = 0; i < kTaskWaitBuckets.size(); ++i) {
+    cumulative += stats.wait_buckets[i];
+    metric.histogram.bucket.push_back({cumulative, kTaskWaitBuckets[i]});
+  }
+  metric.histogram.bucket.push_back({stats.started, std::numeric_limits<double>::infinity()});
+  return prometheus::MetricFamily{"thread_pool_queue_wait_seconds", "Time tasks spent queued before a worker ran them",
+                                  prometheus::MetricType::Histogram, {std::move(metric)}};
+}
+
+}  // namespace
+
+ThreadPoolMetrics::ThreadPoolMetrics(const IThreadPool &pool, std::string name) : pool_(pool), name_(std::move(name)) {}
+
+std::vector<prometheus::MetricFamily> ThreadPoolMetrics::Collect() const {
+  using prometheus::MetricType;
+  const ThreadPoolStats stats = pool_.stats();
+
+  return {
+      family("thread_pool_queue_depth", "Tasks queued and not started yet", MetricType::Gauge, name_,
+             static_cast<double>(stats.queued)),
+      family("thread_pool_queue_capacity", "Queue capacity, 0 when unbounded", MetricType::Gauge, name_,
+             static_cast<double>(stats.capacity)),
+      family("thread_pool_rejected_total", "Enqueues refused with ThreadPoolFullError", MetricType::Counter, name_,
+             static_cast<double>(stats.rejected)),
+      family("thread_pool_dropped_total", "Low priority tasks shed to make room", MetricType::Counter, name_,
+             static_cast<double>(stats.dropped)),
+      family("thread_pool_blocked_total", "Enqueues that waited for room in the queue", MetricType::Counter, name_,
+             static_cast<double>(stats.blocked)),
+      waitHistogram(stats, name_),
+  };
+}
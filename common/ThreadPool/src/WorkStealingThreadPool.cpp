@@ -0,0 +1,191 @@
+#include "WorkStealingThreadPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "Debug_profiling.h"
+
+namespace {
+
+// set on worker threads so tasks enqueued from a task land in the worker's own deque
+thread_local const WorkStealingThreadPool *current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+size_t injectionShardSeed() {
+  static thread_local const size_t seed = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return seed;
+}
+
+size_t nextVictimSeed(size_t &seed) {
+  // xorshift, only used to spread thieves over victims
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads, ThreadPoolLimits limits) : limiter_(limits) {
+  num_threads = std::max<size_t>(num_threads, 1);
+  for (size_t i = 0; i < num_threads; ++i) {
+    local_.push_back(std::make_unique<TaskDeque>());
+    injection_.push_back(std::make_unique<TaskDeque>());
+  }
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this, i]() { workerLoop(i); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    const std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_.store(true);
+  }
+  sleep_condition_.notify_all();
+  for (auto &worker : workers_) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+void WorkStealingThreadPool::waitAll() {
+  std::unique_lock<std::mutex> lock(done_mutex_);
+  done_condition_.wait(lock, [this]() { return pending_.load() == 0; });
+}
+
+void WorkStealingThreadPool::enqueueTask(Task task, TaskPriority priority) {
+  const bool from_worker = current_pool == this;
+  QueuedTask queued{std::move(task), priority, std::chrono::steady_clock::now()};
+  std::optional<QueuedTask> dropped;
+  if (!limiter_.admit(from_worker)) {
+    const bool shed_low = limiter_.limits().policy == OverflowPolicy::DropOldestLow;
+    // the slot of a dropped task goes to the new one; a low task with no older
+    // low task to replace is the one dropped
+    if (shed_low) dropped = takeOldestLowTask();
+    if (!dropped && !(shed_low && priority == TaskPriority::Low)) {
+      limiter_.countRejected();
+      throw ThreadPoolFullError();
+    }
+    limiter_.countDropped();
+    if (!dropped) return;
+  }
+
+  // counted before the push: a worker may pop the task and decrement queued_ as soon
+  // as the deque lock is released. A dropped task leaves its counts to the new one.
+  if (!dropped) {
+    pending_.fetch_add(1);
+    queued_.fetch_add(1);
+  }
+  TaskDeque &deque = from_worker ? *local_[current_worker] : *injection_[injectionShardSeed() % injection_.size()];
+  {
+    const std::lock_guard<std::mutex> lock(deque.mutex);
+    deque.lanes.push(std::move(queued));
+  }
+  wakeOne();
+}
+
+std::optional<QueuedTask> WorkStealingThreadPool::takeOldestLowTask() {
+  TaskDeque *victim = nullptr;
+  auto oldest = std::chrono::steady_clock::time_point::max();
+  auto consider = [&](TaskDeque &deque) {
+    const std::lock_guard<std::mutex> lock(deque.mutex);
+    auto &background = deque.lanes.background;
+    auto low = std::find_if(background.begin(), background.end(),
+                            [](const QueuedTask &queued) { return queued.priority == TaskPriority::Low; });
+    if (low != background.end() && low->enqueued_at < oldest) {
+      oldest = low->enqueued_at;
+      victim = &deque;
+    }
+  };
+  for (auto &deque : injection_) consider(*deque);
+  for (auto &deque : local_) consider(*deque);
+  if (!victim) return std::nullopt;
+
+  // a worker may have taken it since; then the next low task of that deque goes
+  const std::lock_guard<std::mutex> lock(victim->mutex);
+  return takeOldestLow(victim->lanes.background);
+}
+
+void WorkStealingThreadPool::wakeOne() {
+  // a worker going to sleep bumps sleeping_ before it rechecks queued_, so either
+  // it sees the new task or we see it sleeping and notify under the same mutex
+  if (sleeping_.load() == 0) return;
+  const std::lock_guard<std::mutex> lock(sleep_mutex_);
+  sleep_condition_.notify_one();
+}
+
+std::optional<QueuedTask> WorkStealingThreadPool::popBack(TaskDeque &deque, TaskLane lane) {
+  const std::lock_guard<std::mutex> lock(deque.mutex);
+  auto &tasks = deque.lanes[lane];
+  if (tasks.empty()) return std::nullopt;
+  auto task = std::move(tasks.back());
+  tasks.pop_back();
+  return task;
+}
+
+std::optional<QueuedTask> WorkStealingThreadPool::popFront(TaskDeque &deque, TaskLane lane) {
+  const std::lock_guard<std::mutex> lock(deque.mutex);
+  auto &tasks = deque.lanes[lane];
+  if (tasks.empty()) return std::nullopt;
+  auto task = std::move(tasks.front());
+  tasks.pop_front();
+  return task;
+}
+
+std::optional<QueuedTask> WorkStealingThreadPool::findTask(size_t index, size_t &victim_seed, TaskLane first) {
+  const size_t count = local_.size();
+
+  for (const TaskLane lane : {first, otherLane(first)}) {
+    if (auto task = popBack(*local_[index], lane)) return task;
+
+    // injection shards start at our own so workers spread over the producers
+    for (size_t i = 0; i < count; ++i) {
+      if (auto task = popFront(*injection_[(index + i) % count], lane)) return task;
+    }
+
+    const size_t start = nextVictimSeed(victim_seed) % count;
+    for (size_t i = 0; i < count; ++i) {
+      const size_t victim = (start + i) % count;
+      if (victim == index) continue;
+      if (auto task = popFront(*local_[victim], lane)) return task;
+    }
+  }
+  return std::nullopt;
+}
+
+void WorkStealingThreadPool::workerLoop(size_t index) {
+  current_pool = this;
+  current_worker = index;
+  size_t victim_seed = index * 0x9E3779B97F4A7C15ULL + 1;
+  LaneTurn turn;
+
+  while (true) {
+    if (auto task = findTask(index, victim_seed, turn.first())) {
+      turn.ran(laneOf(task->priority));
+      queued_.fetch_sub(1);
+      limiter_.started(std::chrono::steady_clock::now() - task->enqueued_at);
+      try {
+        task->task();
+      } catch (const std::exception &e) {
+        LOG_ERROR("[WorkStealingThreadPool] Task failed: {}", e.what());
+      } catch (...) {
+        LOG_ERROR("[WorkStealingThreadPool] Task failed with an unknown exception");
+      }
+      task.reset();  // release the captures before waitAll can return
+      if (pending_.fetch_sub(1) == 1) {
+        const std::lock_guard<std::mutex> lock(done_mutex_);
+        done_condition_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_.fetch_add(1);
+    sleep_condition_.wait(lock, [this]() { return stop_.load() || queued_.load() > 0; });
+    sleeping_.fetch_sub(1);
+    // like ThreadPool, queued tasks are drained before the workers exit
+    if (stop_.load() && queued_.load() == 0) return;
+  }
+}
@@ -1,19 +1,41 @@
 #include "threadpool.h"
 
-ThreadPool::ThreadPool(size_t num_threads) {
+#include "Debug_profiling.h"
+
+namespace {
+
+// set on worker threads: their enqueues bypass the capacity, see QueueLimiter::admit
+thread_local const ThreadPool *current_pool = nullptr;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t num_threads, ThreadPoolLimits limits) : limiter_(limits) {
   for (size_t i = 0; i < num_threads; ++i) {
     workers_.emplace_back([this]() {
+      current_pool = this;
+      LaneTurn turn;
       while (true) {
-        std::function<void()> task;
+        QueuedTask queued;
         {
           std::unique_lock<std::mutex> lock(queue_mutex_);
           condition_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
           if (stop_ && tasks_.empty()) return;
-          task = std::move(tasks_.front());
-          tasks_.pop();
+          TaskLane lane = turn.first();
+          if (tasks_[lane].empty()) lane = otherLane(lane);
+          queued = std::move(tasks_[lane].front());
+          tasks_[lane].pop_front();
+          turn.ran(lane);
           ++active_tasks_;
         }
-        task();
+        limiter_.started(std::chrono::steady_clock::now() - queued.enqueued_at);
+        try {
+          queued.task();
+        } catch (const std::exception &e) {
+          LOG_ERROR("[ThreadPool] Task failed: {}", e.what());
+        } catch (...) {
+          LOG_ERROR("[ThreadPool] Task failed with an unknown exception");
+        }
+        queued.task = Task();  // release the captures before waitAll can return
         {
           const std::unique_lock<std::mutex> lock(queue_mutex_);
           --active_tasks_;
@@ -40,10 +62,25 @@ void ThreadPool::waitAll() {
   done_condition_.wait(lock, [this]() { return tasks_.empty() && active_tasks_ == 0; });
 }
 
-void ThreadPool::enqueueTask(std::function<void()> task) {
+void ThreadPool::enqueueTask(Task task, TaskPriority priority) {
+  QueuedTask queued{std::move(task), priority, std::chrono::steady_clock::now()};
+  std::optional<QueuedTask> dropped;
+  const bool admitted = limiter_.admit(current_pool == this);
   {
     const std::unique_lock<std::mutex> lock(queue_mutex_);
-    tasks_.push(std::move(task));
+    if (!admitted) {
+      const bool shed_low = limiter_.limits().policy == OverflowPolicy::DropOldestLow;
+      // the slot of a dropped task goes to the new one; a low task with no older
+      // low task to replace is the one dropped
+      if (shed_low) dropped = takeOldestLow(tasks_.background);
+      if (!dropped && !(shed_low && priority == TaskPriority::Low)) {
+        limiter_.countRejected();
+        throw ThreadPoolFullError();
+      }
+      limiter_.countDropped();
+      if (!dropped) return;
+    }
+    tasks_.push(std::move(queued));
   }
   condition_.notify_one();
 }
@@ -11,6 +11,9 @@ static constexpr int messageService = 8082;
 static constexpr int reactionService = 8082;  // Currently routed through messageService
 static constexpr int rabitMQ = 5672;
 static constexpr int metrics = 8089;
+static constexpr int messageServiceMetrics = 8090;
+static constexpr int authServiceMetrics = 8091;
+static constexpr int chatServiceMetrics = 8092;
 }  // namespace Config::Ports
 
 #endif  // PORTS_H